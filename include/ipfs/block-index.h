@@ -0,0 +1,154 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_BLOCK_INDEX_H
+#define IPFS_BLOCK_INDEX_H
+
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ipfs {
+
+/** Options to control a `BlockIndex`.
+ * @since version 0.8.0 */
+struct BlockIndexOptions {
+  /** Keep the exact set of blocks, as a sorted array of about 40 bytes per
+   * block, rather than a Bloom filter. */
+  bool exact = false;
+
+  /** Probability that the Bloom filter reports a block that is not in the
+   * set. Each halving costs about 0.18 byte per block: 1% takes about 1.2
+   * byte per block. Ignored if `exact` is set. */
+  double false_positive_rate = 0.01;
+};
+
+/** Snapshot of a set of blocks, typically the local store of a peer, for
+ * answering "is this block stored?" without a round trip to the peer.
+ *
+ * Blocks are matched by multihash, so a CIDv0 and its CIDv1 equivalent, or
+ * the same content under the raw and dag-pb multicodecs, are the same block,
+ * as they are for the peer's store.
+ *
+ * The index is not updated when the peer stores or removes blocks: rebuild it
+ * periodically, and confirm negative answers that matter with
+ * `Client::BlockExists()`. With a Bloom filter, positive answers may be false
+ * too, with the configured probability.
+ *
+ * Objects of this class are immutable and thus thread-safe.
+ *
+ * An example usage:
+ * @snippet test_block.cc ipfs::BlockIndex
+ *
+ * @since version 0.8.0 */
+class BlockIndex {
+ public:
+  /** Constructor. Lists the local store of a peer with
+   * `Client::RefsLocal()`.
+   *
+   * @throw std::exception if any error occurs */
+  BlockIndex(
+      /** [in,out] Client to use. */
+      Client* client,
+      /** [in] Index options. */
+      const BlockIndexOptions& options = BlockIndexOptions());
+
+  /** Constructor from a list of blocks.
+   *
+   * @throw std::invalid_argument if `options.false_positive_rate` is not
+   * between 0 and 1 */
+  BlockIndex(
+      /** [in] Blocks in the set, in any order, duplicates allowed. */
+      const std::vector<Cid>& cids,
+      /** [in] Index options. */
+      const BlockIndexOptions& options = BlockIndexOptions());
+
+  /** Check if a block is in the set.
+   * @return true if the block is in the set, or, with a Bloom filter, if it
+   * is a false positive */
+  bool Contains(
+      /** [in] Id of the block. */
+      const Cid& cid) const;
+
+  /** Get the number of blocks in the set.
+   * @return the number of distinct blocks */
+  size_t Size() const;
+
+ private:
+  /** Check the options.
+   * @throw std::invalid_argument if they are invalid */
+  static void CheckOptions(const BlockIndexOptions& options);
+
+  /** Make the index exact. */
+  void BuildExact(
+      /** [in,out] Keys of the blocks, in any order, duplicates allowed. */
+      std::vector<Cid>* keys);
+
+  /** Make the index a Bloom filter. */
+  void BuildBloom(
+      /** [in,out] Fingerprints of the blocks, in any order, duplicates
+       * allowed. */
+      std::vector<uint64_t>* fingerprints,
+      /** [in] Target false positive probability. */
+      double false_positive_rate);
+
+  /** Get the key under which a block is stored in an exact index: a CIDv1
+   * with the raw multicodec and the multihash of `cid`.
+   * @return the key */
+  static Cid Key(
+      /** [in] Id of the block. */
+      const Cid& cid);
+
+  /** Get a 64-bit hash of the multihash of a block, from which the positions
+   * of its bits in a Bloom filter are derived.
+   * @return the fingerprint */
+  static uint64_t Fingerprint(
+      /** [in] Id of the block. */
+      const Cid& cid);
+
+  /** Get the distance between the successive bits of a block in the Bloom
+   * filter: the bit `i` of a block is at `fingerprint + i * step`, modulo the
+   * size of the filter.
+   * @return the step */
+  static uint64_t BloomStep(
+      /** [in] Fingerprint of the block. */
+      uint64_t fingerprint);
+
+  /** Number of distinct blocks. */
+  size_t size_ = 0;
+
+  /** Sorted keys of the blocks, if the index is exact. */
+  std::vector<Cid> exact_;
+
+  /** Bits of the Bloom filter, if the index is not exact. */
+  std::vector<uint64_t> bloom_;
+
+  /** Number of bits of the Bloom filter. */
+  uint64_t bloom_bits_ = 0;
+
+  /** Number of bits set for each block in the Bloom filter. */
+  unsigned bloom_hashes_ = 0;
+};
+
+} /* namespace ipfs */
+
+#endif /* IPFS_BLOCK_INDEX_H */
@@ -0,0 +1,117 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_CAR_H
+#define IPFS_CAR_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ipfs {
+
+/** Reading and writing of CARv1 (content addressable archive) files, as
+ * produced by `Client::DagExport()` and consumed by `Client::DagImport()`.
+ *
+ * Both the reader and the writer work on streams one block at a time, so
+ * archives of any size can be split, merged or indexed in constant memory.
+ *
+ * An example usage:
+ * @snippet test_car.cc ipfs::car
+ *
+ * @see https://ipld.io/specs/transport/car/carv1/ */
+namespace car {
+
+/** Sequential writer of a CARv1 archive. */
+class Writer {
+ public:
+  /** Constructor. Writes the header of the archive.
+   *
+   * @throw std::runtime_error if writing fails or if a root is not a valid
+   * CID
+   * @since version 0.8.0 */
+  Writer(
+      /** [out] Stream to write the archive to. Must outlive the writer. */
+      std::ostream* out,
+      /** [in] Binary CIDs of the roots of the archive. */
+      const std::vector<std::string>& roots);
+
+  /** Append a block to the archive.
+   *
+   * @throw std::runtime_error if writing fails or if `cid` is not a valid CID
+   * @since version 0.8.0 */
+  void Add(
+      /** [in] Binary CID of the block. It is not checked against the data. */
+      std::string_view cid,
+      /** [in] Contents of the block. */
+      std::string_view block);
+
+ private:
+  /** Write a length-prefixed section. */
+  void WriteSection(std::string_view first, std::string_view second);
+
+  std::ostream* out_;
+};
+
+/** Sequential reader of a CARv1 archive. */
+class Reader {
+ public:
+  /** Constructor. Reads the header of the archive.
+   *
+   * @throw std::runtime_error if the header is malformed or the archive is
+   * not a CARv1
+   * @since version 0.8.0 */
+  explicit Reader(
+      /** [in] Stream to read the archive from. Must outlive the reader. */
+      std::istream* in);
+
+  /** Get the roots of the archive.
+   * @return binary CIDs of the roots, as listed in the header
+   * @since version 0.8.0 */
+  const std::vector<std::string>& Roots() const;
+
+  /** Read the next block of the archive.
+   *
+   * @return false if the end of the archive has been reached
+   * @throw std::runtime_error if the archive is malformed or truncated
+   * @since version 0.8.0 */
+  bool Next(
+      /** [out] Binary CID of the block. */
+      std::string* cid,
+      /** [out] Contents of the block. */
+      std::string* block);
+
+ private:
+  /** Read a length-prefixed section into `section_`.
+   * @return false if the end of the stream has been reached before it */
+  bool ReadSection();
+
+  std::istream* in_;
+  std::vector<std::string> roots_;
+
+  /** Buffer of the section being decoded, reused between blocks. */
+  std::string section_;
+};
+
+} /* namespace car */
+} /* namespace ipfs */
+
+#endif /* IPFS_CAR_H */
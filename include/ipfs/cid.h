@@ -0,0 +1,229 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_CID_H
+#define IPFS_CID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ipfs {
+
+/** Conversions of content identifiers between their binary form (as stored in
+ * blocks) and their text form (as used by the HTTP API).
+ *
+ * @see https://github.com/multiformats/cid */
+namespace cid {
+
+/** Multicodec of dag-pb blocks. */
+constexpr uint64_t kDagPb = 0x70;
+
+/** Multicodec of raw blocks. */
+constexpr uint64_t kRaw = 0x55;
+
+/** Convert a binary CID to text. CIDv0 are encoded as base58btc and CIDv1 as
+ * base32, like the daemon does by default.
+ * @return the text form of the CID, for example "QmYwAPJz..." or "bafy..."
+ * @throw std::runtime_error if `binary` is not a valid CID
+ * @since version 0.8.0 */
+std::string ToString(
+    /** [in] Binary CID. */
+    std::string_view binary);
+
+/** Convert a text CID to binary.
+ * @return the binary form of the CID
+ * @throw std::runtime_error if `text` is not a valid CID
+ * @since version 0.8.0 */
+std::string FromString(
+    /** [in] Text CID, for example "QmYwAPJz..." or "bafy...". */
+    std::string_view text);
+
+/** Get the multicodec of the content a CID refers to. It is always `kDagPb`
+ * for CIDv0.
+ * @return the multicodec, for example `kDagPb` or `kRaw`
+ * @throw std::runtime_error if `binary` is not a valid CID
+ * @since version 0.8.0 */
+uint64_t Codec(
+    /** [in] Binary CID. */
+    std::string_view binary);
+
+/** Build a binary CID from a sha2-256 digest.
+ * @return the binary CID
+ * @throw std::invalid_argument if `version` is 0 and `codec` is not
+ * `kDagPb`, or if the version is not 0 or 1
+ * @since version 0.8.0 */
+std::string FromSha256(
+    /** [in] CID version, 0 or 1. */
+    unsigned version,
+    /** [in] Multicodec of the content. */
+    uint64_t codec,
+    /** [in] 32-byte sha2-256 digest of the content. */
+    std::string_view digest);
+
+/** Get the multihash of a CID, which identifies the content regardless of
+ * the CID version and multicodec. Kubo's blockstore is keyed by multihash, so
+ * two CIDs with the same multihash refer to the same stored block.
+ * @return a view inside `binary`
+ * @throw std::runtime_error if `binary` is not a valid CID
+ * @since version 0.8.0 */
+std::string_view Multihash(
+    /** [in] Binary CID. */
+    std::string_view binary);
+
+/** Get the length of the binary CID at the start of a buffer, for formats
+ * where CIDs are not length-prefixed, like CAR.
+ * @return the number of bytes taken by the CID
+ * @throw std::runtime_error if `data` does not start with a valid CID
+ * @since version 0.8.0 */
+size_t Length(
+    /** [in] Buffer that starts with a binary CID. */
+    std::string_view data);
+
+} /* namespace cid */
+
+/** A content identifier, held in binary form.
+ *
+ * CIDs of up to `kInlineSize` bytes, which includes CIDv0 and CIDv1 with
+ * sha2-256 multihashes, are stored inside the object itself, without any heap
+ * allocation. This makes sets of millions of CIDs about half the size of sets
+ * of their text forms, and comparing or hashing them cheaper.
+ *
+ * An example usage:
+ * @snippet test_dag_pb.cc ipfs::Cid
+ *
+ * @since version 0.8.0 */
+class Cid {
+ public:
+  /** Largest binary CID stored inline. */
+  static constexpr size_t kInlineSize = 39;
+
+  /** Constructor of an empty CID, which is not a valid one. */
+  Cid() noexcept;
+
+  /** Constructor.
+   * @throw std::runtime_error if `text` is not a valid CID */
+  explicit Cid(
+      /** [in] Text CID, for example "QmYwAPJz..." or "bafy...". */
+      std::string_view text);
+
+  /** Copy-constructor. */
+  Cid(
+      /** [in] Other CID to be copied. */
+      const Cid& other);
+
+  /** Move-constructor. */
+  Cid(
+      /** [in,out] Other CID to be moved. */
+      Cid&& other) noexcept;
+
+  /** Copy assignment operator.
+   * @return *this */
+  Cid& operator=(
+      /** [in] Other CID to be copied. */
+      const Cid& other);
+
+  /** Move assignment operator.
+   * @return *this */
+  Cid& operator=(
+      /** [in,out] Other CID to be moved. */
+      Cid&& other) noexcept;
+
+  /** Destructor. */
+  ~Cid();
+
+  /** Create a CID from its binary form.
+   * @return the CID
+   * @throw std::runtime_error if `binary` is not a valid CID */
+  static Cid FromBinary(
+      /** [in] Binary CID, as stored in blocks. */
+      std::string_view binary);
+
+  /** Get the binary form of the CID.
+   * @return a view inside this object, valid as long as it is not modified */
+  std::string_view Binary() const;
+
+  /** Get the text form of the CID, see `cid::ToString()`.
+   * @return the text form, for example "QmYwAPJz..." or "bafy..." */
+  std::string ToString() const;
+
+  /** Get the multicodec of the content the CID refers to.
+   * @return the multicodec, for example `cid::kDagPb` or `cid::kRaw` */
+  uint64_t Codec() const;
+
+  /** Check if the CID is empty, i.e. default-constructed.
+   * @return true if empty */
+  bool Empty() const;
+
+  /** Get a hash of the CID, for unordered containers.
+   * @return the hash */
+  size_t Hash() const;
+
+  /** Compare two CIDs.
+   * @return true if they are equal */
+  friend bool operator==(const Cid& a, const Cid& b) {
+    return a.Binary() == b.Binary();
+  }
+
+  /** Compare two CIDs.
+   * @return true if they differ */
+  friend bool operator!=(const Cid& a, const Cid& b) { return !(a == b); }
+
+  /** Order two CIDs by their binary form.
+   * @return true if `a` comes before `b` */
+  friend bool operator<(const Cid& a, const Cid& b) {
+    return a.Binary() < b.Binary();
+  }
+
+ private:
+  /** Value of `size_` when the CID is stored on the heap. */
+  static constexpr uint8_t kOnHeap = 0xff;
+
+  /** Set the binary form, which must be valid. */
+  void Assign(std::string_view binary);
+
+  /** Free the heap storage, if any. */
+  void Release();
+
+  /** Get the heap storage: a pointer followed by the size, stored inside
+   * `storage_` when `size_` is `kOnHeap`. */
+  const char* HeapData() const;
+  size_t HeapSize() const;
+
+  /** The CID itself, or the location of the heap storage. */
+  char storage_[kInlineSize];
+
+  /** Size of the inline CID, or `kOnHeap`. */
+  uint8_t size_ = 0;
+};
+
+} /* namespace ipfs */
+
+namespace std {
+
+/** Hash of CIDs, to use them as keys of unordered containers. */
+template <>
+struct hash<ipfs::Cid> {
+  size_t operator()(const ipfs::Cid& cid) const { return cid.Hash(); }
+};
+
+} /* namespace std */
+
+#endif /* IPFS_CID_H */
@@ -20,12 +20,20 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 #ifndef IPFS_CLIENT_H
 #define IPFS_CLIENT_H
 
+#include <ipfs/cid.h>
+#include <ipfs/dag-pb.h>
 #include <ipfs/http/transport.h>
 
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -36,6 +44,232 @@ namespace ipfs {
  * @see https://github.com/nlohmann/json */
 using Json = nlohmann::json;
 
+/** A MerkleDAG node, as visited by `Client::DagWalk()`.
+ * @since version 0.8.0 */
+struct DagNode {
+  /** Id of the node (multihash). */
+  std::string cid;
+
+  /** Distance from the root of the walk. The root itself is at depth 0. */
+  size_t depth;
+
+  /** Raw contents of the block, as returned by `Client::BlockGet()`. */
+  std::string block;
+
+  /** The block decoded as dag-pb. Empty for raw blocks and for blocks of
+   * other codecs, whose links are not followed. The views inside it point to
+   * `block`, so they are only valid during the visitor call. */
+  dagpb::Node node;
+};
+
+/** Callback invoked by `Client::DagWalk()` for each visited node. Return true
+ * to descend into the node's links or false to skip them.
+ * @since version 0.8.0 */
+using DagVisitor = std::function<bool(const DagNode&)>;
+
+/** Callback invoked by `Client::Refs()` and `Client::RefsLocal()` for each
+ * reported block.
+ * @since version 0.8.0 */
+using RefCallback = std::function<void(const Cid&)>;
+
+/** An entry of a directory, as listed by `Client::Ls()`.
+ * @since version 0.8.0 */
+struct LsEntry {
+  /** Type of an entry. */
+  enum class Type {
+    /** Not resolved, see `LsOptions::resolve_type`. */
+    kUnknown,
+    kFile,
+    kDirectory,
+    kSymlink,
+  };
+
+  /** Name of the entry in the directory. */
+  std::string name;
+
+  /** Id of the entry. */
+  Cid cid;
+
+  /** Size of the file, or 0 if not requested, see `LsOptions::size`. */
+  uint64_t size = 0;
+
+  /** Type of the entry. */
+  Type type = Type::kUnknown;
+
+  /** Target of a symbolic link, empty for other types. */
+  std::string target;
+};
+
+/** Callback invoked by `Client::Ls()` for each entry.
+ * @since version 0.8.0 */
+using LsCallback = std::function<void(const LsEntry&)>;
+
+/** Options to control the `Client::Ls()` method.
+ * @since version 0.8.0 */
+struct LsOptions {
+  /** Find out the type of each entry. For entries that are not raw blocks
+   * this makes the peer fetch the root block of each entry. */
+  bool resolve_type = true;
+
+  /** Find out the size of each file. This makes the peer fetch the root block
+   * of each file. */
+  bool size = true;
+};
+
+/** A file, directory or symbolic link added by `Client::AddDirectory()`.
+ * @since version 0.8.0 */
+struct AddedEntry {
+  /** Path of the entry, starting with the name of the added directory, for
+   * example "dir/sub/file.txt". Empty for the wrapping directory, see
+   * `AddDirectoryOptions::wrap_with_directory`. */
+  std::string path;
+
+  /** Id of the entry. */
+  Cid cid;
+
+  /** Cumulative size of the entry, as reported by the peer. */
+  uint64_t size = 0;
+};
+
+/** Callback invoked by `Client::AddDirectory()` for each added entry.
+ * @since version 0.8.0 */
+using AddedCallback = std::function<void(const AddedEntry&)>;
+
+/** Options to control how files are added by `Client::FilesAdd()`,
+ * `Client::FilesAddIfMissing()` and `Client::AddDirectory()`. The defaults
+ * match those of `ipfs add`.
+ *
+ * An example usage:
+ * @snippet test_files.cc ipfs::AddOptions
+ *
+ * @since version 0.8.0 */
+struct AddOptions {
+  /** Chunking algorithm, for example "size-262144", "rabin-<min>-<avg>-<max>"
+   * or "buzhash". Empty for the peer's default. */
+  std::string chunker;
+
+  /** CID version, 0 or 1. */
+  unsigned cid_version = 0;
+
+  /** Store the chunks as raw blocks rather than as UnixFS nodes. `ipfs add`
+   * enables this by default together with CIDv1, which this option does not
+   * do. The raw leaves always get a CIDv1, even if `cid_version` is 0. */
+  bool raw_leaves = false;
+
+  /** Multihash function, for example "sha2-256" or "blake2b-256". Empty for
+   * the peer's default. Anything else than "sha2-256" implies CIDv1. */
+  std::string hash;
+
+  /** Use the trickle DAG layout, which suits files read sequentially, rather
+   * than the balanced one. */
+  bool trickle = false;
+
+  /** Pin the added files and directories recursively. */
+  bool pin = true;
+
+  /** Only compute the CIDs: nothing is stored by the peer. */
+  bool only_hash = false;
+
+  /** Make the peer reference the files in place (filestore) instead of
+   * copying their contents into its blockstore. The files must be readable
+   * by the peer, at the same absolute path, and the peer must have the
+   * "Experimental.FilestoreEnabled" configuration set. Implies
+   * `raw_leaves`. Only applies to files uploaded from disk
+   * (`http::FileUpload::Type::kFileName` and `Client::AddDirectory()`). */
+  bool nocopy = false;
+};
+
+/** Options to control the `Client::AddDirectory()` method.
+ * @since version 0.8.0 */
+struct AddDirectoryOptions : public AddOptions {
+  /** Include the files and directories whose name starts with a ".". */
+  bool hidden = false;
+
+  /** Wrap the directory in another one, so that its name is kept, and return
+   * the CID of the wrapping directory. */
+  bool wrap_with_directory = false;
+};
+
+/** Options to control the `Client::Get()` method.
+ * @since version 0.8.0 */
+struct GetOptions {
+  /** Number of threads writing files to disk. The download itself is never
+   * blocked by a single slow write. */
+  size_t writers = 4;
+
+  /** Maximum number of bytes received but not yet written to disk. Once
+   * reached, the download waits for the writers to catch up. */
+  size_t max_buffered = 64 * 1024 * 1024;
+};
+
+/** Options to control the `Client::DagWalk()` method.
+ * @since version 0.8.0 */
+struct DagWalkOptions {
+  /** Number of concurrent fetchers. Each one uses its own copy of the client
+   * and thus its own connection to the peer. */
+  size_t concurrency = 8;
+
+  /** Maximum number of nodes that are queued for fetching at any time. Once
+   * the frontier is full, a fetcher walks the overflowing children itself
+   * (depth-first), so memory stays bounded regardless of the fan-out. */
+  size_t max_frontier = 1 << 16;
+
+  /** Do not descend into the links of nodes at this depth. */
+  size_t max_depth = std::numeric_limits<size_t>::max();
+
+  /** Stop the walk after this many nodes have been visited. */
+  size_t max_nodes = std::numeric_limits<size_t>::max();
+};
+
+/** Options to control the `Client::DagImport()` method.
+ * @since version 0.8.0 */
+struct DagImportOptions {
+  /** Pin the roots listed in the headers of the archives, recursively. */
+  bool pin_roots = true;
+
+  /** Report the number of imported blocks and their total size. */
+  bool stats = false;
+};
+
+/** Options to control the batch `Client::PinUpdate()` method.
+ * @since version 0.8.0 */
+struct PinUpdateOptions {
+  /** Remove the old pins once the new ones are in place. */
+  bool unpin = true;
+
+  /** Number of updates performed concurrently. Each one uses its own copy of
+   * the client and thus its own connection to the peer. */
+  size_t concurrency = 4;
+};
+
+/** Options to control the `Client::PinReconcile()` method.
+ * @since version 0.8.0 */
+struct PinReconcileOptions {
+  /** Number of concurrent requests used to apply the changes. Each one uses
+   * its own copy of the client and thus its own connection to the peer. */
+  size_t concurrency = 4;
+
+  /** Maximum number of objects to pin or unpin with a single request. */
+  size_t batch_size = 64;
+
+  /** Only compute the changes, do not apply them. */
+  bool dry_run = false;
+};
+
+/** Outcome of `Client::PinReconcile()`.
+ * @since version 0.8.0 */
+struct PinReconcileResult {
+  /** Objects that were not pinned and have been pinned recursively. */
+  std::vector<Cid> added;
+
+  /** Objects that were pinned recursively and have been unpinned. */
+  std::vector<Cid> removed;
+
+  /** Number of objects that were pinned recursively and have been left
+   * alone. */
+  size_t kept = 0;
+};
+
 /** IPFS client.
  *
  * It implements the interface described in
@@ -47,6 +281,76 @@ using Json = nlohmann::json;
  * @since version 0.1.0 */
 class Client {
  public:
+  /** Deadline of the requests of a client, for as long as the object exists.
+   * The requests sent meanwhile, including those of multi-step calls like
+   * `DagWalk()` or a `FilesAdd()` followed by a `PinAdd()`, share the
+   * remaining time. Each request gets the time left both as a client-side
+   * timeout and as the server-side time-out, in place of the one given to
+   * the constructor, and throws `http::DeadlineExceededError` once the
+   * deadline is reached. Deadlines nest: the earliest one applies.
+   *
+   * An example usage:
+   * @snippet test_generic.cc ipfs::Client::Deadline
+   *
+   * @since version 0.8.0 */
+  class Deadline {
+   public:
+    /** Constructor. */
+    Deadline(
+        /** [in,out] The client, which must outlive the object. */
+        Client* client,
+        /** [in] Time left from now. */
+        std::chrono::milliseconds budget);
+
+    /** Constructor. */
+    Deadline(
+        /** [in,out] The client, which must outlive the object. */
+        Client* client,
+        /** [in] The deadline. */
+        std::chrono::steady_clock::time_point deadline);
+
+    Deadline(const Deadline&) = delete;
+    Deadline& operator=(const Deadline&) = delete;
+
+    /** Destructor, which restores the deadline the client had before. */
+    ~Deadline();
+
+   private:
+    Client* client_;
+    std::chrono::steady_clock::time_point previous_;
+  };
+
+  /** Cancellation token of the requests of a client, for as long as the
+   * object exists. Cancelling the token, from any thread, stops the
+   * requests sent meanwhile, which throw `http::CancelledError`. Unlike
+   * `Abort()`, it leaves other clients and later requests alone: there is
+   * nothing to reset. Copies of the client made meanwhile, like those of
+   * `DagWalk()`, use the token too.
+   *
+   * An example usage:
+   * @snippet test_cancellation_token.cc ipfs::Client::CancelScope
+   *
+   * @since version 0.8.0 */
+  class CancelScope {
+   public:
+    /** Constructor. */
+    CancelScope(
+        /** [in,out] The client, which must outlive the object. */
+        Client* client,
+        /** [in] The token. */
+        std::shared_ptr<http::CancellationToken> token);
+
+    CancelScope(const CancelScope&) = delete;
+    CancelScope& operator=(const CancelScope&) = delete;
+
+    /** Destructor, which restores the token the client had before. */
+    ~CancelScope();
+
+   private:
+    Client* client_;
+    std::shared_ptr<http::CancellationToken> previous_;
+  };
+
   /** Constructor.
    *
    * An example usage:
@@ -228,6 +532,18 @@ class Client {
        * retrieved. */
       std::iostream* block);
 
+  /** Get a raw IPFS block, see `BlockGet(const std::string&, std::iostream*)`.
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void BlockGet(
+      /** [in] Id of the block. */
+      const Cid& block_id,
+      /** [out] Raw contents of the block is written to this stream as it is
+       * retrieved. */
+      std::iostream* block);
+
   /** Store a raw block in IPFS.
    *
    * Implements
@@ -245,6 +561,31 @@ class Client {
       /** [out] Information about the stored block. */
       Json* stat);
 
+  /** Check whether the peer has a block in its local store, without asking
+   * the network for it.
+   *
+   * An example usage:
+   * @snippet test_files.cc ipfs::Client::BlockExists
+   *
+   * @return true if the block is stored locally
+   * @throw std::exception if any other error occurs
+   *
+   * @since version 0.8.0 */
+  bool BlockExists(
+      /** [in] Id of the block (multihash). */
+      const std::string& block_id);
+
+  /** Check whether the peer has a block in its local store, see
+   * `BlockExists(const std::string&)`.
+   *
+   * @return true if the block is stored locally
+   * @throw std::exception if any other error occurs
+   *
+   * @since version 0.8.0 */
+  bool BlockExists(
+      /** [in] Id of the block. */
+      const Cid& block_id);
+
   /** Get information for a raw IPFS block.
    *
    * Implements
@@ -262,6 +603,62 @@ class Client {
       /** [out] Retrieved information about the block. */
       Json* stat);
 
+  /** Get information for a raw IPFS block, see
+   * `BlockStat(const std::string&, Json*)`.
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void BlockStat(
+      /** [in] Id of the block. */
+      const Cid& block_id,
+      /** [out] Retrieved information about the block. */
+      Json* stat);
+
+  /** List the blocks linked from an object. The list is streamed: `callback`
+   * is invoked for each block as soon as the peer reports it.
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-refs.
+   *
+   * An example usage:
+   * @snippet test_block.cc ipfs::Client::Refs
+   *
+   * @throw std::exception if any error occurs, including an exception thrown
+   * by `callback`, which stops the listing
+   *
+   * @since version 0.8.0 */
+  void Refs(
+      /** [in] Id of the object whose links to list (multihash). */
+      const std::string& root,
+      /** [in] List the links of the linked objects too, recursively. */
+      bool recursive,
+      /** [in] Report each block only once, even if it is linked from several
+       * objects. */
+      bool unique,
+      /** [in] Callback to invoke for each block. */
+      const RefCallback& callback);
+
+  /** List all the blocks in the local store of the peer. The list is
+   * streamed: `callback` is invoked for each block as soon as the peer
+   * reports it.
+   *
+   * Recent peers report the blocks as CIDv1 with the raw multicodec,
+   * whatever CID they were stored under, so compare them by
+   * `cid::Multihash()`, or use a `BlockIndex`.
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-refs-local.
+   *
+   * An example usage:
+   * @snippet test_block.cc ipfs::Client::RefsLocal
+   *
+   * @throw std::exception if any error occurs, including an exception thrown
+   * by `callback`, which stops the listing
+   *
+   * @since version 0.8.0 */
+  void RefsLocal(
+      /** [in] Callback to invoke for each block. */
+      const RefCallback& callback);
+
   /** Get a file from IPFS.
    *
    * Implements
@@ -298,13 +695,75 @@ class Client {
       /** [out] List of results, one per file. For example:
        * [{"path": "foo.txt", "hash": "Qm...", "size": 123}, {"path": ...}, ...]
        */
-      Json* result);
+      Json* result,
+      /** [in] How to add the files. Since version 0.8.0. */
+      const AddOptions& options = AddOptions());
+
+  /** Add a local directory to IPFS, recursively.
+   *
+   * The directory tree is walked while it is being uploaded, as a single
+   * multipart request with one part per file, directory and symbolic link.
+   * Neither the list of files nor their contents are ever held in memory as
+   * a whole, so trees of millions of files can be added.
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-add.
+   *
+   * An example usage:
+   * @snippet test_files.cc ipfs::Client::AddDirectory
+   *
+   * @throw std::invalid_argument if `local_path` is not a directory
+   * @throw std::exception if any error occurs, including an exception thrown
+   * by `callback` or an error reading the local files, which abort the
+   * upload
+   *
+   * @since version 0.8.0 */
+  void AddDirectory(
+      /** [in] Path of the local directory. Symbolic links below it are added
+       * as links, not followed. Files that are neither regular files,
+       * directories nor symbolic links are skipped. */
+      const std::string& local_path,
+      /** [out] CID of the added directory, for example "QmUNLLsP...". */
+      std::string* cid,
+      /** [in] Callback to invoke for each added entry, including the
+       * directory itself, as soon as the peer reports it. May be empty. */
+      const AddedCallback& callback = AddedCallback(),
+      /** [in] Upload options. */
+      const AddDirectoryOptions& options = AddDirectoryOptions());
+
+  /** Add a file to IPFS, unless the peer already has all of it.
+   *
+   * The CID of the file is computed locally with `FileHasher`, using the same
+   * options as the upload, and the file is only uploaded if the peer does
+   * not hold all of its blocks. For `http::FileUpload::Type::kStream` the
+   * stream is read twice, so it must be seekable. Options that `FileHasher`
+   * does not support (a chunker other than "size-<n>", a hash other than
+   * "sha2-256", the trickle layout or `AddOptions::nocopy`) make the CID be
+   * computed by the peer instead, with `AddOptions::only_hash`, which costs
+   * an extra upload.
+   *
+   * An example usage:
+   * @snippet test_files.cc ipfs::Client::FilesAddIfMissing
+   *
+   * @return true if the file had to be uploaded
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  bool FilesAddIfMissing(
+      /** [in] File to add. */
+      const http::FileUpload& file,
+      /** [out] Id of the file (multihash). */
+      std::string* cid,
+      /** [in] How to add the file. */
+      const AddOptions& options = AddOptions());
 
   /** List directory contents for Unix filesystem objects.
    *
    * Implements
    * https://github.com/ipfs/js-ipfs/blob/master/docs/core-api/FILES.md#ls.
    *
+   * The whole listing is returned at once, using the deprecated `file/ls`
+   * command. Prefer `Ls()` for large directories.
+   *
    * An example usage:
    * @snippet test_files.cc ipfs::Client::FilesLs
    *
@@ -343,6 +802,238 @@ class Client {
       */
       Json* result);
 
+  /** Download a file or a directory, recursively, to the local file system.
+   * The archive sent by the peer is extracted as it is received, without
+   * being held in memory or on disk, and the files are written by a pool of
+   * threads so that the disk keeps up with the network.
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-get.
+   *
+   * An example usage:
+   * @snippet test_files.cc ipfs::Client::Get
+   *
+   * @throw std::invalid_argument if `options.writers` is 0
+   * @throw std::exception if any error occurs, including an entry whose path
+   * would escape `destination`. The files written so far are left in place.
+   *
+   * @since version 0.8.0 */
+  void Get(
+      /** [in] Path of the file or directory in IPFS, for example
+       * "/ipfs/Qm.../dir" or "Qm...". */
+      const std::string& path,
+      /** [in] Local directory to download to, created if needed. The file
+       * or directory is written to `destination`/<last component of
+       * `path`>. */
+      const std::string& destination,
+      /** [in] Download options. */
+      const GetOptions& options = GetOptions());
+
+  /** List a directory, including a HAMT sharded one. The listing is
+   * streamed: `callback` is invoked for each entry as soon as the peer
+   * reports it, so that directories with millions of entries can be listed
+   * with a constant amount of memory.
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-ls.
+   *
+   * An example usage:
+   * @snippet test_files.cc ipfs::Client::Ls
+   *
+   * @throw std::exception if any error occurs, including an exception thrown
+   * by `callback`, which stops the listing
+   *
+   * @since version 0.8.0 */
+  void Ls(
+      /** [in] Path of the directory, for example "/ipfs/Qm..." or "Qm...". */
+      const std::string& path,
+      /** [in] Callback to invoke for each entry. */
+      const LsCallback& callback,
+      /** [in] Listing options. */
+      const LsOptions& options = LsOptions());
+
+  /** Write to a file of the Mutable File System (MFS), the peer's local,
+   * mutable view of UnixFS. Only the written range is sent, so appending to
+   * a large file costs the size of the appended data.
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-files-write.
+   *
+   * An example usage:
+   * @snippet test_mfs.cc ipfs::Client::FilesWrite
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void FilesWrite(
+      /** [in] Path of the file in MFS, for example "/logs/today.log". */
+      const std::string& path,
+      /** [in] Offset in the file to write at. It may be past the end of the
+       * file, which is then extended with zeros. */
+      uint64_t offset,
+      /** [in] Data to write, streamed to the peer. */
+      const http::FileUpload& source,
+      /** [in] Create the file if it does not exist. */
+      bool create = true,
+      /** [in] Truncate the file to 0 bytes before writing. */
+      bool truncate = false,
+      /** [in] Flush the changes to the root of MFS. Pass false to batch many
+       * changes, then call `FilesFlush()`. */
+      bool flush = true);
+
+  /** Read a file of the Mutable File System (MFS).
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-files-read.
+   *
+   * An example usage:
+   * @snippet test_mfs.cc ipfs::Client::FilesRead
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void FilesRead(
+      /** [in] Path of the file in MFS. */
+      const std::string& path,
+      /** [in] Offset in the file to read from. */
+      uint64_t offset,
+      /** [in] Maximum number of bytes to read. Less are read if the end of
+       * the file is reached, so `std::numeric_limits<uint64_t>::max()` reads
+       * until the end. */
+      uint64_t count,
+      /** [out] The bytes are written to this stream as they are received. */
+      std::iostream* data);
+
+  /** Get information about a file or directory of the Mutable File System
+   * (MFS). `path` may also be an IPFS path, like "/ipfs/Qm...".
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-files-stat.
+   *
+   * An example usage:
+   * @snippet test_mfs.cc ipfs::Client::FilesStat
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void FilesStat(
+      /** [in] Path in MFS. */
+      const std::string& path,
+      /** [out] Information about the object. For example:
+       * {"Hash": "Qm...", "Size": 123, "CumulativeSize": 456, "Blocks": 1,
+       *  "Type": "file"} */
+      Json* stat);
+
+  /** Create a directory in the Mutable File System (MFS).
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-files-mkdir.
+   *
+   * An example usage:
+   * @snippet test_mfs.cc ipfs::Client::FilesMkdir
+   *
+   * @throw std::exception if any error occurs, for example if `path` already
+   * exists and `parents` is false
+   *
+   * @since version 0.8.0 */
+  void FilesMkdir(
+      /** [in] Path of the directory in MFS. */
+      const std::string& path,
+      /** [in] Create the missing parent directories too, and do not fail if
+       * the directory already exists. */
+      bool parents = false,
+      /** [in] Flush the changes to the root of MFS. */
+      bool flush = true);
+
+  /** Move or rename a file or directory of the Mutable File System (MFS).
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-files-mv.
+   *
+   * An example usage:
+   * @snippet test_mfs.cc ipfs::Client::FilesMv
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void FilesMv(
+      /** [in] Current path in MFS. */
+      const std::string& source,
+      /** [in] New path in MFS. */
+      const std::string& destination,
+      /** [in] Flush the changes to the root of MFS. */
+      bool flush = true);
+
+  /** Copy a file or directory into the Mutable File System (MFS), without
+   * copying its data. The source may be in MFS or an IPFS path, like
+   * "/ipfs/Qm...".
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-files-cp.
+   *
+   * An example usage:
+   * @snippet test_mfs.cc ipfs::Client::FilesCp
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void FilesCp(
+      /** [in] Path to copy. */
+      const std::string& source,
+      /** [in] Path of the copy in MFS. */
+      const std::string& destination,
+      /** [in] Flush the changes to the root of MFS. */
+      bool flush = true);
+
+  /** Remove a file or directory from the Mutable File System (MFS).
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-files-rm.
+   *
+   * An example usage:
+   * @snippet test_mfs.cc ipfs::Client::FilesRm
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void FilesRm(
+      /** [in] Path in MFS. */
+      const std::string& path,
+      /** [in] Remove directories with their contents. */
+      bool recursive = false,
+      /** [in] Flush the changes to the root of MFS. */
+      bool flush = true);
+
+  /** Write the pending changes of a path of the Mutable File System (MFS)
+   * and of its parents to the blockstore, after changes made with
+   * `flush` set to false.
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-files-flush.
+   *
+   * An example usage:
+   * @snippet test_mfs.cc ipfs::Client::FilesFlush
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void FilesFlush(
+      /** [in] Path in MFS, "/" for everything. */
+      const std::string& path,
+      /** [out] Id of the object at `path` (multihash). */
+      std::string* cid);
+
+  /** List a directory of the Mutable File System (MFS). The entries are
+   * handed to `callback` one by one while the reply is received, so that
+   * only one entry of a large directory is held in memory at a time.
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-files-ls.
+   *
+   * An example usage:
+   * @snippet test_mfs.cc ipfs::Client::FilesList
+   *
+   * @throw std::exception if any error occurs, including an exception thrown
+   * by `callback`
+   *
+   * @since version 0.8.0 */
+  void FilesList(
+      /** [in] Path of the directory in MFS. */
+      const std::string& path,
+      /** [in] Callback to invoke for each entry. For example:
+       * {"Name": "today.log", "Type": 0, "Size": 123, "Hash": "Qm..."},
+       * where "Type" is 0 for files and 1 for directories. */
+      const std::function<void(const Json&)>& callback);
+
   /** Generate a new key.
    *
    * Implements
@@ -566,6 +1257,89 @@ class Client {
        * {"NumLinks": 0, "BlockSize": 10, "LinksSize": 2, ...} */
       Json* stat);
 
+  /** Traverse a MerkleDAG breadth-first, starting at a given node.
+   *
+   * The blocks are fetched by a pool of concurrent fetchers which steal work
+   * from each other when their own queue runs dry, and they are decoded
+   * locally, without asking the peer to convert them to JSON. Each node is
+   * visited at most once, even if it is reachable through more than one
+   * path. The visitor is never called concurrently, but it is called from
+   * the fetcher threads, not from the calling one.
+   *
+   * An example usage:
+   * @snippet test_dag.cc ipfs::Client::DagWalk
+   *
+   * @throw std::exception if any error occurs, including an exception thrown
+   * by the visitor. The walk is stopped at the first error.
+   *
+   * @since version 0.8.0 */
+  void DagWalk(
+      /** [in] Id of the node to start from (multihash). */
+      const std::string& root,
+      /** [in] Callback to invoke for each visited node. */
+      const DagVisitor& visitor,
+      /** [in] Walk options. */
+      const DagWalkOptions& options = DagWalkOptions());
+
+  /** Export a MerkleDAG as a CARv1 archive.
+   *
+   * The archive is streamed to `car` as it is produced by the peer, so with a
+   * file stream memory usage does not depend on the size of the DAG. Use
+   * `car::Reader` to process it locally.
+   *
+   * Implements
+   * https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-dag-export.
+   *
+   * An example usage:
+   * @snippet test_dag.cc ipfs::Client::DagExport
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void DagExport(
+      /** [in] Id of the root of the DAG (multihash). */
+      const std::string& root,
+      /** [out] The archive is written to this stream as it is retrieved. */
+      std::iostream* car);
+
+  /** Export a MerkleDAG as a CARv1 archive, see
+   * `DagExport(const std::string&, std::iostream*)`.
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void DagExport(
+      /** [in] Id of the root of the DAG. */
+      const Cid& root,
+      /** [out] The archive is written to this stream as it is retrieved. */
+      std::iostream* car);
+
+  /** Import the blocks of CARv1 archives.
+   *
+   * The archives are streamed to the peer: use `http::FileUpload::Type::
+   * kFileName` for archives on disk or `http::FileUpload::Type::kStream` for
+   * archives produced on the fly, for example by `car::Writer`.
+   *
+   * Implements
+   * https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-dag-import.
+   *
+   * An example usage:
+   * @snippet test_dag.cc ipfs::Client::DagImport
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void DagImport(
+      /** [in] Archives to import. */
+      const std::vector<http::FileUpload>& cars,
+      /** [out] The roots of the archives and, if requested, statistics. For
+       * example:
+       * {"Roots": [{"Cid": "bafy...", "PinErrorMsg": ""}, ...],
+       *  "Stats": {"BlockCount": 12, "BlockBytesCount": 3456}} */
+      Json* result,
+      /** [in] Import options. */
+      const DagImportOptions& options = DagImportOptions());
+
   /** Create a new object from an existing MerkleDAG node and add to its links.
    *
    * Implements
@@ -660,6 +1434,15 @@ class Client {
       /** [in] Id of the object to pin (multihash). */
       const std::string& object_id);
 
+  /** Pin a given IPFS object, see `PinAdd(const std::string&)`.
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void PinAdd(
+      /** [in] Id of the object to pin. */
+      const Cid& object_id);
+
   /** List all the objects pinned to local storage.
    *
    * Implements
@@ -719,6 +1502,112 @@ class Client {
       /** [in] Unpin options. */
       PinRmOptions options);
 
+  /** Unpin an object, see `PinRm(const std::string&, PinRmOptions)`.
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void PinRm(
+      /** [in] Id of the object to unpin. */
+      const Cid& object_id,
+      /** [in] Unpin options. */
+      PinRmOptions options);
+
+  /** Replace a recursive pin by another one. Unlike `PinAdd()` followed by
+   * `PinRm()`, only the parts of the new DAG that are not reachable from the
+   * old one are fetched and pinned, which is much faster when the two share
+   * most of their blocks, as successive versions of a dataset do.
+   *
+   * Implements https://docs.ipfs.tech/reference/kubo/rpc/#api-v0-pin-update.
+   *
+   * An example usage:
+   * @snippet test_pin.cc ipfs::Client::PinUpdate
+   *
+   * @throw std::exception if any error occurs, for example if `from` is not
+   * pinned recursively
+   *
+   * @since version 0.8.0 */
+  void PinUpdate(
+      /** [in] Id of the pinned object (multihash). */
+      const std::string& from,
+      /** [in] Id of the object to pin instead (multihash). */
+      const std::string& to,
+      /** [in] Remove the pin of `from` once `to` is pinned. */
+      bool unpin = true);
+
+  /** Replace a recursive pin by another one, see
+   * `PinUpdate(const std::string&, const std::string&, bool)`.
+   *
+   * @throw std::exception if any error occurs
+   *
+   * @since version 0.8.0 */
+  void PinUpdate(
+      /** [in] Id of the pinned object. */
+      const Cid& from,
+      /** [in] Id of the object to pin instead. */
+      const Cid& to,
+      /** [in] Remove the pin of `from` once `to` is pinned. */
+      bool unpin = true);
+
+  /** Perform several pin updates, see
+   * `PinUpdate(const std::string&, const std::string&, bool)`. The updates
+   * run concurrently, in no particular order, so they must be independent of
+   * each other: chained updates such as A to B and B to C are not supported.
+   *
+   * @throw std::exception the first error encountered by any update. The
+   * other updates may or may not have been performed.
+   *
+   * @since version 0.8.0 */
+  void PinUpdate(
+      /** [in] Pairs of (pinned object, object to pin instead). */
+      const std::vector<std::pair<Cid, Cid>>& updates,
+      /** [in] Update options. */
+      const PinUpdateOptions& options = PinUpdateOptions());
+
+  /** Make the set of recursively pinned objects equal to `desired`: pin the
+   * objects of `desired` that are not pinned yet and unpin the ones that are
+   * pinned but not in `desired`. Direct and indirect pins are left alone.
+   *
+   * The current pins are streamed from the peer and kept in a compact sorted
+   * array, and the changes are sent in batches over several connections,
+   * the additions before the removals.
+   *
+   * CIDs are compared in their binary form, so `desired` should use the same
+   * CID version as the objects were pinned with.
+   *
+   * An example usage:
+   * @snippet test_pin.cc ipfs::Client::PinReconcile
+   *
+   * @throw std::exception if any error occurs. `result` then holds the
+   * changes that were planned, some of which may have been applied.
+   *
+   * @since version 0.8.0 */
+  void PinReconcile(
+      /** [in] Objects that must end up pinned recursively. */
+      const std::unordered_set<Cid>& desired,
+      /** [out] Changes that have been made. */
+      PinReconcileResult* result,
+      /** [in] Reconciliation options. */
+      const PinReconcileOptions& options = PinReconcileOptions());
+
+  /** Same as `PinReconcile(const std::unordered_set<Cid>&, ...)` but with the
+   * desired objects given as a sorted array, which avoids building a hash
+   * set out of a large catalog.
+   *
+   * @throw std::invalid_argument if `desired_sorted` is not sorted or
+   * contains duplicates
+   * @throw std::exception if any other error occurs
+   *
+   * @since version 0.8.0 */
+  void PinReconcile(
+      /** [in] Objects that must end up pinned recursively, in ascending order
+       * according to `Cid::operator<()`, without duplicates. */
+      const std::vector<Cid>& desired_sorted,
+      /** [out] Changes that have been made. */
+      PinReconcileResult* result,
+      /** [in] Reconciliation options. */
+      const PinReconcileOptions& options = PinReconcileOptions());
+
   /** Get IPFS bandwidth (bw) information.
    *
    * Implements
@@ -828,6 +1717,92 @@ class Client {
       /** [out] The retrieved list. */
       Json* peers);
 
+  /** Get the address of the peer's API, as given to the constructor.
+   * @return the URL prefix of all requests, for example
+   * "http://localhost:5001/api/v0"
+   *
+   * @since version 0.8.0 */
+  const std::string& UrlPrefix() const;
+
+  /** Retry failed requests as set by a policy, instead of throwing at the
+   * first connection reset or overload status. Copies of the client made
+   * afterwards retry the same way. By default, requests are not retried.
+   *
+   * An example usage:
+   * @snippet test_retry.cc ipfs::Client::SetRetryPolicy
+   *
+   * @throw std::invalid_argument if `policy.max_attempts` is 0
+   *
+   * @since version 0.8.0 */
+  void SetRetryPolicy(
+      /** [in] When and how to retry, see `http::RetryPolicy`. */
+      const http::RetryPolicy& policy);
+
+  /** Guard the requests with the circuit breaker of the peer, shared by all
+   * clients with the same `UrlPrefix()`, see
+   * `http::CircuitBreaker::Shared()`. While it is open, requests throw
+   * `http::CircuitOpenError` at once instead of waiting for a failing peer.
+   * Copies of the client made afterwards use the same breaker.
+   *
+   * An example usage:
+   * @snippet test_circuit_breaker.cc ipfs::Client::SetCircuitBreaker
+   *
+   * @throw std::invalid_argument if the options are out of range
+   *
+   * @since version 0.8.0 */
+  void SetCircuitBreaker(
+      /** [in] Options of the breaker, if it does not exist yet. */
+      const http::CircuitBreakerOptions& options =
+          http::CircuitBreakerOptions());
+
+  /** Make the requests wait for their turn in a rate limiter, which limits
+   * the rate and the concurrency of each class of requests (reads, writes,
+   * DHT, pins). Requests beyond the limits of the limiter wait, or throw
+   * `http::RateLimitError`. Give the same limiter to several clients to
+   * limit them together. Copies of the client made afterwards use the same
+   * limiter.
+   *
+   * An example usage:
+   * @snippet test_rate_limiter.cc ipfs::Client::SetRateLimiter
+   *
+   * @since version 0.8.0 */
+  void SetRateLimiter(
+      /** [in] The limiter, or null to remove it. */
+      std::shared_ptr<http::RateLimiter> limiter);
+
+  /** Make the transfers wait for a slot of a scheduler, usually shared with
+   * other clients of the same peer, which serves the priorities fairly and
+   * pauses running transfers while requests of a higher priority wait. For
+   * example, a replication job and a request handler can use two clients of
+   * the same scheduler, with `http::Priority::kBulk` and
+   * `http::Priority::kInteractive`. Copies of the client made afterwards use
+   * the same scheduler and priority.
+   *
+   * An example usage:
+   * @snippet test_priority_scheduler.cc ipfs::Client::SetScheduler
+   *
+   * @since version 0.8.0 */
+  void SetScheduler(
+      /** [in] The scheduler, or null to remove it. */
+      std::shared_ptr<http::PriorityScheduler> scheduler,
+      /** [in] Priority of the requests of this client. */
+      http::Priority priority = http::Priority::kNormal);
+
+  /** Cap the bandwidth of the transfers with a limiter, which splits its
+   * limits evenly between the transfers in progress and may be changed at
+   * any time. A limiter of the client alone caps it, one given to several
+   * clients caps them together, and `http::BandwidthLimiter::Global()` caps
+   * the whole process. Copies of the client made afterwards use the same
+   * limiter.
+   *
+   * An example usage:
+   * @snippet test_bandwidth_limiter.cc ipfs::Client::SetBandwidthLimiter
+   *
+   * @since version 0.8.0 */
+  void SetBandwidthLimiter(
+      /** [in] The limiter, or null to remove it. */
+      std::shared_ptr<http::BandwidthLimiter> limiter);
+
   /** Abort any current running IPFS API request.
    *
    * Very useful if you were using the IPFS client API calls inside seperate
@@ -840,6 +1815,8 @@ class Client {
    *
    * @snippet test_threading.cc ipfs::Client::Abort
    *
+   * To stop some requests only, see `CancelScope`.
+   *
    * @since version 0.6.0 */
   void Abort();
 
@@ -877,6 +1854,103 @@ class Client {
       /** [out] Parsed JSON response. */
       Json* response);
 
+  /** Convert add options to the parameters of the add API.
+   * @return the parameters */
+  static std::vector<std::pair<std::string, std::string>> AddParameters(
+      /** [in] Options to convert. */
+      const AddOptions& options);
+
+  /** Fetch an URL and pass the body of the reply to `on_chunk`, piece by
+   * piece, as it is received.
+   *
+   * @throw std::exception if any error occurs, including an exception thrown
+   * by `on_chunk`, which aborts the transfer */
+  void FetchChunks(
+      /** [in] URL to fetch. */
+      const std::string& url,
+      /** [in] List of files to submit. */
+      const std::vector<http::FileUpload>& files,
+      /** [in] Callback to invoke for each piece of the reply. */
+      const std::function<void(std::string_view)>& on_chunk);
+
+  /** Same as above, but submit a body that is produced while it is being
+   * uploaded. */
+  void FetchChunks(
+      /** [in] URL to fetch. */
+      const std::string& url,
+      /** [in] Content type of the body. */
+      const std::string& content_type,
+      /** [in] Stream to read the body from. */
+      std::istream* upload,
+      /** [in] Callback to invoke for each piece of the reply. */
+      const std::function<void(std::string_view)>& on_chunk);
+
+  /** Fetch an URL that returns one JSON per line and pass each of them to
+   * `callback` as soon as it has been received, so that the reply is never
+   * held in memory as a whole.
+   *
+   * @throw std::exception if any error occurs, including an exception thrown
+   * by `callback`, which aborts the transfer */
+  void FetchJsonLines(
+      /** [in] URL to fetch. */
+      const std::string& url,
+      /** [in] List of files to submit. */
+      const std::vector<http::FileUpload>& files,
+      /** [in] Callback to invoke for each line of the reply. */
+      const std::function<void(const Json&)>& callback);
+
+  /** Same as above, but submit a body that is produced while it is being
+   * uploaded. */
+  void FetchJsonLines(
+      /** [in] URL to fetch. */
+      const std::string& url,
+      /** [in] Content type of the body. */
+      const std::string& content_type,
+      /** [in] Stream to read the body from. */
+      std::istream* upload,
+      /** [in] Callback to invoke for each line of the reply. */
+      const std::function<void(const Json&)>& callback);
+
+  /** Run `jobs` jobs over up to `concurrency` copies of this client, one
+   * thread per copy. Once a job has failed, no new job is started.
+   *
+   * @throw std::exception the first error thrown by any job */
+  void RunConcurrently(
+      /** [in] Number of jobs. */
+      size_t jobs,
+      /** [in] Maximum number of jobs running at the same time. */
+      size_t concurrency,
+      /** [in] Job runner, called with the client to use and the index of the
+       * job, from 0 to `jobs` - 1. */
+      const std::function<void(Client*, size_t)>& job);
+
+  /** Handle a line of the reply of `refs` or `refs/local`.
+   *
+   * @throw std::exception if the line reports an error or is malformed */
+  static void ParseRef(
+      /** [in] Line of the reply. */
+      const Json& ref,
+      /** [in] Callback to invoke with the block of the line. */
+      const RefCallback& callback);
+
+  /** Get the recursively pinned objects, streaming the list from the peer.
+   *
+   * @throw std::exception if any error occurs */
+  void ListRecursivePins(
+      /** [out] Pinned objects, sorted. */
+      std::vector<Cid>* pinned);
+
+  /** Apply the changes computed by `PinReconcile()`.
+   *
+   * @throw std::exception the first error encountered by any request */
+  void ApplyPinChanges(
+      /** [in] Objects to pin. */
+      const std::vector<Cid>& add,
+      /** [in] Objects to unpin. */
+      const std::vector<Cid>& remove,
+      /** [in] Reconciliation options. */
+      const PinReconcileOptions& options);
+
   /** Parse a string into a JSON. It just calls Json::parse() and appends the
    * input to the error message in case of an error.
    *
@@ -923,6 +1997,14 @@ class Client {
 
   /** Server-side time-out setting */
   std::string timeout_value_;
+
+  /** Deadline of the requests, see `Deadline`. `time_point::max()` for
+   * none. */
+  std::chrono::steady_clock::time_point deadline_ =
+      std::chrono::steady_clock::time_point::max();
+
+  /** Cancellation token of the requests, see `CancelScope`. */
+  std::shared_ptr<http::CancellationToken> cancellation_token_;
 };
 } /* namespace ipfs */
 
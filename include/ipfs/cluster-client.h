@@ -0,0 +1,365 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_CLUSTER_CLIENT_H
+#define IPFS_CLUSTER_CLIENT_H
+
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+#include <ipfs/http/cancellation-token.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ipfs {
+
+/** Options to control a `ClusterClient`.
+ * @since version 0.8.0 */
+struct ClusterOptions {
+  /** How to pick the node that serves a request among the healthy ones. */
+  enum class Balancing {
+    /** The node with the fewest requests in progress. */
+    kLeastOutstanding,
+    /** The node with the fewest requests in progress among two picked at
+     * random, which avoids sending every request to the same node when the
+     * counts are stale or equal. */
+    kPowerOfTwoChoices,
+  };
+
+  /** How to pick the node that serves a request. */
+  Balancing balancing = Balancing::kPowerOfTwoChoices;
+
+  /** Interval between two health probes (`Client::Version()`) of each node.
+   * 0 disables the probes: all nodes are then considered healthy. */
+  std::chrono::milliseconds probe_interval{5000};
+
+  /** Time a probe may take, after which it fails. The nodes are probed in
+   * parallel, so that a node that hangs delays neither the others nor
+   * `ClusterClient::~ClusterClient()`. */
+  std::chrono::milliseconds probe_timeout{2000};
+
+  /** Number of consecutive failed probes after which a node is drained: it
+   * gets no new requests until a probe succeeds again. */
+  unsigned failure_threshold = 2;
+
+  /** Number of nodes that own each CID, see `ClusterClient::Owners()`. */
+  size_t replication = 1;
+
+  /** Whether to hedge reads: if the response of a read does not start
+   * within a delay, the same read is sent to the next owner (or over another
+   * connection to the same node if there is no other one), the response that
+   * starts first is used and the other read is cancelled. Applies to
+   * `ClusterClient::CallHedged()`, `ClusterClient::BlockGet()` and
+   * `ClusterClient::FilesGet()`, whose requests are idempotent. */
+  bool hedge = false;
+
+  /** Percentile of the recent times to first byte after which a read is
+   * hedged, between 0 and 1. Higher values send fewer hedges, and thus less
+   * extra load, but shorten fewer slow reads. */
+  double hedge_percentile = 0.95;
+
+  /** Delay before a read is hedged while too few reads have been timed to
+   * compute the percentile. */
+  std::chrono::milliseconds hedge_delay{100};
+};
+
+/** State of a node of a `ClusterClient`.
+ * @since version 0.8.0 */
+struct ClusterNodeStatus {
+  /** Address of the node's API, see `Client::UrlPrefix()`. */
+  std::string url_prefix;
+
+  /** Whether the node gets new requests. */
+  bool healthy = true;
+
+  /** Number of requests in progress. */
+  size_t outstanding = 0;
+
+  /** Number of requests sent to the node so far. */
+  uint64_t requests = 0;
+
+  /** Number of those requests that threw. */
+  uint64_t failures = 0;
+};
+
+/** Counters of the hedged reads of a `ClusterClient`.
+ * @since version 0.8.0 */
+struct ClusterHedgeStatus {
+  /** Number of reads run with hedging. */
+  uint64_t reads = 0;
+
+  /** Number of those reads for which a hedge was sent. */
+  uint64_t hedges = 0;
+
+  /** Number of hedges whose response started first. */
+  uint64_t wins = 0;
+
+  /** Current delay before a read is hedged. */
+  std::chrono::microseconds delay{0};
+};
+
+/** Spreads requests over several peers (nodes), for example a fleet of
+ * daemons that hold the same data.
+ *
+ * Each request is run on a `Client` of one of the healthy nodes, picked as
+ * set by `ClusterOptions::balancing`. A background thread probes every node
+ * and drains the ones that stop answering. Each node keeps a pool of
+ * clients, one per request in progress, so the object is thread-safe: any
+ * number of threads can send requests through it at the same time.
+ *
+ * An example usage:
+ * @snippet test_cluster_client.cc ipfs::ClusterClient
+ *
+ * @since version 0.8.0 */
+class ClusterClient {
+ public:
+  /** Constructor.
+   * @throw std::invalid_argument if `nodes` is empty */
+  explicit ClusterClient(
+      /** [in] One client per node, copied to talk to that node. */
+      const std::vector<Client>& nodes,
+      /** [in] Cluster options. */
+      const ClusterOptions& options = ClusterOptions());
+
+  /** Destructor. Cancels the probes in progress, if any. */
+  ~ClusterClient();
+
+  ClusterClient(const ClusterClient&) = delete;
+  ClusterClient& operator=(const ClusterClient&) = delete;
+
+  /** Run a request on one of the healthy nodes.
+   * @throw std::runtime_error if no node is healthy
+   * @throw std::exception anything thrown by `request` */
+  void Call(
+      /** [in] Request to run, with the client of the chosen node, for
+       * example `[&](ipfs::Client* c) { c->BlockGet(cid, &block); }`. The
+       * client is only used by this request while it runs. */
+      const std::function<void(Client*)>& request);
+
+  /** Run a read request on one of the healthy nodes, hedged on another one
+   * if `ClusterOptions::hedge` is set.
+   * @throw std::runtime_error if no node is healthy
+   * @throw std::exception the error of the read whose response was used, or
+   * of the first read if none of them started */
+  void CallHedged(
+      /** [in] Idempotent request to run, with the client of the chosen node
+       * and the stream to write the response to, for example
+       * `[&](ipfs::Client* c, std::iostream* s) { c->BlockGet(cid, s); }`.
+       * It may run twice at the same time, with different clients and
+       * streams. */
+      const std::function<void(Client*, std::iostream*)>& request,
+      /** [out] Response of the read. */
+      std::iostream* response);
+
+  /** Get the nodes that own a CID, in order of preference.
+   *
+   * The owners are chosen by rendezvous hashing: each node gets a score for
+   * the CID and the `ClusterOptions::replication` best ones own it. The
+   * score of a node is
+   *
+   *     splitmix64(murmur3(url_prefix) ^ murmur3(multihash))
+   *
+   * where `murmur3` is the first 64 bits of MurmurHash3 x64 128 (seed 0),
+   * `url_prefix` is `Client::UrlPrefix()` of the node, `multihash` is the
+   * binary multihash of the CID, so that CIDv0 and CIDv1 of the same
+   * content have the same owners, and `splitmix64` is the finalizer of the
+   * SplitMix64 generator. Ties go to the node that comes first. The owners
+   * do not depend on the order of the nodes nor on their health, and adding
+   * a node only moves to it the CIDs it now owns.
+   *
+   * @return indexes of the nodes, `ClusterOptions::replication` of them, or
+   * all of them if there are fewer nodes */
+  std::vector<size_t> Owners(
+      /** [in] The CID. */
+      const Cid& cid) const;
+
+  /** Run a read request on the best healthy owner of a CID, and on the next
+   * owners in turn if it fails.
+   * @throw std::runtime_error if no owner is healthy
+   * @throw std::exception the error of the last owner tried */
+  void CallOwner(
+      /** [in] The CID the request is about. */
+      const Cid& cid,
+      /** [in] Request to run, see `Call()`. */
+      const std::function<void(Client*)>& request);
+
+  /** Run a write request on all the owners of a CID, concurrently. Drained
+   * owners are tried too, since the data must reach all of them.
+   * @throw std::exception the first error of any owner, once all are done */
+  void CallOwners(
+      /** [in] The CID the request is about. */
+      const Cid& cid,
+      /** [in] Request to run, see `Call()`. */
+      const std::function<void(Client*)>& request);
+
+  /** Pin an object recursively on all its owners.
+   * @throw std::exception if any error occurs */
+  void PinAdd(
+      /** [in] Id of the object to pin. */
+      const Cid& object_id);
+
+  /** Store a raw block on all its owners. The owners are those of the
+   * sha2-256 multihash of the block, which is the one the peer gives it.
+   * @throw std::invalid_argument if `block` is not of type
+   * `http::FileUpload::Type::kFileContents`
+   * @throw std::exception if any other error occurs */
+  void BlockPut(
+      /** [in] Raw contents of the block to store. */
+      const http::FileUpload& block,
+      /** [out] Information about the stored block, from the best owner. */
+      Json* stat);
+
+  /** Get a raw block from its owners, see `CallOwner()`. A failed owner is
+   * only skipped if nothing was written to `block` yet. The read is hedged
+   * if `ClusterOptions::hedge` is set.
+   * @throw std::exception if any error occurs */
+  void BlockGet(
+      /** [in] Id of the block. */
+      const Cid& block_id,
+      /** [out] Raw contents of the block. */
+      std::iostream* block);
+
+  /** Get a file from the owners of its root, see `CallOwner()` and
+   * `Client::FilesGet()`. A failed owner is only skipped if nothing was
+   * written to `response` yet. The read is hedged if `ClusterOptions::hedge`
+   * is set.
+   * @throw std::exception if any error occurs, including a path that does
+   * not start with a CID */
+  void FilesGet(
+      /** [in] Path of the file, "/ipfs/<cid>/..." or "<cid>/...". */
+      const std::string& path,
+      /** [out] Contents of the file. */
+      std::iostream* response);
+
+  /** Get the number of nodes.
+   * @return the number of nodes */
+  size_t Size() const;
+
+  /** Get the state of the nodes.
+   * @return the state of each node, in the order of the constructor */
+  std::vector<ClusterNodeStatus> Status() const;
+
+  /** Get the counters of the hedged reads.
+   * @return the counters */
+  ClusterHedgeStatus HedgeStatus() const;
+
+ private:
+  /** A peer of the cluster. */
+  struct Node {
+    explicit Node(const Client& client) : prototype(client), probe(client) {}
+
+    /** Copied to make new clients of the pool. */
+    const Client prototype;
+
+    /** Client of the health probes. */
+    Client probe;
+
+    /** Clients not used by any request. */
+    std::vector<std::unique_ptr<Client>> idle;
+
+    std::atomic<bool> healthy{true};
+    std::atomic<size_t> outstanding{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> failures{0};
+
+    /** Number of consecutive failed probes. */
+    unsigned failed_probes = 0;
+  };
+
+  /** Pick the node to send a request to.
+   * @return the index of the node
+   * @throw std::runtime_error if no node is healthy */
+  size_t Pick();
+
+  /** Run a read request on the given nodes in turn, until one succeeds.
+   * Unhealthy nodes are skipped, and so are the remaining nodes if
+   * `may_retry` returns false after a failure. */
+  void CallFirst(const std::vector<size_t>& nodes,
+                 const std::function<void(Client*)>& request,
+                 const std::function<bool()>& may_retry);
+
+  /** Run a read request on `nodes[0]`, hedged on `nodes[1]`, or on another
+   * client of `nodes[0]` if there is a single node. */
+  void Hedge(const std::vector<size_t>& nodes,
+             const std::function<void(Client*, std::iostream*)>& request,
+             std::iostream* response);
+
+  /** Get the delay after which a read is hedged. */
+  std::chrono::microseconds HedgeDelay() const;
+
+  /** Record the time to first byte of a read. */
+  void RecordFirstByte(std::chrono::microseconds latency);
+
+  /** Run a request on a given node, with a client of its pool. */
+  void CallNode(size_t node, const std::function<void(Client*)>& request);
+
+  /** Take a client out of the pool of a node, or make a new one.
+   * @return the client */
+  std::unique_ptr<Client> Acquire(Node* node);
+
+  /** Put a client back in the pool of its node. */
+  void Release(Node* node, std::unique_ptr<Client> client);
+
+  /** Main loop of the probe thread. */
+  void Probe();
+
+  /** Probe a node and update its health. */
+  void ProbeNode(Node* node);
+
+  const ClusterOptions options_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+
+  /** Hash of the URL prefix of each node, for `Owners()`. */
+  std::vector<uint64_t> node_hashes_;
+
+  /** Protects the pools of the nodes and `random_`. */
+  std::mutex mutex_;
+  std::mt19937_64 random_;
+
+  /** Recent times to first byte, in microseconds, a ring buffer. */
+  mutable std::mutex latency_mutex_;
+  std::vector<int64_t> latencies_;
+  size_t next_latency_ = 0;
+
+  std::atomic<uint64_t> hedged_reads_{0};
+  std::atomic<uint64_t> hedges_{0};
+  std::atomic<uint64_t> hedge_wins_{0};
+
+  /** Set to stop the probe thread. */
+  bool stopping_ = false;
+  /** Cancels the probes in progress when stopping. */
+  const std::shared_ptr<http::CancellationToken> probe_token_ =
+      std::make_shared<http::CancellationToken>();
+  std::condition_variable stop_cv_;
+  std::thread prober_;
+};
+
+} /* namespace ipfs */
+
+#endif /* IPFS_CLUSTER_CLIENT_H */
@@ -0,0 +1,133 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_DAG_PB_H
+#define IPFS_DAG_PB_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace ipfs {
+
+/** Decoding of dag-pb blocks, as returned by `Client::BlockGet()`.
+ *
+ * The decoded structures do not own any memory: the strings in them are views
+ * inside the block that was decoded, so it must outlive them.
+ *
+ * @see https://ipld.io/specs/codecs/dag-pb/spec/ */
+namespace dagpb {
+
+/** A link from a dag-pb node to another block (PBLink). */
+struct Link {
+  /** Binary CID of the target block. Use `cid::ToString()` to get its text
+   * form. */
+  std::string_view hash;
+
+  /** Name of the link. Empty if the link has no name. */
+  std::string_view name;
+
+  /** Cumulative size of the target, or 0 if not present. */
+  uint64_t tsize = 0;
+};
+
+/** A dag-pb node (PBNode). */
+struct Node {
+  /** The links of the node, in the order in which they are stored. */
+  std::vector<Link> links;
+
+  /** Opaque payload of the node. For UnixFS nodes it is a serialized
+   * `unixfs::Data`. */
+  std::string_view data;
+};
+
+/** Decode a dag-pb block.
+ *
+ * @throw std::runtime_error if the block is malformed
+ *
+ * @since version 0.8.0 */
+void Decode(
+    /** [in] Raw contents of the block. */
+    std::string_view block,
+    /** [out] Decoded node, pointing inside `block`. */
+    Node* node);
+
+} /* namespace dagpb */
+
+/** Decoding of UnixFS metadata, stored in the data of dag-pb nodes.
+ *
+ * @see https://github.com/ipfs/specs/blob/main/UNIXFS.md */
+namespace unixfs {
+
+/** Type of a UnixFS node. */
+enum class DataType : uint8_t {
+  kRaw = 0,
+  kDirectory = 1,
+  kFile = 2,
+  kMetadata = 3,
+  kSymlink = 4,
+  kHAMTShard = 5,
+};
+
+/** UnixFS metadata of a node (Data). */
+struct Data {
+  /** Type of the node. */
+  DataType type = DataType::kRaw;
+
+  /** File contents stored in this node itself, if any. */
+  std::string_view data;
+
+  /** Total size of the file contents below this node. */
+  uint64_t filesize = 0;
+
+  /** Size of the file contents below each link of the node, in the same order
+   * as the links. */
+  std::vector<uint64_t> blocksizes;
+
+  /** Hash function used for the HAMT buckets of sharded directories. */
+  uint64_t hash_type = 0;
+
+  /** Fan-out of sharded directories. */
+  uint64_t fanout = 0;
+
+  /** Unix permission bits, if present. */
+  uint32_t mode = 0;
+
+  /** Modification time, seconds since the epoch, if present. */
+  int64_t mtime_seconds = 0;
+
+  /** Modification time, fractional nanoseconds, if present. */
+  uint32_t mtime_nanoseconds = 0;
+};
+
+/** Decode the UnixFS metadata stored in the data of a dag-pb node.
+ *
+ * @throw std::runtime_error if the data is malformed
+ *
+ * @since version 0.8.0 */
+void Decode(
+    /** [in] Data of a dag-pb node, `dagpb::Node::data`. */
+    std::string_view input,
+    /** [out] Decoded metadata, pointing inside `input`. */
+    Data* data);
+
+} /* namespace unixfs */
+} /* namespace ipfs */
+
+#endif /* IPFS_DAG_PB_H */
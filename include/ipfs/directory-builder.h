@@ -0,0 +1,182 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_DIRECTORY_BUILDER_H
+#define IPFS_DIRECTORY_BUILDER_H
+
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+#include <ipfs/file-hasher.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ipfs {
+
+/** Options to control a `DirectoryBuilder`. The defaults match those of
+ * `ipfs add` and of the daemon's MFS.
+ * @since version 0.8.0 */
+struct DirectoryBuilderOptions {
+  /** CID version of the directory blocks, 0 or 1. */
+  unsigned cid_version = 0;
+
+  /** Shard the directory into a HAMT once the sum, over its entries, of the
+   * length of the name plus the length of the binary CID reaches this many
+   * bytes. 0 never shards. */
+  size_t shard_threshold = 256 * 1024;
+
+  /** Number of buckets of each node of a sharded directory. A power of 2,
+   * at least 8. */
+  size_t fanout = 256;
+};
+
+/** Builds a UnixFS directory locally out of existing objects, so that it can
+ * be stored with a single request instead of one `ObjectPatchAddLink()`
+ * (and one intermediate object) per entry.
+ *
+ * The blocks are identical to those the daemon would build for the same
+ * entries: a single dag-pb node with the links sorted by name, or a HAMT
+ * sharded directory (murmur3 hashed names) for large directories.
+ *
+ * An example usage:
+ * @snippet test_directory_builder.cc ipfs::DirectoryBuilder
+ *
+ * @since version 0.8.0 */
+class DirectoryBuilder {
+ public:
+  /** Constructor.
+   * @throw std::invalid_argument if the options are inconsistent */
+  explicit DirectoryBuilder(
+      /** [in] Builder options. */
+      const DirectoryBuilderOptions& options = DirectoryBuilderOptions());
+
+  /** Add an entry to the directory.
+   * @throw std::invalid_argument if `name` is not a valid file name or is
+   * already in the directory */
+  void Add(
+      /** [in] Name of the entry, without any "/". */
+      const std::string& name,
+      /** [in] Id of the file or directory to link to. */
+      const Cid& cid,
+      /** [in] Cumulative size of the linked object: the size of its blocks
+       * and of all the blocks below it, as reported for example by
+       * `Client::FilesStat()` ("CumulativeSize") or in the links listed by
+       * `Client::ObjectLinks()` ("Size"). */
+      uint64_t size);
+
+  /** Get the number of entries in the directory.
+   * @return the number of entries */
+  size_t Size() const;
+
+  /** Build the blocks of the directory.
+   * @return the CID of the directory, for example "QmUNLLsP..."
+   * @throw std::runtime_error if a sharded directory has two names whose
+   * hashes collide completely */
+  std::string Build(
+      /** [in] Callback to receive the blocks of the directory, root last.
+       * May be empty. */
+      const BlockSink& sink = BlockSink()) const;
+
+  /** Build the directory and store its blocks with a single
+   * `Client::DagImport()` request. The linked objects must already be
+   * stored by the peer, or be fetchable by it.
+   * @return the CID of the directory
+   * @throw std::exception if any error occurs */
+  std::string Put(
+      /** [in,out] Client to use. */
+      Client* client,
+      /** [in] Pin the directory recursively. */
+      bool pin = false) const;
+
+ private:
+  /** An entry of the directory. */
+  struct Entry {
+    /** Binary CID of the linked object. */
+    std::string cid;
+
+    /** Cumulative size of the linked object. */
+    uint64_t size;
+  };
+
+  /** A built block, as seen from its parent. */
+  struct Child {
+    /** Binary CID of the block. */
+    std::string cid;
+
+    /** Size of the block plus the sizes of all its descendants. */
+    uint64_t tsize;
+  };
+
+  /** An entry of a sharded directory, with the hash of its name. */
+  struct HashedEntry {
+    /** Hash of the name, whose bits select the bucket at each level. */
+    uint64_t hash;
+
+    /** Name of the entry, a key of `entries_`. */
+    const std::string* name;
+
+    /** The entry, a value of `entries_`. */
+    const Entry* entry;
+  };
+
+  /** Build a basic (unsharded) directory node.
+   * @return the node */
+  Child BuildBasic(const BlockSink& sink) const;
+
+  /** Build a node of a sharded directory, and its descendants.
+   * @return the node */
+  Child BuildShard(
+      /** [in] Entries below the node, sorted by hash. */
+      const HashedEntry* begin, const HashedEntry* end,
+      /** [in] Depth of the node, 0 for the root. */
+      unsigned depth,
+      /** [in] Callback to receive the blocks. */
+      const BlockSink& sink) const;
+
+  /** Hash a dag-pb block and hand it to the sink.
+   * @return the block as a child of its parent */
+  Child Emit(
+      /** [in] Contents of the block. */
+      const std::string& block,
+      /** [in] Sum of the cumulative sizes of the links of the block. */
+      uint64_t links_tsize,
+      /** [in] Callback to receive the block. */
+      const BlockSink& sink) const;
+
+  DirectoryBuilderOptions options_;
+
+  /** Number of bits of the name hash used by each level of a sharded
+   * directory, log2(`fanout`). */
+  unsigned bits_per_level_ = 0;
+
+  /** The entries, sorted by name. */
+  std::map<std::string, Entry> entries_;
+
+  /** Sum of the lengths of the names and binary CIDs of the entries, which is
+   * how the daemon estimates the size of a directory node to decide when to
+   * shard it. */
+  size_t estimated_size_ = 0;
+};
+
+} /* namespace ipfs */
+
+#endif /* IPFS_DIRECTORY_BUILDER_H */
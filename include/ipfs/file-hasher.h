@@ -0,0 +1,153 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_FILE_HASHER_H
+#define IPFS_FILE_HASHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ipfs {
+
+/** Options to control a `FileHasher`. The defaults match those of
+ * `Client::FilesAdd()`.
+ * @since version 0.8.0 */
+struct FileHasherOptions {
+  /** Size of the chunks the file is split into ("size-262144" chunker). */
+  size_t chunk_size = 256 * 1024;
+
+  /** Maximum number of links of an internal node of the balanced tree. */
+  size_t max_links = 174;
+
+  /** CID version, 0 or 1. */
+  unsigned cid_version = 0;
+
+  /** Store the chunks as raw blocks rather than as UnixFS nodes. The daemon
+   * enables this by default together with CIDv1. Raw leaves always get a
+   * CIDv1, `cid_version` then only applies to the internal nodes. */
+  bool raw_leaves = false;
+};
+
+/** Callback that receives each block of a file as it is built, for example to
+ * write it to a CAR archive.
+ * @since version 0.8.0 */
+using BlockSink = std::function<void(
+    /** [in] Binary CID of the block. */
+    const std::string& cid,
+    /** [in] Contents of the block. */
+    const std::string& block)>;
+
+/** Computes the CID that the daemon would give to a file, without uploading
+ * it.
+ *
+ * The file is split into fixed-size chunks which are arranged in a balanced
+ * UnixFS tree, like `ipfs add` does with the default layout. Only the last
+ * chunk and one partially filled node per level of the tree are kept in
+ * memory, so files of any size can be hashed as they are read.
+ *
+ * An example usage:
+ * @snippet test_file_hasher.cc ipfs::FileHasher
+ *
+ * @since version 0.8.0 */
+class FileHasher {
+ public:
+  /** Constructor.
+   * @throw std::invalid_argument if the options are inconsistent */
+  explicit FileHasher(
+      /** [in] Hasher options. */
+      const FileHasherOptions& options = FileHasherOptions(),
+      /** [in] Callback to receive the blocks of the file, in the order in
+       * which they are built, root last. May be empty. */
+      const BlockSink& sink = BlockSink());
+
+  /** Hash the next bytes of the file. */
+  void Update(
+      /** [in] Bytes that follow the ones passed so far. */
+      std::string_view data);
+
+  /** Finish the file. The object must not be used afterwards.
+   * @return the CID of the file, for example "QmT78zSu..." */
+  std::string Finish();
+
+  /** Get the number of bytes of the file passed so far.
+   * @return the size in bytes */
+  uint64_t Size() const;
+
+  /** Compute the CID of a file held in memory.
+   * @return the CID of the file */
+  static std::string Hash(
+      /** [in] Contents of the file. */
+      std::string_view data,
+      /** [in] Hasher options. */
+      const FileHasherOptions& options = FileHasherOptions());
+
+ private:
+  /** A finished block, as seen from its parent. */
+  struct Child {
+    /** Binary CID of the block. */
+    std::string cid;
+
+    /** Size of the block plus the sizes of all its descendants. */
+    uint64_t tsize;
+
+    /** Number of bytes of the file under the block. */
+    uint64_t filesize;
+  };
+
+  /** Build a leaf out of `chunk_`, empty it and add the leaf to the lowest
+   * level. */
+  void AddLeaf();
+
+  /** Add a finished block to a level of the tree, building the parent node
+   * once the level is full. */
+  void AddChild(size_t level, Child&& child);
+
+  /** Build an internal node over the children of a level and empty it.
+   * @return the new node */
+  Child BuildNode(size_t level);
+
+  /** Hash a block, hand it to the sink and describe it.
+   * @return the block as a child of its parent */
+  Child Emit(uint64_t codec, std::string&& block, uint64_t tsize,
+             uint64_t filesize);
+
+  FileHasherOptions options_;
+  BlockSink sink_;
+
+  /** Bytes of the file that are not part of a leaf yet. */
+  std::string chunk_;
+
+  /** Total number of bytes passed so far. */
+  uint64_t size_ = 0;
+
+  /** Whether at least one leaf has been built. */
+  bool have_leaves_ = false;
+
+  /** Finished blocks waiting for their parent, per level. Level 0 holds the
+   * leaves. */
+  std::vector<std::vector<Child>> levels_;
+};
+
+} /* namespace ipfs */
+
+#endif /* IPFS_FILE_HASHER_H */
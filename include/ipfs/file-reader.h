@@ -0,0 +1,205 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_FILE_READER_H
+#define IPFS_FILE_READER_H
+
+#include <ipfs/client.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ipfs {
+
+/** Options to control a `FileReader`.
+ * @since version 0.8.0 */
+struct FileReaderOptions {
+  /** Number of upcoming blocks to prefetch concurrently while the file is
+   * being read sequentially. 0 disables the readahead. */
+  size_t readahead = 4;
+
+  /** Maximum number of internal (non-leaf) nodes of the file to keep in
+   * memory. */
+  size_t cache_size = 256;
+};
+
+/** Random-access reader of a UnixFS file.
+ *
+ * The file's block tree is resolved lazily using `Client::BlockGet()`: only
+ * the blocks on the path to the requested range are fetched. Internal nodes
+ * are cached, so subsequent reads usually cost a single leaf fetch, and
+ * sequential reads prefetch the following blocks in the background.
+ *
+ * Objects of this class are not thread-safe.
+ *
+ * An example usage:
+ * @snippet test_file_reader.cc ipfs::FileReader
+ *
+ * @since version 0.8.0 */
+class FileReader {
+ public:
+  /** Constructor. Fetches the root block of the file.
+   *
+   * @throw std::exception if any error occurs, or if `cid` is not a file */
+  FileReader(
+      /** [in] Client to copy. The reader uses its own copies, so `client` may
+       * be destroyed or used concurrently afterwards. */
+      const Client& client,
+      /** [in] Id of the file (multihash). */
+      const std::string& cid,
+      /** [in] Reader options. */
+      const FileReaderOptions& options = FileReaderOptions());
+
+  /** Destructor. Waits for the prefetches in progress to complete. */
+  ~FileReader();
+
+  FileReader(const FileReader&) = delete;
+  FileReader& operator=(const FileReader&) = delete;
+
+  /** Get the size of the file.
+   * @return the size in bytes */
+  uint64_t Size() const;
+
+  /** Read a range of the file. Does not change the current position.
+   *
+   * @throw std::exception if any error occurs */
+  void Read(
+      /** [in] Offset in the file to read from. */
+      uint64_t offset,
+      /** [in] Number of bytes to read. Less are read if the end of the file
+       * is reached. */
+      size_t length,
+      /** [out] The bytes that were read. */
+      std::string* data);
+
+  /** Read from the current position and advance it past the bytes read.
+   *
+   * @throw std::exception if any error occurs */
+  void Read(
+      /** [in] Number of bytes to read. Less are read if the end of the file
+       * is reached. */
+      size_t length,
+      /** [out] The bytes that were read. */
+      std::string* data);
+
+  /** Set the current position. It may be past the end of the file, in which
+   * case subsequent reads return no data. */
+  void Seek(
+      /** [in] New position, offset from the start of the file. */
+      uint64_t offset);
+
+  /** Get the current position.
+   * @return offset from the start of the file */
+  uint64_t Tell() const;
+
+ private:
+  /** A fetched block, decoded if it is a dag-pb one. */
+  struct Node;
+
+  /** Background fetcher of upcoming blocks. */
+  class Prefetcher;
+
+  /** A cached internal node. */
+  struct CacheEntry {
+    /** The node itself. */
+    std::shared_ptr<const Node> node;
+
+    /** Position of the node in `lru_`. */
+    std::list<std::string>::iterator lru;
+  };
+
+  /** A step on the path from the root to the current leaf. */
+  struct PathEntry {
+    /** Internal node. */
+    std::shared_ptr<const Node> node;
+
+    /** Index of the link that was followed. */
+    size_t index;
+  };
+
+  /** Make `leaf_` contain the byte at `offset` of the file. If that requires
+   * moving to another leaf and the file is being read sequentially, the
+   * blocks after the new leaf are queued for prefetching. */
+  void Locate(
+      /** [in] Offset in the file, less than `size_`. */
+      uint64_t offset);
+
+  /** Get a node, either from the cache or by fetching and decoding it.
+   * @return the node */
+  std::shared_ptr<const Node> GetNode(
+      /** [in] Binary CID of the node. */
+      const std::string& cid);
+
+  /** Queue the blocks that follow the current leaf for prefetching. */
+  void ScheduleReadahead();
+
+  /** Client used for the synchronous fetches. */
+  Client client_;
+
+  /** Reader options. */
+  FileReaderOptions options_;
+
+  /** Binary CID of the file. */
+  std::string root_;
+
+  /** Size of the file. */
+  uint64_t size_ = 0;
+
+  /** Current position, see `Seek()`. */
+  uint64_t position_ = 0;
+
+  /** Offset right after the last read, to detect sequential reads. */
+  uint64_t next_offset_ = 0;
+
+  /** Whether the read in progress continues the previous one. */
+  bool sequential_ = false;
+
+  /** Root node of the file, never evicted. */
+  std::shared_ptr<const Node> root_node_;
+
+  /** Cache of internal nodes, keyed by binary CID. */
+  std::unordered_map<std::string, CacheEntry> cache_;
+
+  /** Keys of `cache_`, least recently used last. */
+  std::list<std::string> lru_;
+
+  /** Path from the root to the current leaf. */
+  std::vector<PathEntry> path_;
+
+  /** Node holding the contents of the current leaf. */
+  std::shared_ptr<const Node> leaf_node_;
+
+  /** Contents of the current leaf, inside `leaf_node_`. */
+  std::string_view leaf_;
+
+  /** Offset of the current leaf in the file. */
+  uint64_t leaf_offset_ = 0;
+
+  /** Fetcher of upcoming blocks, if readahead is enabled. */
+  std::unique_ptr<Prefetcher> prefetcher_;
+};
+
+} /* namespace ipfs */
+
+#endif /* IPFS_FILE_READER_H */
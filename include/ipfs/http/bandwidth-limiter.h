@@ -0,0 +1,143 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_HTTP_BANDWIDTH_LIMITER_H
+#define IPFS_HTTP_BANDWIDTH_LIMITER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ipfs {
+
+namespace http {
+
+/** Bandwidth limits, in bytes per second. 0 means no limit.
+ * @since version 0.8.0 */
+struct BandwidthLimits {
+  /** Limit of the uploads, i.e. of the request bodies. */
+  uint64_t send_bytes_per_second = 0;
+
+  /** Limit of the downloads, i.e. of the response bodies. */
+  uint64_t recv_bytes_per_second = 0;
+};
+
+/** Caps the bandwidth of the transfers that use it, split evenly between
+ * the transfers in progress: the send limit between those that send a
+ * body, the receive limit between all of them. The limits may be changed
+ * at any time; the transfers in progress follow within a few tens of
+ * milliseconds. libcurl enforces them over a few seconds, so that the
+ * first megabyte or so of a transfer may arrive at full speed.
+ *
+ * Limiters form a tree: a transfer is also bound by the limiters above the
+ * one it uses. By default, every limiter is under `Global()`, which all the
+ * transfers go through, so that a cap of the whole process may be set there
+ * and a cap of each client (see `Client::SetBandwidthLimiter()`) below it.
+ *
+ * Thread-safe.
+ *
+ * @since version 0.8.0 */
+class BandwidthLimiter {
+ public:
+  /** A transfer in progress, which ends when the object is destroyed. */
+  class Transfer {
+   public:
+    /** Constructor of an empty transfer. */
+    Transfer() = default;
+
+    Transfer(Transfer&& other) noexcept;
+    Transfer& operator=(Transfer&& other) noexcept;
+    Transfer(const Transfer&) = delete;
+    Transfer& operator=(const Transfer&) = delete;
+
+    /** Destructor, which ends the transfer. */
+    ~Transfer();
+
+    /** Get the bandwidth currently allowed to the transfer.
+     * @return the share of the transfer in each limiter above it, the
+     * smallest one, or no limits for an empty transfer */
+    BandwidthLimits Share() const;
+
+   private:
+    friend class BandwidthLimiter;
+    Transfer(BandwidthLimiter* limiter, bool sends)
+        : limiter_(limiter), sends_(sends) {}
+
+    BandwidthLimiter* limiter_ = nullptr;
+    bool sends_ = false;
+  };
+
+  /** Constructor. */
+  explicit BandwidthLimiter(
+      /** [in] The limits. */
+      const BandwidthLimits& limits = BandwidthLimits(),
+      /** [in] Limiter above this one, or null for none. */
+      std::shared_ptr<BandwidthLimiter> parent = Global());
+
+  BandwidthLimiter(const BandwidthLimiter&) = delete;
+  BandwidthLimiter& operator=(const BandwidthLimiter&) = delete;
+
+  /** Get the limiter of the whole process, with no limits unless set.
+   * Transports that are not given a limiter use it directly.
+   * @return the process-wide limiter */
+  static std::shared_ptr<BandwidthLimiter> Global();
+
+  /** Change the limits. */
+  void SetLimits(
+      /** [in] The new limits. */
+      const BandwidthLimits& limits);
+
+  /** Get the limits.
+   * @return the limits of this limiter alone */
+  BandwidthLimits Limits() const;
+
+  /** Start a transfer, in this limiter and those above it.
+   * @return the transfer, to keep while it is in progress */
+  Transfer Start(
+      /** [in] Whether the transfer sends a body, and so takes a share of
+       * the send limit. */
+      bool sends);
+
+  /** Get the number of transfers in progress.
+   * @return the number of transfers of this limiter and those below it */
+  size_t Transfers() const;
+
+  /** Get the number of transfers in progress that send a body.
+   * @return the number of such transfers of this limiter and those below
+   * it */
+  size_t Sending() const;
+
+ private:
+  /** End a transfer. */
+  void Release(
+      /** [in] Whether the transfer sends a body. */
+      bool sends);
+
+  std::atomic<uint64_t> send_bytes_per_second_;
+  std::atomic<uint64_t> recv_bytes_per_second_;
+  std::atomic<size_t> transfers_{0};
+  std::atomic<size_t> sending_{0};
+  const std::shared_ptr<BandwidthLimiter> parent_;
+};
+
+} /* namespace http */
+} /* namespace ipfs */
+
+#endif /* IPFS_HTTP_BANDWIDTH_LIMITER_H */
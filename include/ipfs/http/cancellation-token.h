@@ -0,0 +1,111 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_HTTP_CANCELLATION_TOKEN_H
+#define IPFS_HTTP_CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace ipfs {
+
+namespace http {
+
+/** Error thrown by a request whose cancellation token was cancelled.
+ * @since version 0.8.0 */
+class CancelledError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+/** Cancels the requests it is given to, and only them, see
+ * `Client::CancelScope`. Once cancelled, a token stays so: use a new one for
+ * the next requests.
+ *
+ * Thread-safe.
+ *
+ * @since version 0.8.0 */
+class CancellationToken {
+ public:
+  /** Callback of a token, called when it is cancelled, until the object is
+   * destroyed. */
+  class Registration {
+   public:
+    /** Constructor of an empty registration. */
+    Registration() = default;
+
+    Registration(Registration&& other) noexcept;
+    Registration& operator=(Registration&& other) noexcept;
+    Registration(const Registration&) = delete;
+    Registration& operator=(const Registration&) = delete;
+
+    /** Destructor, which removes the callback. Once it returns, the callback
+     * is not running and will not be called anymore. */
+    ~Registration();
+
+   private:
+    friend class CancellationToken;
+    Registration(CancellationToken* token, uint64_t id)
+        : token_(token), id_(id) {}
+
+    CancellationToken* token_ = nullptr;
+    uint64_t id_ = 0;
+  };
+
+  /** Constructor of a token that is not cancelled. */
+  CancellationToken() = default;
+
+  CancellationToken(const CancellationToken&) = delete;
+  CancellationToken& operator=(const CancellationToken&) = delete;
+
+  /** Cancel the requests given the token, including those to come. The
+   * requests in progress stop at once and throw `CancelledError`. */
+  void Cancel();
+
+  /** Check whether the token was cancelled.
+   * @return true if `Cancel()` was called */
+  bool IsCancelled() const;
+
+  /** Have a function called when the token is cancelled, at once if it
+   * already is. The function must be quick and must not use the token.
+   * @return the registration, to keep while the function may be called */
+  Registration Register(
+      /** [in] The function. */
+      std::function<void()> callback);
+
+ private:
+  /** Remove a callback. */
+  void Unregister(uint64_t id);
+
+  std::atomic<bool> cancelled_{false};
+
+  /** Protects `callbacks_` and the calls of the callbacks. */
+  std::mutex mutex_;
+  std::map<uint64_t, std::function<void()>> callbacks_;
+  uint64_t next_id_ = 1;
+};
+
+} /* namespace http */
+} /* namespace ipfs */
+
+#endif /* IPFS_HTTP_CANCELLATION_TOKEN_H */
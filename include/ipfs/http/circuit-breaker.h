@@ -0,0 +1,185 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_HTTP_CIRCUIT_BREAKER_H
+#define IPFS_HTTP_CIRCUIT_BREAKER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ipfs {
+
+namespace http {
+
+/** Options of a `CircuitBreaker`.
+ * @since version 0.8.0 */
+struct CircuitBreakerOptions {
+  /** Number of latest calls the failure rate is computed over. */
+  size_t window = 20;
+
+  /** Number of calls needed in the window before the breaker may open. */
+  size_t minimum_calls = 10;
+
+  /** Fraction of failed calls in the window, between 0 and 1, from which the
+   * breaker opens. */
+  double failure_rate = 0.5;
+
+  /** Time to the first byte of the response above which a call counts as
+   * failed, as the peer is then too overloaded to be useful. 0 disables it.
+   * The transports count from the end of the upload of the request body,
+   * and only check read requests: DHT, pin and write requests are slow by
+   * nature. */
+  std::chrono::milliseconds slow_call{5000};
+
+  /** How long the breaker stays open before letting trial calls through. */
+  std::chrono::milliseconds open_duration{5000};
+
+  /** Number of trial calls let through when half-open. The breaker closes
+   * once they all succeed, and opens again as soon as one fails. */
+  unsigned half_open_calls = 1;
+
+  /** HTTP statuses that count as failures, besides broken or timed out
+   * connections. The daemon reports most errors, including permanent ones
+   * like "not found", with status 500: it is thus up and answering. */
+  std::vector<long> failure_statuses{429, 502, 503, 504};
+};
+
+/** Error thrown instead of sending a request while the circuit breaker of
+ * its peer is open.
+ * @since version 0.8.0 */
+class CircuitOpenError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+/** Circuit breaker of a peer: stops sending requests to a peer that fails
+ * or is too slow, so that the callers fail fast instead of all waiting for
+ * it, then tries it again after a while.
+ *
+ * It is closed (requests go through) until the failure rate of the latest
+ * calls reaches `CircuitBreakerOptions::failure_rate`. It is then open
+ * (requests fail with `CircuitOpenError`) for
+ * `CircuitBreakerOptions::open_duration`, then half-open: a few trial calls
+ * go through and decide whether it closes or opens again.
+ *
+ * Thread-safe.
+ *
+ * @since version 0.8.0 */
+class CircuitBreaker {
+ public:
+  /** State of a breaker. */
+  enum class State {
+    /** Requests go through. */
+    kClosed,
+    /** Requests fail with `CircuitOpenError`. */
+    kOpen,
+    /** Trial requests go through, the others fail. */
+    kHalfOpen,
+  };
+
+  /** Outcome of a call, see `Record()`. */
+  enum class Outcome {
+    /** The peer answered in time. */
+    kSuccess,
+    /** The peer failed or was too slow. */
+    kFailure,
+    /** Nothing is known of the peer, for example the call was aborted. */
+    kUnknown,
+  };
+
+  /** Constructor.
+   * @throw std::invalid_argument if the options are out of range */
+  explicit CircuitBreaker(
+      /** [in] Options of the breaker. */
+      const CircuitBreakerOptions& options = CircuitBreakerOptions());
+
+  /** Get the breaker shared by all the users of a peer, creating it if
+   * needed.
+   * @return the breaker of `url_prefix`, which has the options given by the
+   * first caller that created it */
+  static std::shared_ptr<CircuitBreaker> Shared(
+      /** [in] Address of the peer's API, see `Client::UrlPrefix()`. */
+      const std::string& url_prefix,
+      /** [in] Options, if the breaker has to be created. */
+      const CircuitBreakerOptions& options = CircuitBreakerOptions());
+
+  /** Ask to send a call. Each admitted call must be followed by a `Record()`.
+   * @return whether the call is a trial call of the half-open state
+   * @throw CircuitOpenError if the breaker is open */
+  bool Admit();
+
+  /** Record the outcome of an admitted call. */
+  void Record(
+      /** [in] What `Admit()` returned for the call. */
+      bool trial,
+      /** [in] Outcome of the call. */
+      Outcome outcome,
+      /** [in] Time to the first byte of the response, checked against
+       * `CircuitBreakerOptions::slow_call` for successful calls. */
+      std::chrono::microseconds first_byte);
+
+  /** Check whether an HTTP status counts as a failure.
+   * @return true if it is one of `CircuitBreakerOptions::failure_statuses` */
+  bool IsFailureStatus(
+      /** [in] The HTTP status. */
+      long status) const;
+
+  /** Get the current state.
+   * @return the state */
+  State GetState() const;
+
+  /** Get the number of calls refused so far.
+   * @return the number of `Admit()` calls that threw */
+  uint64_t Rejected() const;
+
+ private:
+  /** Open the breaker. */
+  void Open(std::chrono::steady_clock::time_point now);
+
+  const CircuitBreakerOptions options_;
+
+  mutable std::mutex mutex_;
+  State state_ = State::kClosed;
+
+  /** Outcomes of the latest calls while closed (true for failures), a ring
+   * buffer. */
+  std::vector<bool> window_;
+  size_t next_ = 0;
+  size_t failures_ = 0;
+
+  /** When the breaker opened. */
+  std::chrono::steady_clock::time_point opened_at_;
+
+  /** Trial calls admitted and succeeded in the half-open state. */
+  unsigned trials_ = 0;
+  unsigned trial_successes_ = 0;
+
+  uint64_t rejected_ = 0;
+};
+
+} /* namespace http */
+} /* namespace ipfs */
+
+#endif /* IPFS_HTTP_CIRCUIT_BREAKER_H */
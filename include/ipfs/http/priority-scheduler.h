@@ -0,0 +1,223 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_HTTP_PRIORITY_SCHEDULER_H
+#define IPFS_HTTP_PRIORITY_SCHEDULER_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+
+namespace ipfs {
+
+namespace http {
+
+/** Priority of the requests of a client.
+ * @since version 0.8.0 */
+enum class Priority {
+  /** Requests a user waits for. */
+  kInteractive,
+  /** Default priority. */
+  kNormal,
+  /** Background jobs, like replication or large uploads. */
+  kBulk,
+};
+
+/** Options of a `PriorityScheduler`.
+ * @since version 0.8.0 */
+struct PrioritySchedulerOptions {
+  /** Number of transfers that run at once, paused ones excluded. */
+  size_t slots = 4;
+
+  /** Share of the slots each priority gets when all of them wait, in the
+   * order of `Priority`. */
+  std::array<unsigned, 3> weights{8, 4, 1};
+
+  /** Whether to pause running transfers while requests of a higher priority
+   * wait for a slot. */
+  bool pause_lower = true;
+
+  /** Longest a transfer stays paused. It then resumes and is not paused
+   * again for as long, so that it does not stall forever or time out. */
+  std::chrono::milliseconds max_pause{5000};
+};
+
+/** State of one priority of a `PriorityScheduler`.
+ * @since version 0.8.0 */
+struct PrioritySchedulerStats {
+  /** Number of requests waiting for a slot. */
+  size_t queued = 0;
+
+  /** Number of transfers running. */
+  size_t running = 0;
+
+  /** Number of transfers paused. */
+  size_t paused = 0;
+
+  /** Number of requests given a slot so far. */
+  uint64_t admitted = 0;
+
+  /** Number of times transfers were paused so far. */
+  uint64_t pauses = 0;
+
+  /** Time the admitted requests spent waiting, in total. */
+  std::chrono::microseconds total_wait{0};
+};
+
+/** Schedules the transfers of several clients that share a peer, so that
+ * bulk traffic does not delay interactive requests.
+ *
+ * At most `PrioritySchedulerOptions::slots` transfers run at once. Requests
+ * wait for a slot in one queue per priority, and the queues are served by
+ * weighted fair queueing (stride scheduling): when all priorities wait, each
+ * gets slots in proportion to its weight, and a priority that waited for
+ * nothing gets no credit for it. On top of that, while a request waits for a
+ * slot, the running transfers of lower priorities are paused, which frees
+ * their slots and their bandwidth, until the higher priority requests are
+ * over.
+ *
+ * Thread-safe.
+ *
+ * @since version 0.8.0 */
+class PriorityScheduler {
+ private:
+  struct Entry;
+
+ public:
+  /** Slot of a transfer, given back when the object is destroyed. */
+  class Ticket {
+   public:
+    /** Constructor of an empty ticket. */
+    Ticket() = default;
+
+    Ticket(Ticket&& other) noexcept = default;
+    Ticket& operator=(Ticket&& other) noexcept;
+    Ticket(const Ticket&) = delete;
+    Ticket& operator=(const Ticket&) = delete;
+
+    /** Destructor, which ends the transfer. */
+    ~Ticket();
+
+    /** Check whether a slot was given.
+     * @return false if the ticket is empty */
+    explicit operator bool() const { return entry_ != nullptr; }
+
+   private:
+    friend class PriorityScheduler;
+    Ticket(PriorityScheduler* scheduler, std::shared_ptr<Entry> entry)
+        : scheduler_(scheduler), entry_(std::move(entry)) {}
+
+    PriorityScheduler* scheduler_ = nullptr;
+    std::shared_ptr<Entry> entry_;
+  };
+
+  /** Constructor.
+   * @throw std::invalid_argument if there are no slots or a weight is 0 */
+  explicit PriorityScheduler(
+      /** [in] Options of the scheduler. */
+      const PrioritySchedulerOptions& options = PrioritySchedulerOptions());
+
+  PriorityScheduler(const PriorityScheduler&) = delete;
+  PriorityScheduler& operator=(const PriorityScheduler&) = delete;
+
+  /** Wait for a slot.
+   * @return the ticket, to keep while the transfer runs, or an empty ticket
+   * if `keep_waiting` returned false */
+  Ticket Acquire(
+      /** [in] Priority of the request. */
+      Priority priority,
+      /** [in] Called to interrupt `ShouldPause()` callers of the transfer,
+       * so that they see a pause request at once. Must be thread-safe. */
+      std::function<void()> wake = {},
+      /** [in] Checked while waiting, every few milliseconds. */
+      const std::function<bool()>& keep_waiting = {});
+
+  /** Check whether a running transfer should be paused or resumed, to be
+   * called regularly while it runs.
+   * @return true if it should be paused now */
+  bool ShouldPause(
+      /** [in,out] Ticket of the transfer. */
+      Ticket* ticket);
+
+  /** Get the state of a priority.
+   * @return the state */
+  PrioritySchedulerStats Stats(
+      /** [in] The priority. */
+      Priority priority) const;
+
+ private:
+  /** A transfer waiting or running. */
+  struct Entry {
+    Priority priority;
+    std::function<void()> wake;
+    bool paused = false;
+    std::chrono::steady_clock::time_point paused_at;
+    /** The transfer is not paused before this time. */
+    std::chrono::steady_clock::time_point exempt_until;
+  };
+
+  /** State of a priority. */
+  struct Queue {
+    /** Waiting entries, in order of arrival. */
+    std::deque<Entry*> waiting;
+
+    /** Virtual time of the next slot of this priority. */
+    double pass = 0;
+
+    PrioritySchedulerStats stats;
+  };
+
+  /** Check whether a priority higher than `priority` waits.
+   * @return true if one does */
+  bool HigherWaiting(Priority priority) const;
+
+  /** Get the priority whose turn it is among those that wait.
+   * @return its index */
+  size_t NextQueue() const;
+
+  /** End a transfer. */
+  void Release(const std::shared_ptr<Entry>& entry);
+
+  const PrioritySchedulerOptions options_;
+  std::array<Queue, 3> queues_;
+
+  /** Transfers running or paused. */
+  std::list<std::shared_ptr<Entry>> running_;
+
+  /** Number of transfers running and not paused. */
+  size_t active_ = 0;
+
+  /** Virtual time of the last slot given. */
+  double virtual_time_ = 0;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+} /* namespace http */
+} /* namespace ipfs */
+
+#endif /* IPFS_HTTP_PRIORITY_SCHEDULER_H */
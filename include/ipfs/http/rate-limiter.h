@@ -0,0 +1,221 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_HTTP_RATE_LIMITER_H
+#define IPFS_HTTP_RATE_LIMITER_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+
+namespace ipfs {
+
+namespace http {
+
+/** Class of a request, which decides the limits that apply to it.
+ * @since version 0.8.0 */
+enum class RequestClass {
+  /** Requests that only read, like "cat" or "block/get". */
+  kRead,
+  /** Requests that store or change data, like "add" or "files/write". */
+  kWrite,
+  /** Requests that go through the DHT, like "dht/findprovs" or IPNS. */
+  kDht,
+  /** Pinning requests, like "pin/add". */
+  kPin,
+};
+
+/** Limits of one class of requests.
+ * @since version 0.8.0 */
+struct RateLimit {
+  /** Average number of requests started per second. 0 means no limit. */
+  double requests_per_second = 0;
+
+  /** Number of requests that may start at once after a quiet period. */
+  double burst = 1;
+
+  /** Maximum number of requests in progress. 0 means no limit. */
+  size_t max_in_flight = 0;
+
+  /** Maximum number of requests waiting for their turn. Requests beyond it
+   * are rejected. 0 rejects every request that cannot start at once. */
+  size_t max_queued = std::numeric_limits<size_t>::max();
+
+  /** Maximum time a request waits for its turn before it is rejected. 0
+   * means no limit. */
+  std::chrono::milliseconds max_wait{0};
+};
+
+/** Options of a `RateLimiter`: the limits of each class of requests.
+ * @since version 0.8.0 */
+struct RateLimiterOptions {
+  /** Limits of `RequestClass::kRead`. */
+  RateLimit reads;
+
+  /** Limits of `RequestClass::kWrite`. */
+  RateLimit writes;
+
+  /** Limits of `RequestClass::kDht`. */
+  RateLimit dht;
+
+  /** Limits of `RequestClass::kPin`. */
+  RateLimit pins;
+};
+
+/** State of one class of requests of a `RateLimiter`.
+ * @since version 0.8.0 */
+struct RateLimiterStats {
+  /** Number of requests waiting for their turn. */
+  size_t queued = 0;
+
+  /** Number of requests in progress. */
+  size_t in_flight = 0;
+
+  /** Number of requests let through so far. */
+  uint64_t admitted = 0;
+
+  /** Number of requests rejected so far. */
+  uint64_t rejected = 0;
+
+  /** Time the admitted requests spent waiting, in total. */
+  std::chrono::microseconds total_wait{0};
+
+  /** Longest time an admitted request spent waiting. */
+  std::chrono::microseconds max_wait{0};
+};
+
+/** Error thrown instead of sending a request that a `RateLimiter` rejected.
+ * @since version 0.8.0 */
+class RateLimitError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+/** Limits the rate and the concurrency of the requests sent to a peer, per
+ * class of requests, so that bulk jobs do not saturate it. Requests beyond
+ * the limits wait for their turn, in order, or are rejected.
+ *
+ * A limiter may be shared by several clients, see
+ * `Client::SetRateLimiter()`, to limit them together.
+ *
+ * Thread-safe.
+ *
+ * @since version 0.8.0 */
+class RateLimiter {
+ public:
+  /** Permission to send a request, which ends when the object is destroyed.
+   */
+  class Permit {
+   public:
+    /** Constructor of an empty permit. */
+    Permit() = default;
+
+    Permit(Permit&& other) noexcept;
+    Permit& operator=(Permit&& other) noexcept;
+    Permit(const Permit&) = delete;
+    Permit& operator=(const Permit&) = delete;
+
+    /** Destructor, which ends the request. */
+    ~Permit();
+
+    /** Check whether the permit was granted.
+     * @return false if the permit is empty */
+    explicit operator bool() const { return limiter_ != nullptr; }
+
+   private:
+    friend class RateLimiter;
+    Permit(RateLimiter* limiter, RequestClass request_class)
+        : limiter_(limiter), class_(request_class) {}
+
+    RateLimiter* limiter_ = nullptr;
+    RequestClass class_ = RequestClass::kRead;
+  };
+
+  /** Constructor.
+   * @throw std::invalid_argument if a limit is negative or a burst is below
+   * 1 */
+  explicit RateLimiter(
+      /** [in] Limits of each class of requests. */
+      const RateLimiterOptions& options = RateLimiterOptions());
+
+  RateLimiter(const RateLimiter&) = delete;
+  RateLimiter& operator=(const RateLimiter&) = delete;
+
+  /** Get the class of a request from its URL: the command that follows
+   * "/api/v0/" in its path.
+   * @return the class, `RequestClass::kRead` for unknown commands */
+  static RequestClass Classify(
+      /** [in] URL of the request. */
+      std::string_view url);
+
+  /** Wait for the turn of a request.
+   * @return the permit, to keep while the request is in progress, or an
+   * empty permit if `keep_waiting` returned false
+   * @throw RateLimitError if the request is rejected */
+  Permit Acquire(
+      /** [in] Class of the request. */
+      RequestClass request_class,
+      /** [in] Checked while waiting, every few milliseconds. */
+      const std::function<bool()>& keep_waiting = {});
+
+  /** Get the state of a class of requests.
+   * @return the state */
+  RateLimiterStats Stats(
+      /** [in] The class of requests. */
+      RequestClass request_class) const;
+
+ private:
+  /** State of a class of requests. */
+  struct Bucket {
+    RateLimit limit;
+
+    /** Tokens available, each one lets a request start. */
+    double tokens = 0;
+
+    /** When `tokens` was last refilled. */
+    std::chrono::steady_clock::time_point refilled;
+
+    /** Tickets of the waiting requests, in order of arrival. */
+    std::deque<uint64_t> queue;
+
+    RateLimiterStats stats;
+  };
+
+  /** End a request. */
+  void Release(RequestClass request_class);
+
+  std::array<Bucket, 4> buckets_;
+  uint64_t next_ticket_ = 0;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+} /* namespace http */
+} /* namespace ipfs */
+
+#endif /* IPFS_HTTP_RATE_LIMITER_H */
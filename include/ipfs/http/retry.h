@@ -0,0 +1,152 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_HTTP_RETRY_H
+#define IPFS_HTTP_RETRY_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ipfs {
+
+namespace http {
+
+/** Cap on the number of retries, as a fraction of the number of requests,
+ * shared by all the transports that use it.
+ *
+ * It is a bucket of tokens: each request adds `ratio` tokens and each retry
+ * takes one, so that retries stop when the peer fails for many requests in a
+ * row rather than multiply its load. The bucket starts full and holds at
+ * most `reserve` tokens, which allows a few retries after a quiet period.
+ *
+ * Thread-safe.
+ *
+ * @since version 0.8.0 */
+class RetryBudget {
+ public:
+  /** Constructor.
+   * @throw std::invalid_argument if `ratio` is negative */
+  explicit RetryBudget(
+      /** [in] Number of retries allowed per request, on average. */
+      double ratio = 0.1,
+      /** [in] Maximum number of retries allowed in a burst. */
+      unsigned reserve = 10);
+
+  /** Get the budget shared by all the transports that are not given one.
+   * @return the process-wide budget */
+  static std::shared_ptr<RetryBudget> Global();
+
+  /** Record a request. */
+  void Deposit();
+
+  /** Take a retry from the budget.
+   * @return false if the budget is exhausted */
+  bool Withdraw();
+
+  /** Get the number of retries currently allowed.
+   * @return the number of tokens in the bucket */
+  double Balance() const;
+
+  /** Get the number of retries taken so far.
+   * @return the number of successful `Withdraw()` calls */
+  uint64_t Retries() const;
+
+  /** Get the number of retries refused so far.
+   * @return the number of failed `Withdraw()` calls */
+  uint64_t Refused() const;
+
+ private:
+  const double ratio_;
+  const double reserve_;
+
+  mutable std::mutex mutex_;
+  double balance_;
+  uint64_t retries_ = 0;
+  uint64_t refused_ = 0;
+};
+
+/** When and how a transport retries a failed request.
+ *
+ * A request is retried when:
+ * - its body can be sent again, i.e. it has no `FileUpload::Type::kStream`
+ *   part and it is not a `Transport::FetchStreamingBody()` request;
+ * - nothing was written to its response yet;
+ * - it failed to connect, which means that the peer never saw it, or its
+ *   command is idempotent and it failed with a status of `retry_statuses`,
+ *   or with a broken or timed out connection;
+ * - the retry budget allows it.
+ *
+ * The delay before a retry is drawn uniformly between 0 and
+ * `min(max_backoff, base_backoff * 2^(retry - 1))` ("full jitter"), so that
+ * the clients that failed together do not retry together.
+ *
+ * @since version 0.8.0 */
+struct RetryPolicy {
+  /** Maximum number of attempts of a request, including the first one. 1
+   * disables the retries. */
+  unsigned max_attempts = 3;
+
+  /** Upper bound of the delay before the first retry, doubled for each
+   * subsequent retry. */
+  std::chrono::milliseconds base_backoff{50};
+
+  /** Upper bound of the delay before any retry. */
+  std::chrono::milliseconds max_backoff{2000};
+
+  /** HTTP statuses after which an idempotent request is retried. The daemon
+   * reports most errors, including permanent ones like "not found", with
+   * status 500, which is thus not retried by default. */
+  std::vector<long> retry_statuses{429, 502, 503, 504};
+
+  /** Commands (API paths like "block/get") that can be sent again without
+   * changing their effect. A URL matches a command if its path ends with "/"
+   * followed by the command. */
+  std::vector<std::string> idempotent_commands{
+      "block/get", "block/put", "block/stat", "cat", "config/show",
+      "dag/export", "dag/get", "dht/findpeer", "dht/findprovs", "file/ls",
+      "files/ls", "files/read", "files/stat", "get", "id", "key/list", "ls",
+      "name/resolve", "object/data", "object/get", "object/links",
+      "object/stat", "pin/add", "pin/ls", "refs", "refs/local", "stats/bw",
+      "swarm/addrs", "swarm/peers", "version"};
+
+  /** Budget the retries are taken from, `RetryBudget::Global()` if null. */
+  std::shared_ptr<RetryBudget> budget;
+
+  /** Check whether a URL is of an idempotent command.
+   * @return true if the path of `url` matches one of `idempotent_commands` */
+  bool IsIdempotent(
+      /** [in] URL of the request. */
+      std::string_view url) const;
+
+  /** Draw the delay before a retry.
+   * @return the delay */
+  std::chrono::milliseconds Backoff(
+      /** [in] Number of the retry, 1 for the first one. */
+      unsigned retry) const;
+};
+
+} /* namespace http */
+} /* namespace ipfs */
+
+#endif /* IPFS_HTTP_RETRY_H */
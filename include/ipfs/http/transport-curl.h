@@ -24,7 +24,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 #include <ipfs/http/transport.h>
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -86,6 +89,66 @@ class TransportCurl : public Transport {
       /** [out] Output to save the response body to. */
       std::iostream* response) override;
 
+  /** Fetch the contents of a given URL, submitting a body that is produced
+   * while it is being uploaded, with chunked encoding.
+   *
+   * @throw std::exception if any error occurs including erroneous HTTP status
+   * code */
+  void FetchStreamingBody(
+      /** [in] URL to get. */
+      const std::string& url,
+      /** [in] Value of the Content-Type header of the body. */
+      const std::string& content_type,
+      /** [in] Stream to read the body from, until its end. */
+      std::istream* body,
+      /** [out] Output to save the response body to. */
+      std::iostream* response) override;
+
+  /** Set when and how failed requests are retried. */
+  void SetRetryPolicy(
+      /** [in] The retry policy. */
+      const RetryPolicy& policy) override;
+
+  /** Guard the requests with a circuit breaker. */
+  void SetCircuitBreaker(
+      /** [in] The breaker, or null to remove it. */
+      std::shared_ptr<CircuitBreaker> breaker) override;
+
+  /** Make the requests wait for their turn in a rate limiter. */
+  void SetRateLimiter(
+      /** [in] The limiter, or null to remove it. */
+      std::shared_ptr<RateLimiter> limiter) override;
+
+  /** Make the transfers wait for a slot of a scheduler, which may pause
+   * them (`curl_easy_pause()`) in favor of higher priorities. */
+  void SetScheduler(
+      /** [in] The scheduler, or null to remove it. */
+      std::shared_ptr<PriorityScheduler> scheduler,
+      /** [in] Priority of the requests of this transport. */
+      Priority priority) override;
+
+  /** Cap the bandwidth of the transfers with a limiter, which sets their
+   * speed limits (`CURLOPT_MAX_SEND_SPEED_LARGE` and
+   * `CURLOPT_MAX_RECV_SPEED_LARGE`) while they run. */
+  void SetBandwidthLimiter(
+      /** [in] The limiter, or null to remove it. */
+      std::shared_ptr<BandwidthLimiter> limiter) override;
+
+  /** Make the requests fail once a point in time is reached. The transfers
+   * are bound by `CURLOPT_TIMEOUT_MS` and `CURLOPT_CONNECTTIMEOUT_MS`, set
+   * to the time left. */
+  void SetDeadline(
+      /** [in] The deadline, `std::chrono::steady_clock::time_point::max()`
+       * for none. */
+      std::chrono::steady_clock::time_point deadline) override;
+
+  /** Make the requests stop when a token is cancelled. Cancelling wakes the
+   * transfer up, which removes its easy handle from the multi stack at
+   * once. */
+  void SetCancellationToken(
+      /** [in] The token, or null for none. */
+      std::shared_ptr<CancellationToken> token) override;
+
   /**
    * Stop the fetch method abruptly, useful whenever the
    * Fetch method is used within a thead, but you want to stop the thread
@@ -131,6 +194,18 @@ class TransportCurl : public Transport {
       /** [in,out] Response from the web server. */
       std::iostream* response);
 
+  /** Check whether a failed request may be retried, see `RetryPolicy`.
+   * @return true if it may */
+  bool IsRetryable(
+      /** [in] URL of the request. */
+      const std::string& url,
+      /** [in] HTTP status received, 0 if none. */
+      long status_code,
+      /** [in] Result of the transfer. */
+      CURLcode result,
+      /** [in] Number of bytes already written to the response. */
+      uint64_t written) const;
+
   /** Initialize cURL. */
   void InitCurl();
 
@@ -152,6 +227,36 @@ class TransportCurl : public Transport {
   /** Flag for enabling CURL verbose mode, useful for debugging */
   bool curl_verbose_;
 
+  /** When and how failed requests are retried. No retries by default. */
+  RetryPolicy retry_policy_;
+
+  /** Circuit breaker of the peer, if any. */
+  std::shared_ptr<CircuitBreaker> circuit_breaker_;
+
+  /** Rate limiter the requests go through, if any. */
+  std::shared_ptr<RateLimiter> rate_limiter_;
+
+  /** Scheduler of the transfers, if any, and their priority. */
+  std::shared_ptr<PriorityScheduler> scheduler_;
+  Priority priority_ = Priority::kNormal;
+
+  /** Bandwidth limiter of the transfers, `BandwidthLimiter::Global()` if
+   * null. */
+  std::shared_ptr<BandwidthLimiter> bandwidth_limiter_;
+
+  /** When the requests fail, `time_point::max()` for never. */
+  std::chrono::steady_clock::time_point deadline_ =
+      std::chrono::steady_clock::time_point::max();
+
+  /** Token that cancels the requests, if any. */
+  std::shared_ptr<CancellationToken> cancellation_token_;
+
+  /** Whether the body of the current request can be sent again. */
+  bool replayable_ = true;
+
+  /** Whether the current request has a body to send. */
+  bool sending_ = false;
+
   /** Flag to cause `UrlEncode()` to fail miserably. */
   bool url_encode_injected_failure = false;
 
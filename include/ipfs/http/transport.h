@@ -20,8 +20,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 #ifndef IPFS_HTTP_TRANSPORT_H
 #define IPFS_HTTP_TRANSPORT_H
 
+#include <ipfs/http/bandwidth-limiter.h>
+#include <ipfs/http/cancellation-token.h>
+#include <ipfs/http/circuit-breaker.h>
+#include <ipfs/http/priority-scheduler.h>
+#include <ipfs/http/rate-limiter.h>
+#include <ipfs/http/retry.h>
+
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -29,6 +38,13 @@ namespace ipfs {
 
 namespace http {
 
+/** Error thrown when a request cannot complete before its deadline.
+ * @since version 0.8.0 */
+class DeadlineExceededError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
 /** HTTP file upload. */
 struct FileUpload {
   /** The type of the `data` member. */
@@ -37,6 +53,9 @@ struct FileUpload {
     kFileContents,
     /** File whose contents is streamed to the web server. For big files. */
     kFileName,
+    /** Stream whose contents is read while it is being uploaded, for data that
+     * is produced on the fly. The upload is sent with chunked encoding. */
+    kStream,
   };
 
   /** File name to pretend to the web server. */
@@ -46,8 +65,12 @@ struct FileUpload {
   Type type;
 
   /** The data to be added. Either a file name from which to read the data or
-   * the contents itself. */
+   * the contents itself. Unused for `Type::kStream`. */
   const std::string data;
+
+  /** Stream to read the data from, for `Type::kStream`. It is read until its
+   * end during the upload and must outlive it. */
+  std::istream* stream = nullptr;
 };
 
 /** Convenience interface for talking basic HTTP. */
@@ -77,6 +100,113 @@ class Transport {
       /** [out] Output to save the response body to. */
       std::iostream* response) = 0;
 
+  /** Fetch the contents of a given URL, submitting a body that is produced
+   * while it is being uploaded, with chunked encoding. For requests whose
+   * body is too large to be described up front, like a multipart upload of a
+   * whole directory tree.
+   *
+   * @throw std::exception if any error occurs including erroneous HTTP status
+   * code, or if the transport does not support streaming bodies
+   *
+   * @since version 0.8.0 */
+  virtual void FetchStreamingBody(
+      /** [in] URL to get. */
+      const std::string& url,
+      /** [in] Value of the Content-Type header of the body. */
+      const std::string& content_type,
+      /** [in] Stream to read the body from, until its end. The transfer is
+       * aborted if the stream goes bad. */
+      std::istream* body,
+      /** [out] Output to save the response body to. */
+      std::iostream* response);
+
+  /** Set when and how failed requests are retried. The policy is copied
+   * along with the transport.
+   *
+   * @throw std::invalid_argument if `policy.max_attempts` is 0
+   * @throw std::runtime_error if the transport does not support retries
+   *
+   * @since version 0.8.0 */
+  virtual void SetRetryPolicy(
+      /** [in] The retry policy. */
+      const RetryPolicy& policy);
+
+  /** Guard the requests with a circuit breaker, usually shared with the
+   * other transports that talk to the same peer. Each attempt of a request
+   * is admitted by the breaker and its outcome recorded. The breaker is
+   * shared with the copies of the transport.
+   *
+   * @throw std::runtime_error if the transport does not support circuit
+   * breakers
+   *
+   * @since version 0.8.0 */
+  virtual void SetCircuitBreaker(
+      /** [in] The breaker, or null to remove it. */
+      std::shared_ptr<CircuitBreaker> breaker);
+
+  /** Make the requests wait for their turn in a rate limiter, possibly
+   * shared with other transports. Each attempt of a request takes a permit
+   * of the class of its command, which it keeps until it completes. The
+   * limiter is shared with the copies of the transport.
+   *
+   * @throw std::runtime_error if the transport does not support rate
+   * limiters
+   *
+   * @since version 0.8.0 */
+  virtual void SetRateLimiter(
+      /** [in] The limiter, or null to remove it. */
+      std::shared_ptr<RateLimiter> limiter);
+
+  /** Make the transfers wait for a slot of a scheduler shared with other
+   * transports, which may also pause them in favor of transfers of a higher
+   * priority. The scheduler and the priority are shared with the copies of
+   * the transport.
+   *
+   * @throw std::runtime_error if the transport does not support schedulers
+   *
+   * @since version 0.8.0 */
+  virtual void SetScheduler(
+      /** [in] The scheduler, or null to remove it. */
+      std::shared_ptr<PriorityScheduler> scheduler,
+      /** [in] Priority of the requests of this transport. */
+      Priority priority);
+
+  /** Cap the bandwidth of the transfers with a limiter, possibly shared
+   * with other transports. Without one, the transfers are only bound by
+   * `BandwidthLimiter::Global()`. The limiter is shared with the copies of
+   * the transport.
+   *
+   * @throw std::runtime_error if the transport does not support bandwidth
+   * limiters
+   *
+   * @since version 0.8.0 */
+  virtual void SetBandwidthLimiter(
+      /** [in] The limiter, or null to remove it. */
+      std::shared_ptr<BandwidthLimiter> limiter);
+
+  /** Make the requests fail with `DeadlineExceededError` once a point in
+   * time is reached, including the time spent waiting for their turn and
+   * between retries.
+   *
+   * @throw std::runtime_error if the transport does not support deadlines
+   *
+   * @since version 0.8.0 */
+  virtual void SetDeadline(
+      /** [in] The deadline, `std::chrono::steady_clock::time_point::max()`
+       * for none. */
+      std::chrono::steady_clock::time_point deadline);
+
+  /** Make the requests stop and throw `CancelledError` when a token is
+   * cancelled, without affecting other transports.
+   *
+   * @throw std::runtime_error if the transport does not support
+   * cancellation tokens
+   *
+   * @since version 0.8.0 */
+  virtual void SetCancellationToken(
+      /** [in] The token, or null for none. */
+      std::shared_ptr<CancellationToken> token);
+
   /**
    * Stop the Fetch method abruptly.
    *
@@ -107,6 +237,50 @@ class Transport {
 
 inline Transport::~Transport() {}
 
+inline void Transport::FetchStreamingBody(const std::string& /* url */,
+                                          const std::string& /* content_type */,
+                                          std::istream* /* body */,
+                                          std::iostream* /* response */) {
+  throw std::runtime_error("This transport does not support streaming bodies");
+}
+
+inline void Transport::SetRetryPolicy(const RetryPolicy& /* policy */) {
+  throw std::runtime_error("This transport does not support retries");
+}
+
+inline void Transport::SetCircuitBreaker(
+    std::shared_ptr<CircuitBreaker> /* breaker */) {
+  throw std::runtime_error("This transport does not support circuit breakers");
+}
+
+inline void Transport::SetRateLimiter(
+    std::shared_ptr<RateLimiter> /* limiter */) {
+  throw std::runtime_error("This transport does not support rate limiters");
+}
+
+inline void Transport::SetScheduler(
+    std::shared_ptr<PriorityScheduler> /* scheduler */,
+    Priority /* priority */) {
+  throw std::runtime_error("This transport does not support schedulers");
+}
+
+inline void Transport::SetBandwidthLimiter(
+    std::shared_ptr<BandwidthLimiter> /* limiter */) {
+  throw std::runtime_error(
+      "This transport does not support bandwidth limiters");
+}
+
+inline void Transport::SetDeadline(
+    std::chrono::steady_clock::time_point /* deadline */) {
+  throw std::runtime_error("This transport does not support deadlines");
+}
+
+inline void Transport::SetCancellationToken(
+    std::shared_ptr<CancellationToken> /* token */) {
+  throw std::runtime_error(
+      "This transport does not support cancellation tokens");
+}
+
 } /* namespace http */
 } /* namespace ipfs */
 
@@ -0,0 +1,80 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_MULTIBASE_H
+#define IPFS_MULTIBASE_H
+
+#include <string>
+#include <string_view>
+
+namespace ipfs {
+
+/** Text encodings of binary data, as used for CIDs.
+ *
+ * @see https://github.com/multiformats/multibase */
+namespace multibase {
+
+/** Encode binary data as base58btc (Bitcoin alphabet), without a multibase
+ * prefix.
+ * @return the encoded string
+ * @since version 0.8.0 */
+std::string EncodeBase58btc(
+    /** [in] Binary data to encode. */
+    std::string_view bytes);
+
+/** Decode base58btc text (Bitcoin alphabet), without a multibase prefix.
+ * @return the decoded binary data
+ * @throw std::runtime_error if the input contains invalid characters
+ * @since version 0.8.0 */
+std::string DecodeBase58btc(
+    /** [in] Text to decode. */
+    std::string_view text);
+
+/** Encode binary data as lowercase RFC 4648 base32 without padding, without a
+ * multibase prefix.
+ * @return the encoded string
+ * @since version 0.8.0 */
+std::string EncodeBase32(
+    /** [in] Binary data to encode. */
+    std::string_view bytes);
+
+/** Decode RFC 4648 base32 text without padding, without a multibase prefix.
+ * Both lowercase and uppercase letters are accepted.
+ * @return the decoded binary data
+ * @throw std::runtime_error if the input contains invalid characters
+ * @since version 0.8.0 */
+std::string DecodeBase32(
+    /** [in] Text to decode. */
+    std::string_view text);
+
+/** Decode multibase text, i.e. text whose first character tells its
+ * encoding. Supported are base58btc ('z'), base32 ('b', 'B') and base16 ('f',
+ * 'F').
+ * @return the decoded binary data
+ * @throw std::runtime_error if the encoding is not supported or the input is
+ * malformed
+ * @since version 0.8.0 */
+std::string Decode(
+    /** [in] Text to decode, including the multibase prefix. */
+    std::string_view text);
+
+} /* namespace multibase */
+} /* namespace ipfs */
+
+#endif /* IPFS_MULTIBASE_H */
@@ -0,0 +1,171 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_TAR_H
+#define IPFS_TAR_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ipfs {
+
+/** Streaming reader of TAR archives, the format in which `Client::Get()`
+ * receives files and directories. */
+namespace tar {
+
+/** An entry of an archive.
+ * @since version 0.8.0 */
+struct Entry {
+  /** Type of an entry. */
+  enum class Type {
+    /** A regular file, followed by its contents. */
+    kFile,
+    /** A directory. */
+    kDirectory,
+    /** A symbolic link. */
+    kSymlink,
+    /** Anything else (hard link, device, FIFO...). Its contents, if any, are
+     * passed along like those of a file. */
+    kOther,
+  };
+
+  /** Path of the entry, relative to the root of the archive, without a
+   * trailing "/". */
+  std::string path;
+
+  /** Type of the entry. */
+  Type type = Type::kFile;
+
+  /** Number of bytes of contents that follow the entry. */
+  uint64_t size = 0;
+
+  /** Permission bits. */
+  uint32_t mode = 0;
+
+  /** Target of a symbolic link. */
+  std::string link_target;
+};
+
+/** Receives the entries of an archive, in order, from a `Parser`. Exceptions
+ * thrown by the handler are propagated to the caller of `Parser::Feed()`.
+ * @since version 0.8.0 */
+class Handler {
+ public:
+  virtual ~Handler() = default;
+
+  /** Called at the start of each entry. */
+  virtual void Begin(
+      /** [in] The entry. */
+      const Entry& entry) = 0;
+
+  /** Called with the contents of the current entry, in order, in as many
+   * pieces as needed. Not called for entries without contents. */
+  virtual void Data(
+      /** [in] The next piece of contents. */
+      std::string_view data) = 0;
+
+  /** Called once all the contents of the current entry were passed. */
+  virtual void End() = 0;
+};
+
+/** Incremental parser of ustar, PAX and GNU TAR archives. The archive is fed
+ * in pieces of any size, as it is received, and is never held in memory
+ * entirely: only the header of the current entry is buffered.
+ *
+ * An example usage:
+ * @snippet test_tar.cc ipfs::tar::Parser
+ *
+ * @since version 0.8.0 */
+class Parser {
+ public:
+  /** Constructor. */
+  explicit Parser(
+      /** [in,out] Handler to pass the entries to. Must outlive the parser. */
+      Handler* handler);
+
+  /** Parse the next piece of the archive.
+   * @throw std::runtime_error if the archive is malformed, or anything thrown
+   * by the handler */
+  void Feed(
+      /** [in] The next piece of the archive. */
+      std::string_view data);
+
+  /** Check that the whole archive was fed.
+   * @throw std::runtime_error if the archive is truncated */
+  void Finish() const;
+
+ private:
+  /** Size of the header blocks, and unit of the padding of the contents. */
+  static constexpr size_t kBlockSize = 512;
+
+  /** Interpret a complete header block. */
+  void ParseHeader();
+
+  /** Interpret the contents of a PAX extended header. */
+  void ParsePax(const std::string& records);
+
+  /** Called when all the contents of the current entry were received. */
+  void EndEntry();
+
+  /** What the next bytes of the archive are. */
+  enum class State {
+    /** A header block. */
+    kHeader,
+    /** Contents of a regular entry, passed to the handler. */
+    kData,
+    /** Contents of a metadata entry (PAX or GNU long name), kept in
+     * `meta_`. */
+    kMeta,
+    /** Padding up to the next block boundary. */
+    kPadding,
+    /** Past the end-of-archive marker. Anything else is ignored. */
+    kEnd,
+  };
+
+  /** Type of the metadata entry whose contents are being received. */
+  char meta_type_ = 0;
+
+  Handler* handler_;
+  State state_ = State::kHeader;
+
+  /** The header block being received. */
+  std::string header_;
+
+  /** Contents of the metadata entry being received. */
+  std::string meta_;
+
+  /** Bytes of contents, or of padding, left to receive. */
+  uint64_t remaining_ = 0;
+
+  /** Padding that follows the contents of the current entry. */
+  uint64_t padding_ = 0;
+
+  /** Overrides for the next entry, from PAX or GNU long name entries. */
+  std::string next_path_;
+  std::string next_link_;
+  bool has_next_size_ = false;
+  uint64_t next_size_ = 0;
+};
+
+} /* namespace tar */
+
+} /* namespace ipfs */
+
+#endif /* IPFS_TAR_H */
@@ -0,0 +1,268 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_TEST_STUB_SERVER_H
+#define IPFS_TEST_STUB_SERVER_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ipfs {
+
+namespace test {
+
+/** A minimal HTTP server on a loopback port, which stands for a peer in the
+ * tests that need peers to misbehave. It serves each request on a connection
+ * of its own: either it answers with a fixed body, possibly after a delay,
+ * or it reads the request and then never answers. */
+class StubServer {
+ public:
+  /** Start listening on a free port of 127.0.0.1. */
+  explicit StubServer(
+      /** [in] Body of the "200 OK" answer to every request. */
+      const std::string& body,
+      /** [in] Never answer: the connections stay open until the client
+       * closes them or the server is stopped. */
+      bool stall = false,
+      /** [in] How long to wait before answering each request. */
+      std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+      : body_(body), stall_(stall), delay_(delay) {
+    listener_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener_ < 0) {
+      throw std::runtime_error("StubServer: socket() failed");
+    }
+    const int yes = 1;
+    setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(listener_, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) != 0 ||
+        listen(listener_, 16) != 0 ||
+        getsockname(listener_, reinterpret_cast<sockaddr*>(&address),
+                    &length) != 0) {
+      close(listener_);
+      throw std::runtime_error("StubServer: can't listen on the loopback");
+    }
+    port_ = ntohs(address.sin_port);
+
+    acceptor_ = std::thread([this]() { Accept(); });
+  }
+
+  /** Destructor. Stops the server. */
+  ~StubServer() { Stop(); }
+
+  StubServer(const StubServer&) = delete;
+  StubServer& operator=(const StubServer&) = delete;
+
+  /** Get the port the server listens on.
+   * @return the port */
+  uint16_t Port() const { return port_; }
+
+  /** Get the number of requests received so far, answered or not.
+   * @return the number of requests */
+  uint64_t Requests() const { return requests_; }
+
+  /** Stop the server: close the connections and stop listening, after which
+   * nothing listens on the port anymore. */
+  void Stop() {
+    if (stopping_.exchange(true)) {
+      return;
+    }
+    acceptor_.join();
+    close(listener_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& connection : connections_) {
+      shutdown(connection->fd, SHUT_RDWR);
+      connection->thread.join();
+      close(connection->fd);
+    }
+    connections_.clear();
+  }
+
+ private:
+  /** An accepted connection and the thread that serves it. */
+  struct Connection {
+    /** Socket of the connection. */
+    int fd;
+
+    /** Thread serving the connection. */
+    std::thread thread;
+  };
+
+  /** Wait until a socket can be read from, or the server is stopped.
+   * @return false if the server is stopped */
+  bool WaitReadable(int fd) const {
+    pollfd wanted{fd, POLLIN, 0};
+    while (!stopping_) {
+      if (poll(&wanted, 1, 20) != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Accept connections until the server is stopped. */
+  void Accept() {
+    while (WaitReadable(listener_)) {
+      const int fd = accept(listener_, nullptr, nullptr);
+      if (fd < 0) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto connection = std::make_unique<Connection>();
+      connection->fd = fd;
+      connection->thread = std::thread([this, fd]() { Serve(fd); });
+      connections_.push_back(std::move(connection));
+    }
+  }
+
+  /** Read a request, then answer it or stall. */
+  void Serve(int fd) {
+    std::string received;
+    if (!ReadRequest(fd, &received)) {
+      return;
+    }
+    ++requests_;
+
+    if (stall_) {
+      /* Until the client hangs up. */
+      char buffer[4096];
+      while (WaitReadable(fd) && recv(fd, buffer, sizeof(buffer), 0) > 0) {
+      }
+      return;
+    }
+
+    const auto answer_at = std::chrono::steady_clock::now() + delay_;
+    while (!stopping_ && std::chrono::steady_clock::now() < answer_at) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    const std::string answer =
+        "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+        "Content-Length: " +
+        std::to_string(body_.size()) + "\r\nConnection: close\r\n\r\n" +
+        body_;
+    for (size_t sent = 0; sent < answer.size();) {
+      const ssize_t n =
+          send(fd, answer.data() + sent, answer.size() - sent, 0);
+      if (n <= 0) {
+        return;
+      }
+      sent += static_cast<size_t>(n);
+    }
+    shutdown(fd, SHUT_WR);
+  }
+
+  /** Read the headers and the body of a request, answering "100 Continue"
+   * if the client asks for it.
+   * @return false if the connection ended before the request did */
+  bool ReadRequest(int fd, std::string* received) const {
+    size_t body_start = std::string::npos;
+    size_t body_size = 0;
+    bool chunked = false;
+
+    for (;;) {
+      if (body_start == std::string::npos) {
+        const size_t end = received->find("\r\n\r\n");
+        if (end != std::string::npos) {
+          body_start = end + 4;
+          std::string headers = received->substr(0, end);
+          std::transform(headers.begin(), headers.end(), headers.begin(),
+                         [](unsigned char c) { return std::tolower(c); });
+          const size_t length = headers.find("\r\ncontent-length:");
+          if (length != std::string::npos) {
+            body_size = std::stoull(headers.substr(length + 17));
+          }
+          chunked = headers.find("transfer-encoding: chunked") !=
+                    std::string::npos;
+          if (headers.find("expect: 100-continue") != std::string::npos) {
+            const std::string go_on = "HTTP/1.1 100 Continue\r\n\r\n";
+            send(fd, go_on.data(), go_on.size(), 0);
+          }
+        }
+      }
+      if (body_start != std::string::npos) {
+        if (chunked ? received->find("\r\n0\r\n\r\n", body_start - 2) !=
+                          std::string::npos
+                    : received->size() - body_start >= body_size) {
+          return true;
+        }
+      }
+
+      char buffer[65536];
+      if (!WaitReadable(fd)) {
+        return false;
+      }
+      const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+      if (n <= 0) {
+        return false;
+      }
+      received->append(buffer, static_cast<size_t>(n));
+    }
+  }
+
+  /** Body of the answers. */
+  const std::string body_;
+
+  /** Whether to never answer. */
+  const bool stall_;
+
+  /** Wait before each answer. */
+  const std::chrono::milliseconds delay_;
+
+  /** Listening socket. */
+  int listener_ = -1;
+
+  /** Port of `listener_`. */
+  uint16_t port_ = 0;
+
+  std::atomic<bool> stopping_{false};
+  std::atomic<uint64_t> requests_{0};
+
+  /** Protects `connections_`. */
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Connection>> connections_;
+
+  /** Thread accepting the connections. */
+  std::thread acceptor_;
+};
+
+} /* namespace test */
+} /* namespace ipfs */
+#endif /* IPFS_TEST_STUB_SERVER_H */
@@ -0,0 +1,330 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace ipfs {
+
+namespace {
+
+/** Content types of the parts of a directory upload, as understood by the
+ * daemon. */
+constexpr char kFileType[] = "application/octet-stream";
+constexpr char kDirectoryType[] = "application/x-directory";
+constexpr char kSymlinkType[] = "application/symlink";
+
+/** Size of the pieces in which the files are read. */
+constexpr size_t kReadSize = 256 * 1024;
+
+/** Escape a path for the filename of a part. The daemon unescapes it, which
+ * keeps the "/" from being taken as the separator of a local path. */
+std::string EscapePath(const std::string& path) {
+  static const char hex[] = "0123456789ABCDEF";
+  std::string escaped;
+  escaped.reserve(path.size());
+  for (const char c : path) {
+    const auto byte = static_cast<unsigned char>(c);
+    if ((byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') ||
+        (byte >= '0' && byte <= '9') || c == '-' || c == '_' || c == '.' ||
+        c == '~') {
+      escaped += c;
+    } else {
+      escaped += '%';
+      escaped += hex[byte >> 4];
+      escaped += hex[byte & 0xf];
+    }
+  }
+  return escaped;
+}
+
+/** Convert a path to UTF-8 with "/" as separator. */
+std::string GenericPath(const std::filesystem::path& path) {
+  const std::u8string generic = path.generic_u8string();
+  return std::string(generic.begin(), generic.end());
+}
+
+/** Produces the multipart/form-data body of a directory upload while it is
+ * being read: the tree is walked one entry at a time and the files are read
+ * piece by piece. */
+class DirectoryUpload : public std::streambuf {
+ public:
+  DirectoryUpload(const std::filesystem::path& root,
+                  const std::string& root_name,
+                  const AddDirectoryOptions& options)
+      : root_(root),
+        root_name_(root_name),
+        options_(options),
+        entries_(root) {
+    std::random_device random;
+    std::uniform_int_distribution<int> digit(0, 15);
+    boundary_ = "ipfs-";
+    for (int i = 0; i < 32; ++i) {
+      boundary_ += "0123456789abcdef"[digit(random)];
+    }
+  }
+
+  /** Value of the Content-Type header of the body. */
+  std::string ContentType() const {
+    return "multipart/form-data; boundary=" + boundary_;
+  }
+
+  /** The error that stopped the body, if any. */
+  std::exception_ptr error() const { return error_; }
+
+ protected:
+  int_type underflow() override {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+
+    buffer_.clear();
+    try {
+      while (buffer_.empty()) {
+        if (!Refill()) {
+          return traits_type::eof();
+        }
+      }
+    } catch (...) {
+      /* The exception makes the stream bad, which aborts the upload rather
+      than sending a truncated body. It is rethrown once the upload stops. */
+      error_ = std::current_exception();
+      throw;
+    }
+
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + buffer_.size());
+    return traits_type::to_int_type(*gptr());
+  }
+
+ private:
+  /** Put the next piece of the body in `buffer_`.
+   * @return false at the end of the body */
+  bool Refill() {
+    if (file_.is_open()) {
+      buffer_.resize(kReadSize);
+      file_.read(buffer_.data(), static_cast<std::streamsize>(kReadSize));
+      buffer_.resize(static_cast<size_t>(file_.gcount()));
+      if (file_.bad() || (file_.fail() && !file_.eof())) {
+        throw std::runtime_error("Cannot read " + file_path_);
+      }
+      if (file_.eof()) {
+        file_.close();
+        buffer_ += "\r\n";
+      }
+      return true;
+    }
+
+    switch (stage_) {
+      case Stage::kRoot:
+        AppendPart(root_name_, kDirectoryType);
+        buffer_ += "\r\n";
+        stage_ = Stage::kEntries;
+        return true;
+
+      case Stage::kEntries:
+        if (started_) {
+          ++entries_;
+        }
+        started_ = true;
+        if (entries_ == std::filesystem::recursive_directory_iterator()) {
+          stage_ = Stage::kTrailer;
+        } else {
+          AddEntry(*entries_);
+        }
+        return true;
+
+      case Stage::kTrailer:
+        buffer_ = "--" + boundary_ + "--\r\n";
+        stage_ = Stage::kDone;
+        return true;
+
+      case Stage::kDone:
+        return false;
+    }
+    return false;
+  }
+
+  /** Start the part of an entry of the tree, or skip it. */
+  void AddEntry(const std::filesystem::directory_entry& entry) {
+    const std::filesystem::path& path = entry.path();
+    const bool hidden = GenericPath(path.filename()).rfind('.', 0) == 0;
+    const std::filesystem::file_status status = entry.symlink_status();
+
+    if (hidden && !options_.hidden) {
+      if (std::filesystem::is_directory(status)) {
+        entries_.disable_recursion_pending();
+      }
+      return;
+    }
+
+    const std::string name =
+        root_name_ + "/" + GenericPath(path.lexically_relative(root_));
+
+    if (std::filesystem::is_symlink(status)) {
+      AppendPart(name, kSymlinkType);
+      buffer_ += GenericPath(std::filesystem::read_symlink(path));
+      buffer_ += "\r\n";
+    } else if (std::filesystem::is_directory(status)) {
+      AppendPart(name, kDirectoryType);
+      buffer_ += "\r\n";
+    } else if (std::filesystem::is_regular_file(status)) {
+      file_path_ = path.string();
+      file_.open(path, std::ios::binary);
+      if (!file_) {
+        throw std::runtime_error("Cannot open " + file_path_);
+      }
+      AppendPart(name, kFileType, file_path_);
+    }
+  }
+
+  /** Append the boundary and the headers of a part. */
+  void AppendPart(const std::string& name, const char* content_type,
+                  const std::string& abspath = std::string()) {
+    buffer_ += "--" + boundary_ + "\r\n";
+    buffer_ += "Content-Disposition: form-data; name=\"file\"; filename=\"" +
+               EscapePath(name) + "\"\r\n";
+    buffer_ += "Content-Type: ";
+    buffer_ += content_type;
+    buffer_ += "\r\n";
+    /* Where the file is on disk, for AddOptions::nocopy. */
+    if (!abspath.empty() &&
+        abspath.find_first_of("\r\n") == std::string::npos) {
+      buffer_ += "Abspath: " + abspath + "\r\n";
+    }
+    buffer_ += "\r\n";
+  }
+
+  /** What comes next in the body. */
+  enum class Stage {
+    /** The part of the root directory. */
+    kRoot,
+    /** The parts of the entries below the root. */
+    kEntries,
+    /** The final boundary. */
+    kTrailer,
+    /** Nothing. */
+    kDone,
+  };
+
+  const std::filesystem::path root_;
+  const std::string root_name_;
+  const AddDirectoryOptions& options_;
+  std::string boundary_;
+
+  Stage stage_ = Stage::kRoot;
+  std::filesystem::recursive_directory_iterator entries_;
+
+  /** Whether `entries_` was already positioned on its first entry. */
+  bool started_ = false;
+
+  /** The file whose contents is being sent, if any. */
+  std::ifstream file_;
+  std::string file_path_;
+
+  /** The piece of the body being read. */
+  std::string buffer_;
+
+  std::exception_ptr error_;
+};
+
+} /* namespace */
+
+void Client::AddDirectory(const std::string& local_path, std::string* cid,
+                          const AddedCallback& callback,
+                          const AddDirectoryOptions& options) {
+  if (!std::filesystem::is_directory(local_path)) {
+    throw std::invalid_argument("AddDirectory(): " + local_path +
+                                " is not a directory");
+  }
+
+  /* The directory is named after the last component of its path. */
+  std::filesystem::path root =
+      std::filesystem::absolute(local_path).lexically_normal();
+  if (!root.has_filename()) {
+    root = root.parent_path();
+  }
+  const std::string root_name = GenericPath(root.filename());
+  if (root_name.empty()) {
+    throw std::invalid_argument("AddDirectory(): cannot name " + local_path);
+  }
+
+  DirectoryUpload upload(root, root_name, options);
+  std::istream body(&upload);
+
+  /* Each line describes an added entry, the directory itself last, for
+  example:
+
+  {"Name":"dir/a.txt","Hash":"QmWP...","Size":"12"}
+  {"Name":"dir","Hash":"QmUN...","Size":"67"} */
+  const std::string root_path = options.wrap_with_directory ? "" : root_name;
+  auto parameters = AddParameters(options);
+  parameters.emplace_back("wrap-with-directory",
+                          options.wrap_with_directory ? "true" : "false");
+
+  cid->clear();
+  try {
+    FetchJsonLines(
+        MakeUrl("add", parameters),
+        upload.ContentType(), &body,
+        [&callback, &root_path, cid](const Json& line) {
+          if (!line.contains("Name") || !line["Name"].is_string() ||
+              !line.contains("Hash") || !line["Hash"].is_string()) {
+            throw std::runtime_error("Unexpected add reply: " + line.dump());
+          }
+
+          AddedEntry entry;
+          entry.path = line["Name"].get<std::string>();
+          entry.cid = Cid(line["Hash"].get<std::string>());
+          if (line.contains("Size")) {
+            const Json& size = line["Size"];
+            entry.size = size.is_string() ? std::stoull(size.get<std::string>())
+                                          : size.get<uint64_t>();
+          }
+
+          if (entry.path == root_path) {
+            *cid = entry.cid.ToString();
+          }
+          if (callback) {
+            callback(entry);
+          }
+        });
+  } catch (...) {
+    if (upload.error()) {
+      std::rethrow_exception(upload.error());
+    }
+    throw;
+  }
+
+  if (cid->empty()) {
+    throw std::runtime_error("AddDirectory(): the reply lacks " +
+                             (root_path.empty() ? std::string("the wrapper")
+                                                : root_path));
+  }
+}
+
+} /* namespace ipfs */
@@ -0,0 +1,183 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/block-index.h>
+#include <ipfs/cid.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ipfs {
+
+BlockIndex::BlockIndex(Client* client, const BlockIndexOptions& options) {
+  CheckOptions(options);
+
+  /* Only what the index needs is kept while listing: for a Bloom filter that
+  is 8 bytes per block, well below the size of the CIDs themselves. */
+  if (options.exact) {
+    std::vector<Cid> keys;
+    client->RefsLocal([&keys](const Cid& cid) { keys.push_back(Key(cid)); });
+    BuildExact(&keys);
+  } else {
+    std::vector<uint64_t> fingerprints;
+    client->RefsLocal([&fingerprints](const Cid& cid) {
+      fingerprints.push_back(Fingerprint(cid));
+    });
+    BuildBloom(&fingerprints, options.false_positive_rate);
+  }
+}
+
+BlockIndex::BlockIndex(const std::vector<Cid>& cids,
+                       const BlockIndexOptions& options) {
+  CheckOptions(options);
+
+  if (options.exact) {
+    std::vector<Cid> keys;
+    keys.reserve(cids.size());
+    for (const auto& cid : cids) {
+      keys.push_back(Key(cid));
+    }
+    BuildExact(&keys);
+  } else {
+    std::vector<uint64_t> fingerprints;
+    fingerprints.reserve(cids.size());
+    for (const auto& cid : cids) {
+      fingerprints.push_back(Fingerprint(cid));
+    }
+    BuildBloom(&fingerprints, options.false_positive_rate);
+  }
+}
+
+bool BlockIndex::Contains(const Cid& cid) const {
+  if (bloom_bits_ == 0) {
+    return std::binary_search(exact_.begin(), exact_.end(), Key(cid));
+  }
+
+  const uint64_t fingerprint = Fingerprint(cid);
+  const uint64_t step = BloomStep(fingerprint);
+  for (unsigned i = 0; i < bloom_hashes_; ++i) {
+    const uint64_t bit = (fingerprint + i * step) % bloom_bits_;
+    if ((bloom_[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t BlockIndex::Size() const { return size_; }
+
+void BlockIndex::CheckOptions(const BlockIndexOptions& options) {
+  if (!options.exact && !(options.false_positive_rate > 0 &&
+                          options.false_positive_rate < 1)) {
+    throw std::invalid_argument(
+        "BlockIndex: false_positive_rate must be between 0 and 1, got " +
+        std::to_string(options.false_positive_rate));
+  }
+}
+
+void BlockIndex::BuildExact(std::vector<Cid>* keys) {
+  std::sort(keys->begin(), keys->end());
+  keys->erase(std::unique(keys->begin(), keys->end()), keys->end());
+  keys->shrink_to_fit();
+
+  exact_ = std::move(*keys);
+  size_ = exact_.size();
+}
+
+void BlockIndex::BuildBloom(std::vector<uint64_t>* fingerprints,
+                            double false_positive_rate) {
+  std::sort(fingerprints->begin(), fingerprints->end());
+  fingerprints->erase(std::unique(fingerprints->begin(), fingerprints->end()),
+                      fingerprints->end());
+  size_ = fingerprints->size();
+
+  /* Optimal size and number of hash functions for `size_` elements:
+  m = -n ln(p) / ln(2)^2 and k = m / n ln(2). */
+  const double ln2 = std::log(2.0);
+  const double bits = std::ceil(-static_cast<double>(size_) *
+                                std::log(false_positive_rate) / (ln2 * ln2));
+  bloom_bits_ = std::max<uint64_t>(64, static_cast<uint64_t>(bits));
+  bloom_bits_ = (bloom_bits_ + 63) / 64 * 64;
+  bloom_hashes_ =
+      size_ == 0 ? 1
+                 : std::max(1u, static_cast<unsigned>(std::lround(
+                                    bloom_bits_ / static_cast<double>(size_) *
+                                    ln2)));
+  bloom_.assign(bloom_bits_ / 64, 0);
+
+  for (const uint64_t fingerprint : *fingerprints) {
+    const uint64_t step = BloomStep(fingerprint);
+    for (unsigned i = 0; i < bloom_hashes_; ++i) {
+      const uint64_t bit = (fingerprint + i * step) % bloom_bits_;
+      bloom_[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+  }
+
+  fingerprints->clear();
+  fingerprints->shrink_to_fit();
+}
+
+Cid BlockIndex::Key(const Cid& cid) {
+  const std::string_view multihash = cid::Multihash(cid.Binary());
+  const char prefix[] = {1, static_cast<char>(cid::kRaw)};
+
+  /* Avoid a heap allocation for the usual, inline-sized CIDs, as this is
+  done on every lookup. */
+  char buffer[Cid::kInlineSize];
+  if (sizeof(prefix) + multihash.size() <= sizeof(buffer)) {
+    std::memcpy(buffer, prefix, sizeof(prefix));
+    std::memcpy(buffer + sizeof(prefix), multihash.data(), multihash.size());
+    return Cid::FromBinary(
+        std::string_view(buffer, sizeof(prefix) + multihash.size()));
+  }
+  return Cid::FromBinary(std::string(prefix, sizeof(prefix)) +
+                         std::string(multihash));
+}
+
+uint64_t BlockIndex::Fingerprint(const Cid& cid) {
+  /* The end of a multihash is the end of its digest, which is already
+  uniformly distributed for cryptographic hash functions. */
+  const std::string_view multihash = cid::Multihash(cid.Binary());
+  uint64_t fingerprint;
+  if (multihash.size() < sizeof(fingerprint)) {
+    return std::hash<std::string_view>()(multihash);
+  }
+  std::memcpy(&fingerprint,
+              multihash.data() + multihash.size() - sizeof(fingerprint),
+              sizeof(fingerprint));
+  return fingerprint;
+}
+
+uint64_t BlockIndex::BloomStep(uint64_t fingerprint) {
+  /* Double hashing (Kirsch and Mitzenmacher), with the second hash derived
+  from the fingerprint by the splitmix64 finalizer and forced odd so that it
+  never degenerates to 0. */
+  uint64_t step = fingerprint;
+  step = (step ^ (step >> 30)) * 0xbf58476d1ce4e5b9;
+  step = (step ^ (step >> 27)) * 0x94d049bb133111eb;
+  return (step ^ (step >> 31)) | 1;
+}
+
+} /* namespace ipfs */
@@ -0,0 +1,326 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/car.h>
+#include <ipfs/cid.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "protobuf.h"
+
+namespace ipfs {
+
+namespace car {
+
+namespace {
+
+/** Sections larger than this are considered malformed rather than allocated.
+ * Blocks are limited to a few MiB by the daemons. */
+constexpr uint64_t kMaxSectionSize = 32 << 20;
+
+/** CBOR tag of IPLD links. */
+constexpr uint64_t kCidTag = 42;
+
+/** CBOR major types. */
+enum class Major : uint8_t {
+  kUnsigned = 0,
+  kNegative = 1,
+  kBytes = 2,
+  kText = 3,
+  kArray = 4,
+  kMap = 5,
+  kTag = 6,
+  kSimple = 7,
+};
+
+/** Append the head of a CBOR item to `out`. */
+void AppendCborHead(Major major, uint64_t value, std::string* out) {
+  const uint8_t type = static_cast<uint8_t>(major) << 5;
+  if (value < 24) {
+    out->push_back(static_cast<char>(type | value));
+    return;
+  }
+
+  size_t width;
+  if (value <= 0xff) {
+    out->push_back(static_cast<char>(type | 24));
+    width = 1;
+  } else if (value <= 0xffff) {
+    out->push_back(static_cast<char>(type | 25));
+    width = 2;
+  } else if (value <= 0xffffffff) {
+    out->push_back(static_cast<char>(type | 26));
+    width = 4;
+  } else {
+    out->push_back(static_cast<char>(type | 27));
+    width = 8;
+  }
+  for (size_t i = width; i > 0; --i) {
+    out->push_back(static_cast<char>(value >> (8 * (i - 1))));
+  }
+}
+
+/** Minimal decoder of the DAG-CBOR subset used by CAR headers. */
+class CborReader {
+ public:
+  explicit CborReader(std::string_view input) : input_(input) {}
+
+  /** Read the head of the next item. For byte and text strings `value` is
+   * the length, for arrays and maps the number of entries. */
+  void Head(Major* major, uint64_t* value) {
+    const uint8_t initial = Byte();
+    *major = static_cast<Major>(initial >> 5);
+    const uint8_t info = initial & 0x1f;
+    if (info < 24) {
+      *value = info;
+      return;
+    }
+    if (info > 27) {
+      Fail("indefinite length items are not supported");
+    }
+    *value = 0;
+    for (size_t i = 0; i < (size_t{1} << (info - 24)); ++i) {
+      *value = (*value << 8) | Byte();
+    }
+  }
+
+  /** Read the contents of a byte or text string of a given length. */
+  std::string_view String(uint64_t length) {
+    if (length > input_.size() - pos_) {
+      Fail("truncated string");
+    }
+    const std::string_view s = input_.substr(pos_, length);
+    pos_ += length;
+    return s;
+  }
+
+  /** Skip the next item, including any nested items. */
+  void Skip() {
+    Major major;
+    uint64_t value;
+    Head(&major, &value);
+    switch (major) {
+      case Major::kBytes:
+      case Major::kText:
+        String(value);
+        break;
+      case Major::kArray:
+        for (uint64_t i = 0; i < value; ++i) {
+          Skip();
+        }
+        break;
+      case Major::kMap:
+        for (uint64_t i = 0; i < value; ++i) {
+          Skip();
+          Skip();
+        }
+        break;
+      case Major::kTag:
+        Skip();
+        break;
+      default:
+        break;
+    }
+  }
+
+  [[noreturn]] void Fail(const std::string& reason) const {
+    throw std::runtime_error("Malformed CAR header: " + reason + " at offset " +
+                             std::to_string(pos_));
+  }
+
+ private:
+  uint8_t Byte() {
+    if (pos_ == input_.size()) {
+      Fail("truncated item");
+    }
+    return static_cast<uint8_t>(input_[pos_++]);
+  }
+
+  std::string_view input_;
+  size_t pos_ = 0;
+};
+
+/** Decode the header of a CAR: {"roots": [CID, ...], "version": 1}. */
+void DecodeHeader(std::string_view header, std::vector<std::string>* roots) {
+  CborReader reader(header);
+  Major major;
+  uint64_t entries;
+  reader.Head(&major, &entries);
+  if (major != Major::kMap) {
+    reader.Fail("not a map");
+  }
+
+  bool have_version = false;
+  for (uint64_t i = 0; i < entries; ++i) {
+    uint64_t length;
+    reader.Head(&major, &length);
+    if (major != Major::kText) {
+      reader.Fail("non-text key");
+    }
+    const std::string_view key = reader.String(length);
+
+    if (key == "version") {
+      uint64_t version;
+      reader.Head(&major, &version);
+      if (major != Major::kUnsigned || version != 1) {
+        throw std::runtime_error("Unsupported CAR version " +
+                                 std::to_string(version));
+      }
+      have_version = true;
+    } else if (key == "roots") {
+      uint64_t count;
+      reader.Head(&major, &count);
+      if (major != Major::kArray) {
+        reader.Fail("roots is not an array");
+      }
+      for (uint64_t j = 0; j < count; ++j) {
+        uint64_t tag;
+        reader.Head(&major, &tag);
+        if (major != Major::kTag || tag != kCidTag) {
+          reader.Fail("root is not a CID");
+        }
+        reader.Head(&major, &length);
+        if (major != Major::kBytes || length < 1) {
+          reader.Fail("root is not a CID");
+        }
+        /* The bytes start with the identity multibase prefix 0x00. */
+        const std::string_view bytes = reader.String(length);
+        if (bytes[0] != 0) {
+          reader.Fail("root is not a CID");
+        }
+        const std::string_view root = bytes.substr(1);
+        if (cid::Length(root) != root.size()) {
+          reader.Fail("root is not a CID");
+        }
+        roots->emplace_back(root);
+      }
+    } else {
+      reader.Skip();
+    }
+  }
+
+  if (!have_version) {
+    reader.Fail("no version");
+  }
+}
+
+} /* namespace */
+
+Writer::Writer(std::ostream* out, const std::vector<std::string>& roots)
+    : out_(out) {
+  /* Canonical DAG-CBOR sorts the keys by length first, so "roots" comes
+  before "version". */
+  std::string header;
+  AppendCborHead(Major::kMap, 2, &header);
+  AppendCborHead(Major::kText, 5, &header);
+  header += "roots";
+  AppendCborHead(Major::kArray, roots.size(), &header);
+  for (const auto& root : roots) {
+    if (cid::Length(root) != root.size()) {
+      throw std::runtime_error("Invalid CAR root: trailing bytes after CID");
+    }
+    AppendCborHead(Major::kTag, kCidTag, &header);
+    AppendCborHead(Major::kBytes, root.size() + 1, &header);
+    header.push_back('\0');
+    header += root;
+  }
+  AppendCborHead(Major::kText, 7, &header);
+  header += "version";
+  AppendCborHead(Major::kUnsigned, 1, &header);
+
+  WriteSection(header, {});
+}
+
+void Writer::Add(std::string_view cid, std::string_view block) {
+  if (cid::Length(cid) != cid.size()) {
+    throw std::runtime_error("Invalid CID: trailing bytes");
+  }
+  WriteSection(cid, block);
+}
+
+void Writer::WriteSection(std::string_view first, std::string_view second) {
+  std::string length;
+  protobuf::AppendVarint(first.size() + second.size(), &length);
+  out_->write(length.data(), static_cast<std::streamsize>(length.size()));
+  out_->write(first.data(), static_cast<std::streamsize>(first.size()));
+  out_->write(second.data(), static_cast<std::streamsize>(second.size()));
+  if (!*out_) {
+    throw std::runtime_error("Failed to write CAR section");
+  }
+}
+
+Reader::Reader(std::istream* in) : in_(in) {
+  if (!ReadSection()) {
+    throw std::runtime_error("Malformed CAR: no header");
+  }
+  DecodeHeader(section_, &roots_);
+}
+
+const std::vector<std::string>& Reader::Roots() const { return roots_; }
+
+bool Reader::Next(std::string* cid, std::string* block) {
+  if (!ReadSection()) {
+    return false;
+  }
+  const size_t cid_length = cid::Length(section_);
+  cid->assign(section_, 0, cid_length);
+  block->assign(section_, cid_length, std::string::npos);
+  return true;
+}
+
+bool Reader::ReadSection() {
+  /* The length is a varint which is read byte by byte, so that nothing past
+  the section is consumed from the stream. */
+  uint64_t length = 0;
+  for (unsigned shift = 0;; shift += 7) {
+    const int c = in_->get();
+    if (c == std::char_traits<char>::eof()) {
+      if (shift == 0 && in_->eof()) {
+        return false;
+      }
+      throw std::runtime_error("Malformed CAR: truncated section length");
+    }
+    if (shift >= 63) {
+      throw std::runtime_error("Malformed CAR: section length too long");
+    }
+    length |= static_cast<uint64_t>(c & 0x7f) << shift;
+    if ((c & 0x80) == 0) {
+      break;
+    }
+  }
+
+  if (length > kMaxSectionSize) {
+    throw std::runtime_error("Malformed CAR: section of " +
+                             std::to_string(length) + " bytes");
+  }
+
+  section_.resize(length);
+  in_->read(&section_[0], static_cast<std::streamsize>(length));
+  if (static_cast<uint64_t>(in_->gcount()) != length) {
+    throw std::runtime_error("Malformed CAR: truncated section");
+  }
+  return true;
+}
+
+} /* namespace car */
+} /* namespace ipfs */
@@ -0,0 +1,255 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/multibase.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "protobuf.h"
+
+namespace ipfs {
+
+namespace cid {
+
+/** Multicodec of sha2-256 multihashes. */
+static constexpr uint8_t kSha2_256 = 0x12;
+
+/** Check if a binary CID is a CIDv0, i.e. a bare sha2-256 multihash.
+ * @return true if CIDv0 */
+static bool IsV0(std::string_view binary) {
+  return binary.size() == 34 && static_cast<uint8_t>(binary[0]) == kSha2_256 &&
+         binary[1] == 32;
+}
+
+/** Parse the header of a CIDv1 and validate the multihash that follows it.
+ * @return the multicodec of the content */
+static uint64_t ParseV1(std::string_view binary) {
+  protobuf::Reader reader(binary, "CID");
+
+  const uint64_t version = reader.Varint();
+  if (version != 1) {
+    reader.Fail("unsupported version " + std::to_string(version));
+  }
+  const uint64_t codec = reader.Varint();
+
+  /* Multihash: <hash function code> <digest length> <digest> */
+  reader.Varint();
+  const uint64_t digest_length = reader.Varint();
+  if (digest_length != binary.size() - reader.Position()) {
+    reader.Fail("digest length mismatch");
+  }
+
+  return codec;
+}
+
+std::string ToString(std::string_view binary) {
+  if (IsV0(binary)) {
+    return multibase::EncodeBase58btc(binary);
+  }
+  ParseV1(binary);
+  return "b" + multibase::EncodeBase32(binary);
+}
+
+std::string FromString(std::string_view text) {
+  std::string binary;
+  if (text.size() == 46 && text.substr(0, 2) == "Qm") {
+    binary = multibase::DecodeBase58btc(text);
+    if (!IsV0(binary)) {
+      throw std::runtime_error("Invalid CIDv0 \"" + std::string(text) + "\"");
+    }
+    return binary;
+  }
+
+  binary = multibase::Decode(text);
+  ParseV1(binary);
+  return binary;
+}
+
+uint64_t Codec(std::string_view binary) {
+  if (IsV0(binary)) {
+    return kDagPb;
+  }
+  return ParseV1(binary);
+}
+
+std::string_view Multihash(std::string_view binary) {
+  if (IsV0(binary)) {
+    return binary;
+  }
+  ParseV1(binary);
+
+  protobuf::Reader reader(binary, "CID");
+  reader.Varint();
+  reader.Varint();
+  return binary.substr(reader.Position());
+}
+
+std::string FromSha256(unsigned version, uint64_t codec,
+                       std::string_view digest) {
+  std::string binary;
+  if (version == 1) {
+    protobuf::AppendVarint(1, &binary);
+    protobuf::AppendVarint(codec, &binary);
+  } else if (version != 0 || codec != kDagPb) {
+    throw std::invalid_argument("Unsupported CID version " +
+                                std::to_string(version) + " with codec " +
+                                std::to_string(codec));
+  }
+  binary.push_back(static_cast<char>(kSha2_256));
+  protobuf::AppendVarint(digest.size(), &binary);
+  binary.append(digest);
+  return binary;
+}
+
+size_t Length(std::string_view data) {
+  if (data.size() >= 2 && static_cast<uint8_t>(data[0]) == kSha2_256 &&
+      data[1] == 32) {
+    if (data.size() < 34) {
+      throw std::runtime_error("Malformed CID: truncated CIDv0");
+    }
+    return 34;
+  }
+
+  protobuf::Reader reader(data, "CID");
+
+  const uint64_t version = reader.Varint();
+  if (version != 1) {
+    reader.Fail("unsupported version " + std::to_string(version));
+  }
+  reader.Varint();
+
+  reader.Varint();
+  const uint64_t digest_length = reader.Varint();
+  if (digest_length > data.size() - reader.Position()) {
+    reader.Fail("truncated digest");
+  }
+
+  return reader.Position() + digest_length;
+}
+
+} /* namespace cid */
+
+Cid::Cid() noexcept {}
+
+Cid::Cid(std::string_view text) { Assign(cid::FromString(text)); }
+
+Cid::Cid(const Cid& other) { Assign(other.Binary()); }
+
+Cid::Cid(Cid&& other) noexcept : size_(other.size_) {
+  std::memcpy(storage_, other.storage_, sizeof(storage_));
+  other.size_ = 0;
+}
+
+Cid& Cid::operator=(const Cid& other) {
+  if (this != &other) {
+    Release();
+    Assign(other.Binary());
+  }
+  return *this;
+}
+
+Cid& Cid::operator=(Cid&& other) noexcept {
+  if (this != &other) {
+    Release();
+    std::memcpy(storage_, other.storage_, sizeof(storage_));
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+Cid::~Cid() { Release(); }
+
+Cid Cid::FromBinary(std::string_view binary) {
+  if (cid::Length(binary) != binary.size()) {
+    throw std::runtime_error("Malformed CID: trailing bytes");
+  }
+  Cid result;
+  result.Assign(binary);
+  return result;
+}
+
+std::string_view Cid::Binary() const {
+  if (size_ == kOnHeap) {
+    return std::string_view(HeapData(), HeapSize());
+  }
+  return std::string_view(storage_, size_);
+}
+
+std::string Cid::ToString() const { return cid::ToString(Binary()); }
+
+uint64_t Cid::Codec() const { return cid::Codec(Binary()); }
+
+bool Cid::Empty() const { return size_ == 0; }
+
+size_t Cid::Hash() const {
+  /* The end of a CID is the end of its digest, which is already uniformly
+  distributed for cryptographic hash functions. */
+  const std::string_view binary = Binary();
+  if (binary.size() < sizeof(size_t)) {
+    return std::hash<std::string_view>()(binary);
+  }
+  size_t hash;
+  std::memcpy(&hash, binary.data() + binary.size() - sizeof(hash),
+              sizeof(hash));
+  return hash;
+}
+
+void Cid::Assign(std::string_view binary) {
+  if (binary.size() <= kInlineSize) {
+    std::memcpy(storage_, binary.data(), binary.size());
+    size_ = static_cast<uint8_t>(binary.size());
+    return;
+  }
+
+  char* data = new char[binary.size()];
+  std::memcpy(data, binary.data(), binary.size());
+  const size_t size = binary.size();
+  std::memcpy(storage_, &data, sizeof(data));
+  std::memcpy(storage_ + sizeof(data), &size, sizeof(size));
+  size_ = kOnHeap;
+}
+
+void Cid::Release() {
+  if (size_ == kOnHeap) {
+    delete[] HeapData();
+  }
+  size_ = 0;
+}
+
+const char* Cid::HeapData() const {
+  const char* data;
+  std::memcpy(&data, storage_, sizeof(data));
+  return data;
+}
+
+size_t Cid::HeapSize() const {
+  size_t size;
+  std::memcpy(&size, storage_ + sizeof(const char*), sizeof(size));
+  return size;
+}
+
+} /* namespace ipfs */
@@ -18,14 +18,24 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
 #include <ipfs/client.h>
+#include <ipfs/file-hasher.h>
 #include <ipfs/http/transport-curl.h>
 #include <ipfs/http/transport.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -41,7 +51,10 @@ Client::Client(const std::string& host, long port, const std::string& timeout,
 }
 
 Client::Client(const Client& other)
-    : url_prefix_(other.url_prefix_), timeout_value_(other.timeout_value_) {
+    : url_prefix_(other.url_prefix_),
+      timeout_value_(other.timeout_value_),
+      deadline_(other.deadline_),
+      cancellation_token_(other.cancellation_token_) {
   http_ = nullptr;
   if (other.http_) {
     http_ = other.http_->Clone();
@@ -50,7 +63,9 @@ Client::Client(const Client& other)
 
 Client::Client(Client&& other) noexcept
     : url_prefix_(std::move(other.url_prefix_)),
-      http_(std::move(other.http_)) {}
+      http_(std::move(other.http_)),
+      deadline_(other.deadline_),
+      cancellation_token_(std::move(other.cancellation_token_)) {}
 
 Client& Client::operator=(const Client& other) {
   if (this == &other) {
@@ -59,6 +74,8 @@ Client& Client::operator=(const Client& other) {
 
   url_prefix_ = other.url_prefix_;
   timeout_value_ = other.timeout_value_;
+  deadline_ = other.deadline_;
+  cancellation_token_ = other.cancellation_token_;
 
   http_ = nullptr;
   if (other.http_) {
@@ -75,6 +92,8 @@ Client& Client::operator=(Client&& other) noexcept {
 
   url_prefix_ = std::move(other.url_prefix_);
   timeout_value_ = std::move(other.timeout_value_);
+  deadline_ = other.deadline_;
+  cancellation_token_ = std::move(other.cancellation_token_);
 
   http_ = std::move(other.http_);
 
@@ -83,6 +102,33 @@ Client& Client::operator=(Client&& other) noexcept {
 
 Client::~Client() = default;
 
+Client::Deadline::Deadline(Client* client, std::chrono::milliseconds budget)
+    : Deadline(client, std::chrono::steady_clock::now() + budget) {}
+
+Client::Deadline::Deadline(Client* client,
+                           std::chrono::steady_clock::time_point deadline)
+    : client_(client), previous_(client->deadline_) {
+  client_->http_->SetDeadline(std::min(previous_, deadline));
+  client_->deadline_ = std::min(previous_, deadline);
+}
+
+Client::Deadline::~Deadline() {
+  client_->deadline_ = previous_;
+  client_->http_->SetDeadline(previous_);
+}
+
+Client::CancelScope::CancelScope(
+    Client* client, std::shared_ptr<http::CancellationToken> token)
+    : client_(client), previous_(client->cancellation_token_) {
+  client_->http_->SetCancellationToken(token);
+  client_->cancellation_token_ = std::move(token);
+}
+
+Client::CancelScope::~CancelScope() {
+  client_->cancellation_token_ = previous_;
+  client_->http_->SetCancellationToken(std::move(previous_));
+}
+
 void Client::Id(Json* id) { FetchAndParseJson(MakeUrl("id"), id); }
 
 void Client::Version(Json* version) {
@@ -195,23 +241,118 @@ void Client::BlockGet(const std::string& block_id, std::iostream* block) {
   http_->Fetch(MakeUrl("block/get", {{"arg", block_id}}), {}, block);
 }
 
+void Client::BlockGet(const Cid& block_id, std::iostream* block) {
+  BlockGet(block_id.ToString(), block);
+}
+
 void Client::BlockPut(const http::FileUpload& block, Json* stat) {
   FetchAndParseJson(MakeUrl("block/put"), {block}, stat);
 }
 
+bool Client::BlockExists(const std::string& block_id) {
+  Json stat;
+  try {
+    FetchAndParseJson(
+        MakeUrl("block/stat", {{"arg", block_id}, {"offline", "true"}}),
+        &stat);
+  } catch (const std::runtime_error& e) {
+    /* Offline, a missing block is reported as an error like "block was not
+    found locally (offline)". */
+    if (std::string(e.what()).find("not found") != std::string::npos) {
+      return false;
+    }
+    throw;
+  }
+  return true;
+}
+
+bool Client::BlockExists(const Cid& block_id) {
+  return BlockExists(block_id.ToString());
+}
+
 void Client::BlockStat(const std::string& block_id, Json* stat) {
   FetchAndParseJson(MakeUrl("block/stat", {{"arg", block_id}}), stat);
 }
 
+void Client::BlockStat(const Cid& block_id, Json* stat) {
+  BlockStat(block_id.ToString(), stat);
+}
+
+void Client::Refs(const std::string& root, bool recursive, bool unique,
+                  const RefCallback& callback) {
+  FetchJsonLines(MakeUrl("refs", {{"arg", root},
+                                  {"recursive", recursive ? "true" : "false"},
+                                  {"unique", unique ? "true" : "false"}}),
+                 {}, [&callback](const Json& ref) { ParseRef(ref, callback); });
+}
+
+void Client::RefsLocal(const RefCallback& callback) {
+  FetchJsonLines(MakeUrl("refs/local"), {}, [&callback](const Json& ref) {
+    ParseRef(ref, callback);
+  });
+}
+
+void Client::DagExport(const std::string& root, std::iostream* car) {
+  http_->Fetch(MakeUrl("dag/export", {{"arg", root}}), {}, car);
+}
+
+void Client::DagExport(const Cid& root, std::iostream* car) {
+  DagExport(root.ToString(), car);
+}
+
+void Client::DagImport(const std::vector<http::FileUpload>& cars, Json* result,
+                       const DagImportOptions& options) {
+  std::stringstream body;
+
+  http_->Fetch(
+      MakeUrl("dag/import",
+              {{"pin-roots", options.pin_roots ? "true" : "false"},
+               {"stats", options.stats ? "true" : "false"}}),
+      cars, &body);
+
+  /* The reply consists of one line per root, followed by a line with the
+  statistics if they were asked for, for example:
+
+  {"Root":{"Cid":{"/":"bafy..."},"PinErrorMsg":""}}
+  {"Stats":{"BlockCount":12,"BlockBytesCount":3456}}
+
+  we convert the links to plain strings and collect the lines into a single
+  JSON. */
+  *result = {{"Roots", Json::array()}};
+
+  std::string line;
+  for (size_t i = 1; std::getline(body, line); ++i) {
+    Json json_chunk;
+
+    ParseJson(line, &json_chunk);
+
+    if (json_chunk.find("Root") != json_chunk.end()) {
+      Json root = json_chunk["Root"];
+      Json link;
+      GetProperty(root, "Cid", i, &link);
+      if (link.is_object()) {
+        std::string cid;
+        GetProperty(link, "/", i, &cid);
+        root["Cid"] = cid;
+      }
+      (*result)["Roots"].push_back(root);
+    } else if (json_chunk.find("Stats") != json_chunk.end()) {
+      (*result)["Stats"] = json_chunk["Stats"];
+    }
+  }
+}
+
 void Client::FilesGet(const std::string& path, std::iostream* response) {
   http_->Fetch(MakeUrl("cat", {{"arg", path}}), {}, response);
 }
 
 void Client::FilesAdd(const std::vector<http::FileUpload>& files,
-                      Json* result) {
+                      Json* result, const AddOptions& options) {
   std::stringstream body;
 
-  http_->Fetch(MakeUrl("add", {{"progress", "true"}}), files, &body);
+  auto parameters = AddParameters(options);
+  parameters.emplace_back("progress", "true");
+  http_->Fetch(MakeUrl("add", parameters), files, &body);
 
   /* The reply consists of multiple lines, each one of which is a JSON, for
   example:
@@ -266,10 +407,361 @@ void Client::FilesAdd(const std::vector<http::FileUpload>& files,
   }
 }
 
+namespace {
+
+/** Get the `FileHasher` options that give the same CIDs as adding a file with
+ * the given options.
+ * @return false if `FileHasher` does not support the options */
+bool HasherOptionsFor(const AddOptions& options,
+                      FileHasherOptions* hasher_options) {
+  /* FileHasher builds balanced trees of fixed-size chunks with sha2-256. */
+  if (options.trickle || options.nocopy || options.cid_version > 1 ||
+      !(options.hash.empty() || options.hash == "sha2-256")) {
+    return false;
+  }
+
+  if (!options.chunker.empty()) {
+    /* The daemon refuses chunks larger than 1 MiB, let it report that. */
+    const std::string prefix = "size-";
+    const size_t max_digits = 7;
+    const size_t max_chunk_size = 1024 * 1024;
+    if (options.chunker.compare(0, prefix.size(), prefix) != 0 ||
+        options.chunker.size() == prefix.size() ||
+        options.chunker.size() > prefix.size() + max_digits ||
+        options.chunker.find_first_not_of("0123456789", prefix.size()) !=
+            std::string::npos) {
+      return false;
+    }
+    const size_t chunk_size = std::stoul(options.chunker.substr(
+        prefix.size()));
+    if (chunk_size == 0 || chunk_size > max_chunk_size) {
+      return false;
+    }
+    hasher_options->chunk_size = chunk_size;
+  }
+
+  hasher_options->cid_version = options.cid_version;
+  hasher_options->raw_leaves = options.raw_leaves;
+  return true;
+}
+
+/** Hash a file to upload, leaving a stream where it was.
+ * @return the CID of the file */
+std::string HashUpload(const http::FileUpload& file,
+                       const FileHasherOptions& options) {
+  FileHasher hasher(options);
+
+  switch (file.type) {
+    case http::FileUpload::Type::kFileContents:
+      hasher.Update(file.data);
+      break;
+    case http::FileUpload::Type::kFileName:
+    case http::FileUpload::Type::kStream: {
+      std::ifstream disk;
+      std::istream* in = file.stream;
+      std::streampos start;
+      if (file.type == http::FileUpload::Type::kFileName) {
+        disk.open(file.data, std::ios::binary);
+        in = &disk;
+      } else {
+        start = in->tellg();
+      }
+      if (!*in || start == std::streampos(-1)) {
+        throw std::runtime_error("Can't read \"" + file.path + "\"");
+      }
+
+      std::string buffer(1 << 20, '\0');
+      while (in->read(&buffer[0], static_cast<std::streamsize>(buffer.size())) ||
+             in->gcount() > 0) {
+        hasher.Update(std::string_view(buffer.data(),
+                                       static_cast<size_t>(in->gcount())));
+      }
+      if (in->bad()) {
+        throw std::runtime_error("Can't read \"" + file.path + "\"");
+      }
+
+      if (file.type == http::FileUpload::Type::kStream) {
+        in->clear();
+        in->seekg(start);
+      }
+      break;
+    }
+  }
+
+  return hasher.Finish();
+}
+
+/** Cuts a reply made of a JSON object whose members are arrays of objects,
+ * like {"Entries": [{...}, {...}]}, into the objects of the arrays, and
+ * passes each of them to a callback as soon as it is complete. Only one
+ * object is held in memory at a time. */
+class ArrayElementSplitter {
+ public:
+  explicit ArrayElementSplitter(
+      const std::function<void(const std::string&)>& on_element)
+      : on_element_(on_element) {}
+
+  /** Consume the next piece of the reply. */
+  void Feed(std::string_view chunk) {
+    for (const char c : chunk) {
+      const bool in_element = open_.size() >= 3;
+      if (in_element) {
+        element_ += c;
+      }
+
+      if (in_string_) {
+        if (escaped_) {
+          escaped_ = false;
+        } else if (c == '\\') {
+          escaped_ = true;
+        } else if (c == '"') {
+          in_string_ = false;
+        }
+        continue;
+      }
+
+      switch (c) {
+        case '"':
+          in_string_ = true;
+          break;
+        case '{':
+        case '[':
+          if (open_.size() == 2 && open_[0] == '{' && open_[1] == '[' &&
+              c == '{') {
+            element_.assign(1, c);
+          }
+          open_.push_back(c);
+          break;
+        case '}':
+        case ']':
+          if (open_.empty() || open_.back() != (c == '}' ? '{' : '[')) {
+            throw std::runtime_error("Malformed JSON reply");
+          }
+          open_.pop_back();
+          if (in_element && open_.size() == 2) {
+            on_element_(element_);
+            element_.clear();
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  /** Check that the reply is complete.
+   * @throw std::runtime_error if it is not */
+  void Finish() const {
+    if (!open_.empty() || in_string_) {
+      throw std::runtime_error("Truncated JSON reply");
+    }
+  }
+
+ private:
+  const std::function<void(const std::string&)>& on_element_;
+
+  /** Brackets that are open, outermost first. */
+  std::string open_;
+  bool in_string_ = false;
+  bool escaped_ = false;
+
+  /** The object being received. */
+  std::string element_;
+};
+
+} /* namespace */
+
+bool Client::FilesAddIfMissing(const http::FileUpload& file,
+                               std::string* cid, const AddOptions& options) {
+  FileHasherOptions hasher_options;
+  if (HasherOptionsFor(options, &hasher_options)) {
+    *cid = HashUpload(file, hasher_options);
+  } else {
+    /* Let the peer compute the CID, without storing anything. */
+    AddOptions only_hash = options;
+    only_hash.only_hash = true;
+    only_hash.pin = false;
+
+    std::streampos start;
+    if (file.type == http::FileUpload::Type::kStream) {
+      start = file.stream->tellg();
+      if (start == std::streampos(-1)) {
+        throw std::runtime_error("Can't read \"" + file.path + "\"");
+      }
+    }
+
+    Json result;
+    FilesAdd({file}, &result, only_hash);
+    GetProperty(result.at(0), "hash", 0, cid);
+
+    if (file.type == http::FileUpload::Type::kStream) {
+      file.stream->clear();
+      file.stream->seekg(start);
+    }
+  }
+
+  /* The root being present is not enough: the peer may have fetched only a
+  part of the file, so check that every block is local. */
+  if (BlockExists(*cid)) {
+    Json stat;
+    FetchAndParseJson(MakeUrl("files/stat", {{"arg", "/ipfs/" + *cid},
+                                             {"with-local", "true"},
+                                             {"offline", "true"}}),
+                      &stat);
+    if (stat.value("Local", false)) {
+      return false;
+    }
+  }
+
+  Json result;
+  FilesAdd({file}, &result, options);
+
+  /* Normally the same as computed, unless the peer is configured with other
+  defaults. */
+  GetProperty(result.at(0), "hash", 0, cid);
+  return true;
+}
+
 void Client::FilesLs(const std::string& path, Json* json) {
   FetchAndParseJson(MakeUrl("file/ls", {{"arg", path}}), {}, json);
 }
 
+void Client::Ls(const std::string& path, const LsCallback& callback,
+                const LsOptions& options) {
+  /* Each line describes one entry, for example:
+
+  {"Objects":[{"Hash":"QmDir...","Links":[{"Name":"a.txt","Hash":"Qm...",
+   "Size":123,"Type":2,"Target":""}]}]}
+
+  where "Type" is a UnixFS data type, or 0 if it was not resolved. */
+  FetchJsonLines(
+      MakeUrl("ls", {{"arg", path},
+                     {"stream", "true"},
+                     {"resolve-type", options.resolve_type ? "true" : "false"},
+                     {"size", options.size ? "true" : "false"}}),
+      {}, [&callback](const Json& line) {
+        Json objects;
+        GetProperty(line, "Objects", 0, &objects);
+        for (const auto& object : objects) {
+          Json links;
+          GetProperty(object, "Links", 0, &links);
+          for (const auto& link : links) {
+            LsEntry entry;
+            std::string hash;
+            GetProperty(link, "Name", 0, &entry.name);
+            GetProperty(link, "Hash", 0, &hash);
+            entry.cid = Cid(hash);
+            entry.size = link.value("Size", uint64_t{0});
+            switch (static_cast<unixfs::DataType>(link.value("Type", 0))) {
+              case unixfs::DataType::kFile:
+                entry.type = LsEntry::Type::kFile;
+                break;
+              case unixfs::DataType::kDirectory:
+              case unixfs::DataType::kHAMTShard:
+                entry.type = LsEntry::Type::kDirectory;
+                break;
+              case unixfs::DataType::kSymlink:
+                entry.type = LsEntry::Type::kSymlink;
+                entry.target = link.value("Target", "");
+                break;
+              default:
+                entry.type = LsEntry::Type::kUnknown;
+                break;
+            }
+            callback(entry);
+          }
+        }
+      });
+}
+
+void Client::FilesWrite(const std::string& path, uint64_t offset,
+                        const http::FileUpload& source, bool create,
+                        bool truncate, bool flush) {
+  std::stringstream unused;
+  http_->Fetch(MakeUrl("files/write",
+                       {{"arg", path},
+                        {"offset", std::to_string(offset)},
+                        {"create", create ? "true" : "false"},
+                        {"truncate", truncate ? "true" : "false"},
+                        {"flush", flush ? "true" : "false"}}),
+               {source}, &unused);
+}
+
+void Client::FilesRead(const std::string& path, uint64_t offset,
+                       uint64_t count, std::iostream* data) {
+  /* The peer rejects counts that do not fit in a signed 64-bit integer. */
+  count = std::min<uint64_t>(count, std::numeric_limits<int64_t>::max());
+
+  http_->Fetch(MakeUrl("files/read", {{"arg", path},
+                                      {"offset", std::to_string(offset)},
+                                      {"count", std::to_string(count)}}),
+               {}, data);
+}
+
+void Client::FilesStat(const std::string& path, Json* stat) {
+  FetchAndParseJson(MakeUrl("files/stat", {{"arg", path}}), stat);
+}
+
+void Client::FilesMkdir(const std::string& path, bool parents, bool flush) {
+  std::stringstream unused;
+  http_->Fetch(MakeUrl("files/mkdir", {{"arg", path},
+                                       {"parents", parents ? "true" : "false"},
+                                       {"flush", flush ? "true" : "false"}}),
+               {}, &unused);
+}
+
+void Client::FilesMv(const std::string& source, const std::string& destination,
+                     bool flush) {
+  std::stringstream unused;
+  http_->Fetch(MakeUrl("files/mv", {{"arg", source},
+                                    {"arg", destination},
+                                    {"flush", flush ? "true" : "false"}}),
+               {}, &unused);
+}
+
+void Client::FilesCp(const std::string& source, const std::string& destination,
+                     bool flush) {
+  std::stringstream unused;
+  http_->Fetch(MakeUrl("files/cp", {{"arg", source},
+                                    {"arg", destination},
+                                    {"flush", flush ? "true" : "false"}}),
+               {}, &unused);
+}
+
+void Client::FilesRm(const std::string& path, bool recursive, bool flush) {
+  std::stringstream unused;
+  http_->Fetch(MakeUrl("files/rm", {{"arg", path},
+                                    {"recursive", recursive ? "true" : "false"},
+                                    {"flush", flush ? "true" : "false"}}),
+               {}, &unused);
+}
+
+void Client::FilesFlush(const std::string& path, std::string* cid) {
+  Json response;
+
+  FetchAndParseJson(MakeUrl("files/flush", {{"arg", path}}), &response);
+
+  GetProperty(response, "Cid", 0, cid);
+}
+
+void Client::FilesList(const std::string& path,
+                       const std::function<void(const Json&)>& callback) {
+  /* The reply is a single JSON, {"Entries": [{...}, {...}, ...]}, with
+  "Entries" being null for an empty directory. Each entry is parsed and
+  handed over as soon as it has been received, so only one is held in
+  memory at a time. */
+  const std::function<void(const std::string&)> on_entry =
+      [&callback](const std::string& text) {
+        Json entry;
+        ParseJson(text, &entry);
+        callback(entry);
+      };
+  ArrayElementSplitter entries(on_entry);
+  FetchChunks(MakeUrl("files/ls", {{"arg", path}, {"long", "true"}}), {},
+              [&entries](std::string_view chunk) { entries.Feed(chunk); });
+  entries.Finish();
+}
+
 void Client::KeyGen(const std::string& key_name, const std::string& key_type,
                     size_t key_size, std::string* generated_key) {
   Json response;
@@ -428,6 +920,8 @@ void Client::PinAdd(const std::string& object_id) {
       "\" got a result that does not contain it as pinned: " + response.dump());
 }
 
+void Client::PinAdd(const Cid& object_id) { PinAdd(object_id.ToString()); }
+
 void Client::PinLs(Json* pinned) {
   FetchAndParseJson(MakeUrl("pin/ls"), pinned);
 }
@@ -447,6 +941,37 @@ void Client::PinRm(const std::string& object_id, PinRmOptions options) {
       &response);
 }
 
+void Client::PinRm(const Cid& object_id, PinRmOptions options) {
+  PinRm(object_id.ToString(), options);
+}
+
+void Client::PinUpdate(const std::string& from, const std::string& to,
+                       bool unpin) {
+  Json response;
+
+  FetchAndParseJson(
+      MakeUrl("pin/update",
+              {{"arg", from}, {"arg", to}, {"unpin", unpin ? "true" : "false"}}),
+      &response);
+}
+
+void Client::PinUpdate(const Cid& from, const Cid& to, bool unpin) {
+  PinUpdate(from.ToString(), to.ToString(), unpin);
+}
+
+void Client::PinUpdate(const std::vector<std::pair<Cid, Cid>>& updates,
+                       const PinUpdateOptions& options) {
+  if (options.concurrency == 0) {
+    throw std::invalid_argument("PinUpdate(): concurrency must be positive");
+  }
+
+  RunConcurrently(updates.size(), options.concurrency,
+                  [&updates, &options](Client* client, size_t i) {
+                    client->PinUpdate(updates[i].first, updates[i].second,
+                                      options.unpin);
+                  });
+}
+
 void Client::StatsBw(Json* bandwidth_info) {
   FetchAndParseJson(MakeUrl("stats/bw"), bandwidth_info);
 }
@@ -473,6 +998,30 @@ void Client::SwarmPeers(Json* peers) {
   FetchAndParseJson(MakeUrl("swarm/peers"), peers);
 }
 
+const std::string& Client::UrlPrefix() const { return url_prefix_; }
+
+void Client::SetRetryPolicy(const http::RetryPolicy& policy) {
+  http_->SetRetryPolicy(policy);
+}
+
+void Client::SetCircuitBreaker(const http::CircuitBreakerOptions& options) {
+  http_->SetCircuitBreaker(http::CircuitBreaker::Shared(url_prefix_, options));
+}
+
+void Client::SetRateLimiter(std::shared_ptr<http::RateLimiter> limiter) {
+  http_->SetRateLimiter(std::move(limiter));
+}
+
+void Client::SetScheduler(std::shared_ptr<http::PriorityScheduler> scheduler,
+                          http::Priority priority) {
+  http_->SetScheduler(std::move(scheduler), priority);
+}
+
+void Client::SetBandwidthLimiter(
+    std::shared_ptr<http::BandwidthLimiter> limiter) {
+  http_->SetBandwidthLimiter(std::move(limiter));
+}
+
 void Client::Abort() { http_->StopFetch(); }
 /**
  * @example threading_example.cc
@@ -496,6 +1045,210 @@ void Client::FetchAndParseJson(const std::string& url,
   ParseJson(body.str(), response);
 }
 
+namespace {
+
+/** Stream buffer that hands everything written to it to a callback, chunk by
+ * chunk, as cURL receives it. */
+class ChunkSink : public std::streambuf {
+ public:
+  explicit ChunkSink(
+      const std::function<void(std::string_view)>& on_chunk)
+      : on_chunk_(on_chunk) {}
+
+  /** The exception thrown by the callback, if any. */
+  std::exception_ptr error() const { return error_; }
+
+ protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    if (error_) {
+      return 0;
+    }
+    try {
+      on_chunk_(std::string_view(s, static_cast<size_t>(n)));
+    } catch (...) {
+      /* Do not let the exception unwind through cURL. Writing nothing makes
+      the transfer stop, and the exception is rethrown afterwards. */
+      error_ = std::current_exception();
+      return 0;
+    }
+    return n;
+  }
+
+  int_type overflow(int_type c) override {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
+    }
+    const char ch = traits_type::to_char_type(c);
+    return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+  }
+
+ private:
+  const std::function<void(std::string_view)>& on_chunk_;
+  std::exception_ptr error_;
+};
+
+/** Fetch a reply through `fetch` and hand it to `on_chunk`, piece by piece.
+ * An exception thrown by `on_chunk` aborts the transfer and is rethrown in
+ * place of the transport error it causes. */
+void FetchToCallback(const std::function<void(std::iostream*)>& fetch,
+                     const std::function<void(std::string_view)>& on_chunk) {
+  ChunkSink sink(on_chunk);
+  std::iostream body(&sink);
+
+  try {
+    fetch(&body);
+  } catch (...) {
+    if (sink.error()) {
+      std::rethrow_exception(sink.error());
+    }
+    throw;
+  }
+}
+
+/** Cuts a reply into lines and passes each of them to a callback. */
+class LineSplitter {
+ public:
+  explicit LineSplitter(
+      const std::function<void(const std::string&)>& on_line)
+      : on_line_(on_line) {}
+
+  /** Consume the next piece of the reply. */
+  void Feed(std::string_view chunk) {
+    for (size_t newline; (newline = chunk.find('\n')) != chunk.npos;) {
+      line_.append(chunk.substr(0, newline));
+      EndLine();
+      chunk.remove_prefix(newline + 1);
+    }
+    line_.append(chunk);
+  }
+
+  /** Consume the last line, which may not be terminated. */
+  void Finish() { EndLine(); }
+
+ private:
+  void EndLine() {
+    if (!line_.empty()) {
+      on_line_(line_);
+      line_.clear();
+    }
+  }
+
+  const std::function<void(const std::string&)>& on_line_;
+  std::string line_;
+};
+
+} /* namespace */
+
+void Client::FetchChunks(
+    const std::string& url, const std::vector<http::FileUpload>& files,
+    const std::function<void(std::string_view)>& on_chunk) {
+  FetchToCallback(
+      [this, &url, &files](std::iostream* response) {
+        http_->Fetch(url, files, response);
+      },
+      on_chunk);
+}
+
+void Client::FetchChunks(
+    const std::string& url, const std::string& content_type,
+    std::istream* upload,
+    const std::function<void(std::string_view)>& on_chunk) {
+  FetchToCallback(
+      [this, &url, &content_type, upload](std::iostream* response) {
+        http_->FetchStreamingBody(url, content_type, upload, response);
+      },
+      on_chunk);
+}
+
+void Client::FetchJsonLines(const std::string& url,
+                            const std::vector<http::FileUpload>& files,
+                            const std::function<void(const Json&)>& callback) {
+  const std::function<void(const std::string&)> on_line =
+      [&callback](const std::string& line) {
+        Json json_chunk;
+        ParseJson(line, &json_chunk);
+        callback(json_chunk);
+      };
+  LineSplitter lines(on_line);
+  FetchChunks(url, files,
+              [&lines](std::string_view chunk) { lines.Feed(chunk); });
+  lines.Finish();
+}
+
+void Client::FetchJsonLines(const std::string& url,
+                            const std::string& content_type,
+                            std::istream* upload,
+                            const std::function<void(const Json&)>& callback) {
+  const std::function<void(const std::string&)> on_line =
+      [&callback](const std::string& line) {
+        Json json_chunk;
+        ParseJson(line, &json_chunk);
+        callback(json_chunk);
+      };
+  LineSplitter lines(on_line);
+  FetchChunks(url, content_type, upload,
+              [&lines](std::string_view chunk) { lines.Feed(chunk); });
+  lines.Finish();
+}
+
+void Client::RunConcurrently(
+    size_t jobs, size_t concurrency,
+    const std::function<void(Client*, size_t)>& job) {
+  if (jobs == 0) {
+    return;
+  }
+
+  /* The clients are copied here rather than in the worker threads because
+  copying one initializes cURL, which is not thread-safe. */
+  std::vector<Client> clients(std::min(concurrency, jobs), *this);
+
+  std::atomic<size_t> next_job{0};
+  std::atomic<bool> failed{false};
+  std::mutex error_mutex;
+  std::exception_ptr error;
+
+  auto work = [&](Client* client) {
+    for (size_t i; !failed && (i = next_job++) < jobs;) {
+      try {
+        job(client, i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(clients.size());
+  for (auto& client : clients) {
+    threads.emplace_back(work, &client);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void Client::ParseRef(const Json& ref, const RefCallback& callback) {
+  /* Errors that occur while listing are reported in the stream itself, after
+  the successful status. */
+  const auto err = ref.find("Err");
+  if (err != ref.end() && err->is_string() &&
+      !err->get<std::string>().empty()) {
+    throw std::runtime_error("Listing refs failed: " + err->get<std::string>());
+  }
+
+  std::string cid;
+  GetProperty(ref, "Ref", 0, &cid);
+  callback(Cid(cid));
+}
+
 void Client::ParseJson(const std::string& input, Json* result) {
   try {
     *result = Json::parse(input);
@@ -517,6 +1270,32 @@ void Client::GetProperty(const Json& input, const std::string& property_name,
   *property_value = input[property_name];
 }
 
+std::vector<std::pair<std::string, std::string>> Client::AddParameters(
+    const AddOptions& options) {
+  std::vector<std::pair<std::string, std::string>> parameters;
+  if (!options.chunker.empty()) {
+    parameters.emplace_back("chunker", options.chunker);
+  }
+  /* The peer rejects an explicit CIDv0 together with another hash than
+  sha2-256, which implies CIDv1. */
+  if (options.cid_version != 0) {
+    parameters.emplace_back("cid-version",
+                            std::to_string(options.cid_version));
+  }
+  /* Always explicit, so that CIDv1 does not enable it behind our back. The
+  peer rejects nocopy without it. */
+  parameters.emplace_back(
+      "raw-leaves", options.raw_leaves || options.nocopy ? "true" : "false");
+  if (!options.hash.empty()) {
+    parameters.emplace_back("hash", options.hash);
+  }
+  parameters.emplace_back("trickle", options.trickle ? "true" : "false");
+  parameters.emplace_back("pin", options.pin ? "true" : "false");
+  parameters.emplace_back("only-hash", options.only_hash ? "true" : "false");
+  parameters.emplace_back("nocopy", options.nocopy ? "true" : "false");
+  return parameters;
+}
+
 std::string Client::MakeUrl(
     const std::string& path,
     const std::vector<std::pair<std::string, std::string>>& parameters) {
@@ -524,7 +1303,16 @@ std::string Client::MakeUrl(
                     "?stream-channels=true&json=true&encoding=json";
   std::vector<std::pair<std::string, std::string>> params = parameters;
 
-  if (!timeout_value_.empty()) {
+  if (deadline_ != std::chrono::steady_clock::time_point::max()) {
+    // Set time-out at server-side to the time left
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline_ - std::chrono::steady_clock::now());
+    if (left.count() <= 0) {
+      throw http::DeadlineExceededError("Request deadline exceeded");
+    }
+    params.push_back(std::make_pair(std::string("timeout"),
+                                    std::to_string(left.count()) + "ms"));
+  } else if (!timeout_value_.empty()) {
     // Set time-out at server-side
     params.push_back(std::make_pair(std::string("timeout"), timeout_value_));
   }
@@ -0,0 +1,658 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+#include <ipfs/cluster-client.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "murmur3.h"
+#include "sha256.h"
+
+namespace ipfs {
+
+namespace {
+
+/** Finalizer of SplitMix64, which spreads the bits of the rendezvous
+ * scores. */
+uint64_t SplitMix64(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/** Stream buffer that forwards everything to another stream and counts it,
+ * to know whether a failed read may be retried elsewhere. */
+class CountingStreambuf : public std::streambuf {
+ public:
+  explicit CountingStreambuf(std::ostream* target) : target_(target) {}
+
+  /** Number of bytes forwarded so far. */
+  uint64_t count() const { return count_; }
+
+ protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    target_->write(s, n);
+    if (!*target_) {
+      return 0;
+    }
+    count_ += static_cast<uint64_t>(n);
+    return n;
+  }
+
+  int_type overflow(int_type c) override {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
+    }
+    const char ch = traits_type::to_char_type(c);
+    return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+  }
+
+ private:
+  std::ostream* target_;
+  uint64_t count_ = 0;
+};
+
+/** Number of times to first byte kept to compute the hedging delay. */
+constexpr size_t kLatencySamples = 256;
+
+/** Number of times to first byte needed before the hedging delay follows
+ * them. */
+constexpr size_t kMinLatencySamples = 20;
+
+/** State shared by the two reads of a hedged read. */
+struct HedgedRead {
+  explicit HedgedRead(std::ostream* output) : response(output) {}
+
+  std::mutex mutex;
+  std::condition_variable cv;
+
+  /** Where the response of the winner goes. */
+  std::ostream* response;
+
+  /** Read whose response started first, -1 until then. */
+  int winner = -1;
+
+  /** When the winner was chosen. */
+  std::chrono::steady_clock::time_point won_at;
+
+  /** Number of reads that are over. */
+  int done = 0;
+
+  /** Per read: when it started, the token that cancels it, whether it was
+   * cancelled and its error. */
+  std::chrono::steady_clock::time_point started[2];
+  std::shared_ptr<http::CancellationToken> tokens[2] = {
+      std::make_shared<http::CancellationToken>(),
+      std::make_shared<http::CancellationToken>()};
+  bool cancelled[2] = {false, false};
+  std::exception_ptr errors[2];
+
+  /** Make `read` the winner if there is none yet, and cancel the other one.
+   * @return whether `read` is the winner */
+  bool Claim(int read) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (winner < 0) {
+      winner = read;
+      won_at = std::chrono::steady_clock::now();
+      cancelled[1 - read] = true;
+      tokens[1 - read]->Cancel();
+      cv.notify_all();
+    }
+    return winner == read;
+  }
+};
+
+/** Stream buffer of one read of a hedged read. The first write claims the
+ * response, the writes of the loser fail, which stops its transfer. */
+class HedgeStreambuf : public std::streambuf {
+ public:
+  HedgeStreambuf(HedgedRead* read, int index) : read_(read), index_(index) {}
+
+ protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    if (!read_->Claim(index_)) {
+      return 0;
+    }
+    read_->response->write(s, n);
+    return *read_->response ? n : 0;
+  }
+
+  int_type overflow(int_type c) override {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
+    }
+    const char ch = traits_type::to_char_type(c);
+    return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+  }
+
+ private:
+  HedgedRead* read_;
+  const int index_;
+};
+
+} /* namespace */
+
+ClusterClient::ClusterClient(const std::vector<Client>& nodes,
+                             const ClusterOptions& options)
+    : options_(options), random_(std::random_device()()) {
+  if (nodes.empty()) {
+    throw std::invalid_argument("ClusterClient(): no nodes");
+  }
+
+  if (options_.replication == 0) {
+    throw std::invalid_argument(
+        "ClusterClient(): replication must be positive");
+  }
+
+  if (options_.probe_interval.count() > 0 &&
+      options_.probe_timeout.count() <= 0) {
+    throw std::invalid_argument(
+        "ClusterClient(): probe_timeout must be positive");
+  }
+
+  nodes_.reserve(nodes.size());
+  for (const auto& client : nodes) {
+    nodes_.push_back(std::make_unique<Node>(client));
+    node_hashes_.push_back(Murmur3X64_64(client.UrlPrefix()));
+  }
+
+  if (options_.probe_interval.count() > 0) {
+    prober_ = std::thread([this]() { Probe(); });
+  }
+}
+
+ClusterClient::~ClusterClient() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  stop_cv_.notify_all();
+  probe_token_->Cancel();
+  if (prober_.joinable()) {
+    prober_.join();
+  }
+}
+
+void ClusterClient::Call(const std::function<void(Client*)>& request) {
+  CallNode(Pick(), request);
+}
+
+void ClusterClient::CallHedged(
+    const std::function<void(Client*, std::iostream*)>& request,
+    std::iostream* response) {
+  const size_t first = Pick();
+  if (!options_.hedge) {
+    CallNode(first, [&request, response](Client* client) {
+      request(client, response);
+    });
+    return;
+  }
+
+  /* Hedge on the healthy node with the fewest requests in progress. */
+  std::vector<size_t> nodes{first};
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (i != first && nodes_[i]->healthy &&
+        (nodes.size() == 1 ||
+         nodes_[i]->outstanding < nodes_[nodes[1]]->outstanding)) {
+      nodes.resize(1);
+      nodes.push_back(i);
+    }
+  }
+  Hedge(nodes, request, response);
+}
+
+std::vector<size_t> ClusterClient::Owners(const Cid& cid) const {
+  const uint64_t key = Murmur3X64_64(cid::Multihash(cid.Binary()));
+
+  std::vector<std::pair<uint64_t, size_t>> scores;
+  scores.reserve(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    scores.emplace_back(SplitMix64(node_hashes_[i] ^ key), i);
+  }
+
+  const size_t n = std::min(options_.replication, scores.size());
+  std::partial_sort(scores.begin(), scores.begin() + n, scores.end(),
+                    [](const auto& a, const auto& b) {
+                      return a.first > b.first ||
+                             (a.first == b.first && a.second < b.second);
+                    });
+
+  std::vector<size_t> owners;
+  owners.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    owners.push_back(scores[i].second);
+  }
+  return owners;
+}
+
+void ClusterClient::CallOwner(const Cid& cid,
+                              const std::function<void(Client*)>& request) {
+  CallFirst(Owners(cid), request, []() { return true; });
+}
+
+void ClusterClient::CallOwners(const Cid& cid,
+                               const std::function<void(Client*)>& request) {
+  const std::vector<size_t> owners = Owners(cid);
+  std::vector<std::exception_ptr> errors(owners.size());
+
+  const auto run = [this, &owners, &errors, &request](size_t i) {
+    try {
+      CallNode(owners[i], request);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+
+  /* The first owner is served by the calling thread. */
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < owners.size(); ++i) {
+    threads.emplace_back(run, i);
+  }
+  run(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+void ClusterClient::PinAdd(const Cid& object_id) {
+  CallOwners(object_id,
+             [&object_id](Client* client) { client->PinAdd(object_id); });
+}
+
+void ClusterClient::BlockPut(const http::FileUpload& block, Json* stat) {
+  if (block.type != http::FileUpload::Type::kFileContents) {
+    throw std::invalid_argument(
+        "ClusterClient::BlockPut(): the block must be given by contents");
+  }
+
+  const Cid cid = Cid::FromBinary(
+      cid::FromSha256(1, cid::kRaw, Sha256::Digest(block.data)));
+  const std::vector<size_t> owners = Owners(cid);
+
+  std::mutex stat_mutex;
+  CallOwners(cid, [this, &block, stat, &stat_mutex,
+                   &owners](Client* client) {
+    Json result;
+    client->BlockPut(block, &result);
+    if (client->UrlPrefix() == nodes_[owners[0]]->prototype.UrlPrefix()) {
+      std::lock_guard<std::mutex> lock(stat_mutex);
+      *stat = result;
+    }
+  });
+}
+
+void ClusterClient::BlockGet(const Cid& block_id, std::iostream* block) {
+  if (options_.hedge) {
+    Hedge(Owners(block_id),
+          [&block_id](Client* client, std::iostream* stream) {
+            client->BlockGet(block_id, stream);
+          },
+          block);
+    return;
+  }
+
+  CountingStreambuf counter(block);
+  std::iostream counted(&counter);
+  CallFirst(
+      Owners(block_id),
+      [&block_id, &counted](Client* client) {
+        client->BlockGet(block_id, &counted);
+      },
+      [&counter]() { return counter.count() == 0; });
+}
+
+void ClusterClient::FilesGet(const std::string& path,
+                             std::iostream* response) {
+  /* The root CID is the first component of the path. */
+  std::string_view root(path);
+  if (root.compare(0, 6, "/ipfs/") == 0) {
+    root.remove_prefix(6);
+  }
+  root = root.substr(0, root.find('/'));
+  const std::vector<size_t> owners = Owners(Cid(std::string(root)));
+
+  if (options_.hedge) {
+    Hedge(owners,
+          [&path](Client* client, std::iostream* stream) {
+            client->FilesGet(path, stream);
+          },
+          response);
+    return;
+  }
+
+  CountingStreambuf counter(response);
+  std::iostream counted(&counter);
+  CallFirst(
+      owners,
+      [&path, &counted](Client* client) { client->FilesGet(path, &counted); },
+      [&counter]() { return counter.count() == 0; });
+}
+
+size_t ClusterClient::Size() const { return nodes_.size(); }
+
+ClusterHedgeStatus ClusterClient::HedgeStatus() const {
+  return {hedged_reads_, hedges_, hedge_wins_, HedgeDelay()};
+}
+
+std::vector<ClusterNodeStatus> ClusterClient::Status() const {
+  std::vector<ClusterNodeStatus> status;
+  status.reserve(nodes_.size());
+  for (const auto& node : nodes_) {
+    status.push_back({node->prototype.UrlPrefix(), node->healthy,
+                      node->outstanding, node->requests, node->failures});
+  }
+  return status;
+}
+
+size_t ClusterClient::Pick() {
+  std::vector<size_t> healthy;
+  healthy.reserve(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (nodes_[i]->healthy) {
+      healthy.push_back(i);
+    }
+  }
+  if (healthy.empty()) {
+    throw std::runtime_error("ClusterClient: no healthy node");
+  }
+
+  /* Start at a random node, so that ties do not always go to the first
+  one. */
+  size_t start;
+  size_t other;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    start = random_() % healthy.size();
+    other = random_() % healthy.size();
+  }
+
+  if (options_.balancing == ClusterOptions::Balancing::kPowerOfTwoChoices) {
+    const size_t a = healthy[start];
+    const size_t b = healthy[other];
+    return nodes_[b]->outstanding < nodes_[a]->outstanding ? b : a;
+  }
+
+  size_t best = healthy[start];
+  size_t best_outstanding = std::numeric_limits<size_t>::max();
+  for (size_t i = 0; i < healthy.size(); ++i) {
+    const size_t candidate = healthy[(start + i) % healthy.size()];
+    const size_t outstanding = nodes_[candidate]->outstanding;
+    if (outstanding < best_outstanding) {
+      best = candidate;
+      best_outstanding = outstanding;
+    }
+  }
+  return best;
+}
+
+void ClusterClient::CallFirst(const std::vector<size_t>& nodes,
+                              const std::function<void(Client*)>& request,
+                              const std::function<bool()>& may_retry) {
+  std::exception_ptr error;
+  for (const size_t node : nodes) {
+    if (!nodes_[node]->healthy) {
+      continue;
+    }
+    try {
+      CallNode(node, request);
+      return;
+    } catch (...) {
+      error = std::current_exception();
+    }
+    if (!may_retry()) {
+      break;
+    }
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  throw std::runtime_error("ClusterClient: no healthy owner");
+}
+
+void ClusterClient::Hedge(
+    const std::vector<size_t>& candidates,
+    const std::function<void(Client*, std::iostream*)>& request,
+    std::iostream* response) {
+  std::vector<size_t> nodes;
+  for (const size_t node : candidates) {
+    if (nodes_[node]->healthy && nodes.size() < 2) {
+      nodes.push_back(node);
+    }
+  }
+  if (nodes.empty()) {
+    throw std::runtime_error("ClusterClient: no healthy owner");
+  }
+  if (nodes.size() == 1) {
+    nodes.push_back(nodes[0]);
+  }
+  ++hedged_reads_;
+
+  HedgedRead read(response);
+  const auto run = [this, &read, &nodes, &request](int index) {
+    Node* node = nodes_[nodes[index]].get();
+    ++node->outstanding;
+    ++node->requests;
+
+    HedgeStreambuf sink(&read, index);
+    std::iostream stream(&sink);
+    std::unique_ptr<Client> client;
+    bool reusable = false;
+    try {
+      client = Acquire(node);
+      Client::CancelScope scope(client.get(), read.tokens[index]);
+      request(client.get(), &stream);
+      /* An empty response claims nothing while it is received. */
+      reusable = read.Claim(index);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(read.mutex);
+      if (read.cancelled[index]) {
+        /* Cancelling only stopped the request: the client is as good as
+        new. */
+        reusable = client != nullptr;
+      } else {
+        ++node->failures;
+        read.errors[index] = std::current_exception();
+      }
+    }
+
+    if (reusable) {
+      Release(node, std::move(client));
+    }
+    --node->outstanding;
+
+    std::lock_guard<std::mutex> lock(read.mutex);
+    ++read.done;
+    read.cv.notify_all();
+  };
+
+  std::thread threads[2];
+  read.started[0] = std::chrono::steady_clock::now();
+  threads[0] = std::thread(run, 0);
+  int launched = 1;
+  bool hedged = false;
+  {
+    std::unique_lock<std::mutex> lock(read.mutex);
+    read.cv.wait_for(lock, HedgeDelay(),
+                     [&read]() { return read.winner >= 0 || read.done > 0; });
+    /* Hedge if the response has not started yet, or fail over at once if
+    the read failed without writing anything. */
+    if (read.winner < 0) {
+      if (read.done == 0) {
+        hedged = true;
+        ++hedges_;
+      }
+      read.started[1] = std::chrono::steady_clock::now();
+      threads[1] = std::thread(run, 1);
+      launched = 2;
+    }
+    read.cv.wait(lock, [&read, launched]() { return read.done == launched; });
+  }
+  for (auto& thread : threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  if (read.winner < 0) {
+    std::rethrow_exception(read.errors[0] ? read.errors[0] : read.errors[1]);
+  }
+  RecordFirstByte(std::chrono::duration_cast<std::chrono::microseconds>(
+      read.won_at - read.started[read.winner]));
+  if (hedged && read.winner == 1) {
+    ++hedge_wins_;
+  }
+  if (read.errors[read.winner]) {
+    std::rethrow_exception(read.errors[read.winner]);
+  }
+}
+
+std::chrono::microseconds ClusterClient::HedgeDelay() const {
+  std::vector<int64_t> samples;
+  {
+    std::lock_guard<std::mutex> lock(latency_mutex_);
+    samples = latencies_;
+  }
+  if (samples.size() < kMinLatencySamples) {
+    return options_.hedge_delay;
+  }
+
+  const double percentile =
+      std::clamp(options_.hedge_percentile, 0.0, 1.0);
+  const auto nth =
+      samples.begin() +
+      static_cast<std::ptrdiff_t>(percentile * (samples.size() - 1));
+  std::nth_element(samples.begin(), nth, samples.end());
+  return std::chrono::microseconds(*nth);
+}
+
+void ClusterClient::RecordFirstByte(std::chrono::microseconds latency) {
+  std::lock_guard<std::mutex> lock(latency_mutex_);
+  if (latencies_.size() < kLatencySamples) {
+    latencies_.push_back(latency.count());
+  } else {
+    latencies_[next_latency_] = latency.count();
+    next_latency_ = (next_latency_ + 1) % kLatencySamples;
+  }
+}
+
+void ClusterClient::CallNode(size_t index,
+                             const std::function<void(Client*)>& request) {
+  Node* node = nodes_[index].get();
+  ++node->outstanding;
+  ++node->requests;
+
+  std::unique_ptr<Client> client;
+  try {
+    client = Acquire(node);
+    request(client.get());
+  } catch (...) {
+    ++node->failures;
+    --node->outstanding;
+    /* The client may be in the middle of a broken transfer: do not reuse
+    it. */
+    throw;
+  }
+
+  Release(node, std::move(client));
+  --node->outstanding;
+}
+
+std::unique_ptr<Client> ClusterClient::Acquire(Node* node) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!node->idle.empty()) {
+    std::unique_ptr<Client> client = std::move(node->idle.back());
+    node->idle.pop_back();
+    return client;
+  }
+  /* Copying a client initializes cURL, which is not thread-safe, hence the
+  lock. */
+  return std::make_unique<Client>(node->prototype);
+}
+
+void ClusterClient::Release(Node* node, std::unique_ptr<Client> client) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  node->idle.push_back(std::move(client));
+}
+
+void ClusterClient::Probe() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    lock.unlock();
+    std::vector<std::thread> probes;
+    probes.reserve(nodes_.size());
+    for (auto& node : nodes_) {
+      probes.emplace_back([this, &node]() { ProbeNode(node.get()); });
+    }
+    for (auto& probe : probes) {
+      probe.join();
+    }
+    lock.lock();
+
+    stop_cv_.wait_for(lock, options_.probe_interval,
+                      [this]() { return stopping_; });
+  }
+}
+
+void ClusterClient::ProbeNode(Node* node) {
+  bool ok = true;
+  try {
+    Client::Deadline deadline(&node->probe, options_.probe_timeout);
+    Client::CancelScope scope(&node->probe, probe_token_);
+    Json version;
+    node->probe.Version(&version);
+  } catch (const std::exception&) {
+    ok = false;
+  }
+
+  if (probe_token_->IsCancelled()) {
+    /* Stopped, not failed. */
+    return;
+  }
+  if (ok) {
+    node->failed_probes = 0;
+    node->healthy = true;
+  } else if (++node->failed_probes >= options_.failure_threshold) {
+    node->healthy = false;
+  }
+}
+
+} /* namespace ipfs */
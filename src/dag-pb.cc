@@ -0,0 +1,181 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/dag-pb.h>
+
+#include <cstdint>
+#include <string_view>
+
+#include "protobuf.h"
+
+namespace ipfs {
+
+namespace dagpb {
+
+/** Decode a PBLink message. */
+static void DecodeLink(std::string_view input, Link* link) {
+  protobuf::Reader reader(input, "dag-pb link");
+  uint64_t field;
+  protobuf::WireType type;
+  bool has_hash = false;
+
+  while (reader.Next(&field, &type)) {
+    switch (field) {
+      case 1:
+        reader.Expect(type, protobuf::WireType::kLengthDelimited, field);
+        link->hash = reader.Bytes();
+        has_hash = true;
+        break;
+      case 2:
+        reader.Expect(type, protobuf::WireType::kLengthDelimited, field);
+        link->name = reader.Bytes();
+        break;
+      case 3:
+        reader.Expect(type, protobuf::WireType::kVarint, field);
+        link->tsize = reader.Varint();
+        break;
+      default:
+        reader.Skip(type);
+    }
+  }
+
+  if (!has_hash) {
+    reader.Fail("link without a hash");
+  }
+}
+
+void Decode(std::string_view block, Node* node) {
+  protobuf::Reader reader(block, "dag-pb node");
+  uint64_t field;
+  protobuf::WireType type;
+
+  node->links.clear();
+  node->data = std::string_view();
+
+  while (reader.Next(&field, &type)) {
+    switch (field) {
+      case 1:
+        reader.Expect(type, protobuf::WireType::kLengthDelimited, field);
+        node->data = reader.Bytes();
+        break;
+      case 2:
+        reader.Expect(type, protobuf::WireType::kLengthDelimited, field);
+        node->links.emplace_back();
+        DecodeLink(reader.Bytes(), &node->links.back());
+        break;
+      default:
+        reader.Skip(type);
+    }
+  }
+}
+
+} /* namespace dagpb */
+
+namespace unixfs {
+
+/** Decode a UnixTime message. */
+static void DecodeTime(std::string_view input, Data* data) {
+  protobuf::Reader reader(input, "UnixFS mtime");
+  uint64_t field;
+  protobuf::WireType type;
+
+  while (reader.Next(&field, &type)) {
+    switch (field) {
+      case 1:
+        reader.Expect(type, protobuf::WireType::kVarint, field);
+        data->mtime_seconds = static_cast<int64_t>(reader.Varint());
+        break;
+      case 2:
+        reader.Expect(type, protobuf::WireType::kFixed32, field);
+        data->mtime_nanoseconds = static_cast<uint32_t>(reader.Fixed(4));
+        break;
+      default:
+        reader.Skip(type);
+    }
+  }
+}
+
+void Decode(std::string_view input, Data* data) {
+  protobuf::Reader reader(input, "UnixFS data");
+  uint64_t field;
+  protobuf::WireType type;
+  bool has_type = false;
+
+  *data = Data();
+
+  while (reader.Next(&field, &type)) {
+    switch (field) {
+      case 1: {
+        reader.Expect(type, protobuf::WireType::kVarint, field);
+        const uint64_t value = reader.Varint();
+        if (value > static_cast<uint64_t>(DataType::kHAMTShard)) {
+          reader.Fail("unknown type " + std::to_string(value));
+        }
+        data->type = static_cast<DataType>(value);
+        has_type = true;
+        break;
+      }
+      case 2:
+        reader.Expect(type, protobuf::WireType::kLengthDelimited, field);
+        data->data = reader.Bytes();
+        break;
+      case 3:
+        reader.Expect(type, protobuf::WireType::kVarint, field);
+        data->filesize = reader.Varint();
+        break;
+      case 4:
+        if (type == protobuf::WireType::kLengthDelimited) {
+          /* Packed encoding, not produced by go-ipfs but valid protobuf. */
+          protobuf::Reader packed(reader.Bytes(), "UnixFS blocksizes");
+          while (packed.Position() < packed.Size()) {
+            data->blocksizes.push_back(packed.Varint());
+          }
+        } else {
+          reader.Expect(type, protobuf::WireType::kVarint, field);
+          data->blocksizes.push_back(reader.Varint());
+        }
+        break;
+      case 5:
+        reader.Expect(type, protobuf::WireType::kVarint, field);
+        data->hash_type = reader.Varint();
+        break;
+      case 6:
+        reader.Expect(type, protobuf::WireType::kVarint, field);
+        data->fanout = reader.Varint();
+        break;
+      case 7:
+        reader.Expect(type, protobuf::WireType::kVarint, field);
+        data->mode = static_cast<uint32_t>(reader.Varint());
+        break;
+      case 8:
+        reader.Expect(type, protobuf::WireType::kLengthDelimited, field);
+        DecodeTime(reader.Bytes(), data);
+        break;
+      default:
+        reader.Skip(type);
+    }
+  }
+
+  if (!has_type) {
+    reader.Fail("missing type");
+  }
+}
+
+} /* namespace unixfs */
+} /* namespace ipfs */
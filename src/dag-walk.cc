@@ -0,0 +1,301 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+#include <ipfs/dag-pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ipfs {
+
+namespace {
+
+/** A node waiting to be fetched. */
+struct DagWalkTask {
+  /** Id of the node. */
+  Cid cid;
+
+  /** Distance from the root of the walk. */
+  size_t depth;
+};
+
+/** Set of already seen CIDs, split into independently locked shards so that
+ * the fetchers do not serialize on a single mutex. */
+class SeenSet {
+ public:
+  /** Add `cid` to the set.
+   * @return true if it was not in the set before */
+  bool Insert(const Cid& cid) {
+    Shard& shard = shards_[cid.Hash() % kNumShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.cids.insert(cid).second;
+  }
+
+ private:
+  static constexpr size_t kNumShards = 64;
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_set<Cid> cids;
+  };
+
+  Shard shards_[kNumShards];
+};
+
+/** State shared by all fetchers of a single `Client::DagWalk()` call. */
+class DagWalker {
+ public:
+  DagWalker(const Client& client, const DagVisitor& visitor,
+            const DagWalkOptions& options)
+      : visitor_(visitor),
+        options_(options),
+        queues_(options.concurrency),
+        clients_(options.concurrency, client) {}
+
+  /** Run the walk to completion.
+   * @throw std::exception the first error encountered by any fetcher */
+  void Run(const std::string& root) {
+    Cid cid(root);
+    seen_.Insert(cid);
+    Push(0, {std::move(cid), 0});
+
+    std::vector<std::thread> threads;
+    threads.reserve(queues_.size());
+    for (size_t i = 0; i < queues_.size(); ++i) {
+      threads.emplace_back([this, i]() { Work(i); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  /** Per-fetcher queue of nodes. The owner takes from the front, which keeps
+   * the walk breadth-first, thieves take from the back. */
+  struct Queue {
+    std::mutex mutex;
+    std::deque<DagWalkTask> tasks;
+  };
+
+  /** Main loop of the fetcher `self`. */
+  void Work(size_t self) {
+    DagWalkTask task;
+    while (!stop_) {
+      if (Pop(self, &task) || Steal(self, &task)) {
+        try {
+          Visit(self, task);
+        } catch (...) {
+          Fail(std::current_exception());
+        }
+        if (--outstanding_ == 0) {
+          std::lock_guard<std::mutex> lock(idle_mutex_);
+          idle_cv_.notify_all();
+        }
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(idle_mutex_);
+      if (outstanding_ == 0) {
+        break;
+      }
+      /* Tasks are pushed without holding `idle_mutex_`, so do not rely on the
+       * notification alone and poll the queues every now and then. */
+      idle_cv_.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+        return stop_ || outstanding_ == 0 || queued_ > 0;
+      });
+    }
+  }
+
+  /** Fetch a node, hand it to the visitor and schedule its children. */
+  void Visit(size_t self, const DagWalkTask& task) {
+    if (stop_) {
+      return;
+    }
+
+    if (++visited_ > options_.max_nodes) {
+      Stop();
+      return;
+    }
+
+    DagNode node{task.cid.ToString(), task.depth, std::string(),
+                 dagpb::Node()};
+    std::stringstream block;
+    clients_[self].BlockGet(node.cid, &block);
+    node.block = block.str();
+    if (task.cid.Codec() == cid::kDagPb) {
+      dagpb::Decode(node.block, &node.node);
+    }
+
+    bool descend;
+    {
+      std::lock_guard<std::mutex> lock(visitor_mutex_);
+      if (failed_) {
+        return;
+      }
+      descend = visitor_(node);
+    }
+
+    if (!descend || task.depth >= options_.max_depth) {
+      return;
+    }
+
+    for (const auto& link : node.node.links) {
+      Cid hash = Cid::FromBinary(link.hash);
+      if (!seen_.Insert(hash)) {
+        continue;
+      }
+
+      DagWalkTask child{std::move(hash), task.depth + 1};
+      if (queued_ < options_.max_frontier) {
+        Push(self, std::move(child));
+      } else {
+        Visit(self, child);
+      }
+    }
+  }
+
+  /** Append a task to the queue of the fetcher `self`. */
+  void Push(size_t self, DagWalkTask&& task) {
+    ++outstanding_;
+    ++queued_;
+    {
+      std::lock_guard<std::mutex> lock(queues_[self].mutex);
+      queues_[self].tasks.push_back(std::move(task));
+    }
+    idle_cv_.notify_one();
+  }
+
+  /** Take a task from the front of the fetcher's own queue.
+   * @return false if the queue is empty */
+  bool Pop(size_t self, DagWalkTask* task) {
+    std::lock_guard<std::mutex> lock(queues_[self].mutex);
+    auto& tasks = queues_[self].tasks;
+    if (tasks.empty()) {
+      return false;
+    }
+    *task = std::move(tasks.front());
+    tasks.pop_front();
+    --queued_;
+    return true;
+  }
+
+  /** Take a task from the back of some other fetcher's queue.
+   * @return false if all queues are empty */
+  bool Steal(size_t self, DagWalkTask* task) {
+    for (size_t i = 1; i < queues_.size(); ++i) {
+      Queue& victim = queues_[(self + i) % queues_.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        *task = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+        --queued_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Record the first error and stop the walk. */
+  void Fail(std::exception_ptr error) {
+    {
+      std::lock_guard<std::mutex> lock(error_mutex_);
+      if (!error_) {
+        error_ = error;
+      }
+    }
+    failed_ = true;
+    Stop();
+  }
+
+  /** Make all fetchers exit as soon as possible. */
+  void Stop() {
+    stop_ = true;
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    idle_cv_.notify_all();
+  }
+
+  const DagVisitor& visitor_;
+  const DagWalkOptions& options_;
+
+  /** One queue per fetcher. */
+  std::vector<Queue> queues_;
+
+  /** One client (and thus one connection) per fetcher. */
+  std::vector<Client> clients_;
+
+  SeenSet seen_;
+
+  /** Serializes the calls to `visitor_`. */
+  std::mutex visitor_mutex_;
+
+  /** Number of tasks sitting in the queues. */
+  std::atomic<size_t> queued_{0};
+
+  /** Number of tasks queued or being visited. The walk is complete when this
+   * drops to 0. */
+  std::atomic<size_t> outstanding_{0};
+
+  /** Number of nodes visited so far. */
+  std::atomic<size_t> visited_{0};
+
+  /** Set when the walk is complete or must be cut short. Nodes that are
+   * already being fetched are still handed to the visitor. */
+  std::atomic<bool> stop_{false};
+
+  /** Set when an error occurred. Nothing is handed to the visitor anymore. */
+  std::atomic<bool> failed_{false};
+
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cv_;
+
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+};
+
+} /* namespace */
+
+void Client::DagWalk(const std::string& root, const DagVisitor& visitor,
+                     const DagWalkOptions& options) {
+  if (options.concurrency == 0) {
+    throw std::invalid_argument("DagWalk(): concurrency must be positive");
+  }
+
+  DagWalker walker(*this, visitor, options);
+  walker.Run(root);
+}
+
+} /* namespace ipfs */
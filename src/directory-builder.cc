@@ -0,0 +1,237 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/car.h>
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+#include <ipfs/dag-pb.h>
+#include <ipfs/directory-builder.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "murmur3.h"
+#include "protobuf.h"
+#include "sha256.h"
+
+namespace ipfs {
+
+namespace {
+
+/** Multihash code of murmur3-x64-64, the hash function of UnixFS HAMTs. */
+constexpr uint64_t kMurmur3X64_64 = 0x22;
+
+/** Append a dag-pb link to a block. */
+void AppendLink(std::string_view cid, std::string_view name, uint64_t tsize,
+                std::string* block) {
+  std::string link;
+  protobuf::AppendBytesField(1, cid, &link);
+  protobuf::AppendBytesField(2, name, &link);
+  protobuf::AppendVarintField(3, tsize, &link);
+  protobuf::AppendBytesField(2, link, block);
+}
+
+} /* namespace */
+
+DirectoryBuilder::DirectoryBuilder(const DirectoryBuilderOptions& options)
+    : options_(options) {
+  if (options_.cid_version > 1) {
+    throw std::invalid_argument("DirectoryBuilder: unsupported CID version " +
+                                std::to_string(options_.cid_version));
+  }
+  if (options_.fanout < 8 || (options_.fanout & (options_.fanout - 1)) != 0) {
+    throw std::invalid_argument(
+        "DirectoryBuilder: fanout must be a power of 2, at least 8");
+  }
+  while ((size_t{1} << bits_per_level_) < options_.fanout) {
+    ++bits_per_level_;
+  }
+}
+
+void DirectoryBuilder::Add(const std::string& name, const Cid& cid,
+                           uint64_t size) {
+  if (name.empty() || name == "." || name == ".." ||
+      name.find('/') != std::string::npos) {
+    throw std::invalid_argument("DirectoryBuilder: invalid entry name \"" +
+                                name + "\"");
+  }
+  if (cid.Empty()) {
+    throw std::invalid_argument("DirectoryBuilder: empty CID for \"" + name +
+                                "\"");
+  }
+
+  const std::string_view binary = cid.Binary();
+  if (!entries_.emplace(name, Entry{std::string(binary), size}).second) {
+    throw std::invalid_argument("DirectoryBuilder: duplicate entry \"" + name +
+                                "\"");
+  }
+  estimated_size_ += name.size() + binary.size();
+}
+
+size_t DirectoryBuilder::Size() const { return entries_.size(); }
+
+std::string DirectoryBuilder::Build(const BlockSink& sink) const {
+  if (options_.shard_threshold == 0 ||
+      estimated_size_ < options_.shard_threshold) {
+    return cid::ToString(BuildBasic(sink).cid);
+  }
+
+  std::vector<HashedEntry> hashed;
+  hashed.reserve(entries_.size());
+  for (const auto& entry : entries_) {
+    hashed.push_back({Murmur3X64_64(entry.first), &entry.first, &entry.second});
+  }
+  /* Sorting by hash makes the entries of each bucket contiguous, at every
+  level. */
+  std::sort(hashed.begin(), hashed.end(),
+            [](const HashedEntry& a, const HashedEntry& b) {
+              return a.hash < b.hash;
+            });
+
+  return cid::ToString(
+      BuildShard(hashed.data(), hashed.data() + hashed.size(), 0, sink).cid);
+}
+
+std::string DirectoryBuilder::Put(Client* client, bool pin) const {
+  std::vector<std::pair<std::string, std::string>> blocks;
+  const std::string root =
+      Build([&blocks](const std::string& cid, const std::string& block) {
+        blocks.emplace_back(cid, block);
+      });
+
+  std::stringstream archive;
+  car::Writer writer(&archive, {blocks.back().first});
+  for (const auto& block : blocks) {
+    writer.Add(block.first, block.second);
+  }
+
+  DagImportOptions options;
+  options.pin_roots = pin;
+  Json result;
+  client->DagImport(
+      {{"directory.car", http::FileUpload::Type::kFileContents, archive.str()}},
+      &result, options);
+
+  return root;
+}
+
+DirectoryBuilder::Child DirectoryBuilder::BuildBasic(
+    const BlockSink& sink) const {
+  /* dag-pb puts the links before the data. `entries_` is sorted by name,
+  which is the order of the links that dag-pb requires. */
+  std::string block;
+  uint64_t links_tsize = 0;
+  for (const auto& entry : entries_) {
+    AppendLink(entry.second.cid, entry.first, entry.second.size, &block);
+    links_tsize += entry.second.size;
+  }
+
+  std::string data;
+  protobuf::AppendVarintField(
+      1, static_cast<uint64_t>(unixfs::DataType::kDirectory), &data);
+  protobuf::AppendBytesField(1, data, &block);
+
+  return Emit(block, links_tsize, sink);
+}
+
+DirectoryBuilder::Child DirectoryBuilder::BuildShard(
+    const HashedEntry* begin, const HashedEntry* end, unsigned depth,
+    const BlockSink& sink) const {
+  const unsigned used_bits = bits_per_level_ * (depth + 1);
+  if (used_bits > 64) {
+    throw std::runtime_error("DirectoryBuilder: the hashes of \"" +
+                             *begin->name + "\" and \"" + *(begin + 1)->name +
+                             "\" collide");
+  }
+  const unsigned shift = 64 - used_bits;
+  const uint64_t mask = options_.fanout - 1;
+
+  /* Buckets are named after their index, in upper case hexadecimal padded to
+  the width of the largest index. */
+  static const char kHex[] = "0123456789ABCDEF";
+  size_t width = 0;
+  for (uint64_t n = mask; n != 0; n >>= 4) {
+    ++width;
+  }
+
+  /* Bit i of the bitfield is bit (i % 8) of the (i / 8)-th byte from the end,
+  and the leading zero bytes are left out. */
+  std::string bitfield(options_.fanout / 8, '\0');
+
+  std::string block;
+  uint64_t links_tsize = 0;
+  for (const HashedEntry* bucket = begin; bucket != end;) {
+    const uint64_t index = (bucket->hash >> shift) & mask;
+    const HashedEntry* bucket_end = bucket + 1;
+    while (bucket_end != end && ((bucket_end->hash >> shift) & mask) == index) {
+      ++bucket_end;
+    }
+
+    std::string prefix(width, '0');
+    for (size_t i = 0; i < width; ++i) {
+      prefix[width - 1 - i] = kHex[(index >> (4 * i)) & 0xf];
+    }
+    bitfield[bitfield.size() - 1 - index / 8] |=
+        static_cast<char>(1 << (index % 8));
+
+    /* A bucket holds either a single entry or a child node with all the
+    entries that share its index. */
+    if (bucket_end - bucket == 1) {
+      AppendLink(bucket->entry->cid, prefix + *bucket->name,
+                 bucket->entry->size, &block);
+      links_tsize += bucket->entry->size;
+    } else {
+      const Child child = BuildShard(bucket, bucket_end, depth + 1, sink);
+      AppendLink(child.cid, prefix, child.tsize, &block);
+      links_tsize += child.tsize;
+    }
+
+    bucket = bucket_end;
+  }
+
+  bitfield.erase(0, bitfield.find_first_not_of('\0'));
+
+  std::string data;
+  protobuf::AppendVarintField(
+      1, static_cast<uint64_t>(unixfs::DataType::kHAMTShard), &data);
+  protobuf::AppendBytesField(2, bitfield, &data);
+  protobuf::AppendVarintField(5, kMurmur3X64_64, &data);
+  protobuf::AppendVarintField(6, options_.fanout, &data);
+  protobuf::AppendBytesField(1, data, &block);
+
+  return Emit(block, links_tsize, sink);
+}
+
+DirectoryBuilder::Child DirectoryBuilder::Emit(const std::string& block,
+                                               uint64_t links_tsize,
+                                               const BlockSink& sink) const {
+  Child child{cid::FromSha256(options_.cid_version, cid::kDagPb,
+                              Sha256::Digest(block)),
+              block.size() + links_tsize};
+  if (sink) {
+    sink(child.cid, block);
+  }
+  return child;
+}
+
+} /* namespace ipfs */
@@ -0,0 +1,173 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/dag-pb.h>
+#include <ipfs/file-hasher.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "protobuf.h"
+#include "sha256.h"
+
+namespace ipfs {
+
+FileHasher::FileHasher(const FileHasherOptions& options, const BlockSink& sink)
+    : options_(options), sink_(sink) {
+  if (options_.chunk_size == 0) {
+    throw std::invalid_argument("FileHasher: chunk_size must be positive");
+  }
+  if (options_.max_links < 2) {
+    throw std::invalid_argument("FileHasher: max_links must be at least 2");
+  }
+  if (options_.cid_version > 1) {
+    throw std::invalid_argument("FileHasher: unsupported CID version " +
+                                std::to_string(options_.cid_version));
+  }
+  chunk_.reserve(options_.chunk_size);
+}
+
+void FileHasher::Update(std::string_view data) {
+  size_ += data.size();
+  while (!data.empty()) {
+    const size_t n = std::min(options_.chunk_size - chunk_.size(), data.size());
+    chunk_.append(data.substr(0, n));
+    data.remove_prefix(n);
+    if (chunk_.size() == options_.chunk_size) {
+      AddLeaf();
+    }
+  }
+}
+
+std::string FileHasher::Finish() {
+  /* An empty file is a single empty leaf. */
+  if (!chunk_.empty() || !have_leaves_) {
+    AddLeaf();
+  }
+
+  /* Close the partially filled nodes from the bottom up. The root is the
+  only block left on the highest level, which for a single chunk is the
+  leaf itself. */
+  for (size_t level = 0;; ++level) {
+    const bool top = level + 1 == levels_.size();
+    if (top && levels_[level].size() == 1) {
+      return cid::ToString(levels_[level][0].cid);
+    }
+    if (!levels_[level].empty()) {
+      AddChild(level + 1, BuildNode(level));
+    }
+  }
+}
+
+uint64_t FileHasher::Size() const { return size_; }
+
+std::string FileHasher::Hash(std::string_view data,
+                             const FileHasherOptions& options) {
+  FileHasher hasher(options);
+  hasher.Update(data);
+  return hasher.Finish();
+}
+
+void FileHasher::AddLeaf() {
+  have_leaves_ = true;
+  const uint64_t size = chunk_.size();
+
+  if (options_.raw_leaves) {
+    AddChild(0, Emit(cid::kRaw, std::move(chunk_), size, size));
+  } else {
+    std::string data;
+    protobuf::AppendVarintField(1, static_cast<uint64_t>(unixfs::DataType::kFile),
+                                &data);
+    if (!chunk_.empty()) {
+      protobuf::AppendBytesField(2, chunk_, &data);
+    }
+    protobuf::AppendVarintField(3, size, &data);
+
+    std::string block;
+    protobuf::AppendBytesField(1, data, &block);
+    const uint64_t tsize = block.size();
+    AddChild(0, Emit(cid::kDagPb, std::move(block), tsize, size));
+  }
+
+  chunk_.clear();
+  chunk_.reserve(options_.chunk_size);
+}
+
+void FileHasher::AddChild(size_t level, Child&& child) {
+  if (levels_.size() <= level) {
+    levels_.resize(level + 1);
+  }
+  levels_[level].push_back(std::move(child));
+
+  if (levels_[level].size() == options_.max_links) {
+    AddChild(level + 1, BuildNode(level));
+  }
+}
+
+FileHasher::Child FileHasher::BuildNode(size_t level) {
+  std::vector<Child>& children = levels_[level];
+
+  /* dag-pb puts the links before the data. The links have an empty name,
+  like the ones created by the daemon. */
+  std::string block;
+  std::string data;
+  uint64_t tsize = 0;
+  uint64_t filesize = 0;
+  for (const auto& child : children) {
+    std::string link;
+    protobuf::AppendBytesField(1, child.cid, &link);
+    protobuf::AppendBytesField(2, "", &link);
+    protobuf::AppendVarintField(3, child.tsize, &link);
+    protobuf::AppendBytesField(2, link, &block);
+    tsize += child.tsize;
+    filesize += child.filesize;
+  }
+
+  protobuf::AppendVarintField(1, static_cast<uint64_t>(unixfs::DataType::kFile),
+                              &data);
+  protobuf::AppendVarintField(3, filesize, &data);
+  for (const auto& child : children) {
+    protobuf::AppendVarintField(4, child.filesize, &data);
+  }
+  protobuf::AppendBytesField(1, data, &block);
+
+  children.clear();
+  tsize += block.size();
+  return Emit(cid::kDagPb, std::move(block), tsize, filesize);
+}
+
+FileHasher::Child FileHasher::Emit(uint64_t codec, std::string&& block,
+                                   uint64_t tsize, uint64_t filesize) {
+  /* CIDv0 can only name dag-pb blocks, so raw leaves are always CIDv1, as
+  the daemon does. */
+  const unsigned version = codec == cid::kRaw ? 1 : options_.cid_version;
+  Child child{cid::FromSha256(version, codec, Sha256::Digest(block)), tsize,
+              filesize};
+  if (sink_) {
+    sink_(child.cid, block);
+  }
+  return child;
+}
+
+} /* namespace ipfs */
@@ -0,0 +1,366 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/dag-pb.h>
+#include <ipfs/file-reader.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ipfs {
+
+struct FileReader::Node {
+  /** Raw contents of the block. */
+  std::string block;
+
+  /** `block` decoded as dag-pb. Empty for raw blocks. */
+  dagpb::Node node;
+
+  /** UnixFS metadata of the node. Empty for raw blocks. */
+  unixfs::Data data;
+
+  /** Whether this is a raw block, whose contents is the file data itself. */
+  bool raw = false;
+
+  /** Number of file bytes under the node, according to its own contents.
+   * @return the size of the data of the node and of all its children */
+  uint64_t Size() const {
+    if (raw) {
+      return block.size();
+    }
+    uint64_t size = data.data.size();
+    for (uint64_t blocksize : data.blocksizes) {
+      size += blocksize;
+    }
+    return size;
+  }
+};
+
+class FileReader::Prefetcher {
+ public:
+  Prefetcher(const Client& client, size_t workers)
+      : clients_(workers, client) {
+    /* The clients are copied here rather than in the worker threads because
+    copying one initializes cURL, which is not thread-safe. */
+    threads_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+      threads_.emplace_back([this, i]() { Work(&clients_[i]); });
+    }
+  }
+
+  ~Prefetcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  /** Make the given blocks, and only them, be prefetched. Blocks that were
+   * wanted before, but are not anymore, are forgotten. */
+  void Want(const std::vector<std::string>& cids) {
+    const std::unordered_set<std::string> wanted(cids.begin(), cids.end());
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      for (auto it = results_.begin(); it != results_.end();) {
+        if (wanted.count(it->first) == 0) {
+          pending_.erase(it->first);
+          it = results_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                                  [this](const std::string& cid) {
+                                    return pending_.count(cid) == 0;
+                                  }),
+                   queue_.end());
+
+      for (const auto& cid : cids) {
+        if (results_.count(cid) == 0) {
+          std::promise<std::string> promise;
+          results_.emplace(cid, promise.get_future().share());
+          pending_.emplace(cid, std::move(promise));
+          queue_.push_back(cid);
+        }
+      }
+    }
+    cv_.notify_all();
+  }
+
+  /** Get a prefetched block, waiting for its fetch to complete if needed.
+   * @return false if the block has not been asked for */
+  bool Take(const std::string& cid, std::string* block) {
+    std::shared_future<std::string> result;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = results_.find(cid);
+      if (it == results_.end()) {
+        return false;
+      }
+      result = it->second;
+      results_.erase(it);
+    }
+    *block = result.get();
+    return true;
+  }
+
+ private:
+  void Work(Client* client) {
+    for (;;) {
+      std::string cid;
+      std::promise<std::string> promise;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+          return;
+        }
+        cid = std::move(queue_.front());
+        queue_.pop_front();
+        auto it = pending_.find(cid);
+        if (it == pending_.end()) {
+          continue;
+        }
+        promise = std::move(it->second);
+        pending_.erase(it);
+      }
+
+      try {
+        std::stringstream block;
+        client->BlockGet(cid::ToString(cid), &block);
+        promise.set_value(block.str());
+      } catch (...) {
+        promise.set_exception(std::current_exception());
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopping_ = false;
+
+  /** Blocks waiting for a worker, in order. */
+  std::deque<std::string> queue_;
+
+  /** Promises of the blocks that no worker has picked yet. */
+  std::unordered_map<std::string, std::promise<std::string>> pending_;
+
+  /** Results of all wanted blocks, fetched or not. */
+  std::unordered_map<std::string, std::shared_future<std::string>> results_;
+
+  /** One client per worker. */
+  std::vector<Client> clients_;
+
+  std::vector<std::thread> threads_;
+};
+
+FileReader::FileReader(const Client& client, const std::string& cid,
+                       const FileReaderOptions& options)
+    : client_(client), options_(options), root_(cid::FromString(cid)) {
+  root_node_ = GetNode(root_);
+
+  if (root_node_->raw) {
+    size_ = root_node_->block.size();
+  } else {
+    if (root_node_->data.type != unixfs::DataType::kFile &&
+        root_node_->data.type != unixfs::DataType::kRaw) {
+      throw std::runtime_error(cid + " is not a UnixFS file");
+    }
+    size_ = root_node_->data.filesize;
+    if (root_node_->node.links.empty()) {
+      size_ = root_node_->data.data.size();
+    }
+  }
+
+  if (options_.readahead > 0) {
+    prefetcher_ = std::make_unique<Prefetcher>(client_, options_.readahead);
+  }
+}
+
+FileReader::~FileReader() = default;
+
+uint64_t FileReader::Size() const { return size_; }
+
+void FileReader::Read(uint64_t offset, size_t length, std::string* data) {
+  data->clear();
+  if (offset >= size_) {
+    return;
+  }
+  const uint64_t end = offset + std::min<uint64_t>(length, size_ - offset);
+  data->reserve(end - offset);
+
+  sequential_ = offset == next_offset_;
+  next_offset_ = end;
+
+  for (uint64_t pos = offset; pos < end;) {
+    Locate(pos);
+    const uint64_t begin_in_leaf = pos - leaf_offset_;
+    if (begin_in_leaf >= leaf_.size()) {
+      throw std::runtime_error(
+          "Malformed UnixFS file node: no data at offset " +
+          std::to_string(pos));
+    }
+    const uint64_t n =
+        std::min<uint64_t>(leaf_.size() - begin_in_leaf, end - pos);
+    data->append(leaf_.substr(begin_in_leaf, n));
+    pos += n;
+  }
+}
+
+void FileReader::Read(size_t length, std::string* data) {
+  Read(position_, length, data);
+  position_ += data->size();
+}
+
+void FileReader::Seek(uint64_t offset) { position_ = offset; }
+
+uint64_t FileReader::Tell() const { return position_; }
+
+void FileReader::Locate(uint64_t offset) {
+  if (leaf_node_ && offset >= leaf_offset_ &&
+      offset - leaf_offset_ < leaf_.size()) {
+    return;
+  }
+
+  path_.clear();
+  std::shared_ptr<const Node> node = root_node_;
+  uint64_t node_offset = 0;
+
+  for (;;) {
+    if (node->raw) {
+      leaf_ = node->block;
+      break;
+    }
+
+    /* The data stored in the node itself comes before the data of its
+    children. */
+    leaf_ = node->data.data;
+    uint64_t child_offset = node_offset + leaf_.size();
+    if (offset < child_offset || node->node.links.empty()) {
+      break;
+    }
+
+    const auto& links = node->node.links;
+    const auto& blocksizes = node->data.blocksizes;
+    if (blocksizes.size() != links.size()) {
+      throw std::runtime_error(
+          "Malformed UnixFS file node: " + std::to_string(links.size()) +
+          " links but " + std::to_string(blocksizes.size()) + " blocksizes");
+    }
+
+    size_t i = 0;
+    while (i < links.size() && offset - child_offset >= blocksizes[i]) {
+      child_offset += blocksizes[i];
+      ++i;
+    }
+    if (i == links.size()) {
+      throw std::runtime_error("Offset " + std::to_string(offset) +
+                               " is beyond the end of the UnixFS file tree");
+    }
+
+    path_.push_back({node, i});
+    node = GetNode(std::string(links[i].hash));
+    node_offset = child_offset;
+
+    /* A child smaller than announced would leave a hole in the file. */
+    if (node->Size() != blocksizes[i]) {
+      throw std::runtime_error(
+          "Malformed UnixFS file node: child " + std::to_string(i) + " has " +
+          std::to_string(node->Size()) + " bytes but " +
+          std::to_string(blocksizes[i]) + " are announced");
+    }
+  }
+
+  leaf_node_ = std::move(node);
+  leaf_offset_ = node_offset;
+
+  if (prefetcher_ && sequential_) {
+    ScheduleReadahead();
+  }
+}
+
+std::shared_ptr<const FileReader::Node> FileReader::GetNode(
+    const std::string& cid) {
+  auto cached = cache_.find(cid);
+  if (cached != cache_.end()) {
+    lru_.splice(lru_.begin(), lru_, cached->second.lru);
+    return cached->second.node;
+  }
+
+  auto node = std::make_shared<Node>();
+  if (!prefetcher_ || !prefetcher_->Take(cid, &node->block)) {
+    std::stringstream block;
+    client_.BlockGet(cid::ToString(cid), &block);
+    node->block = block.str();
+  }
+
+  node->raw = cid::Codec(cid) == cid::kRaw;
+  if (!node->raw) {
+    dagpb::Decode(node->block, &node->node);
+    unixfs::Decode(node->node.data, &node->data);
+  }
+
+  if (!node->node.links.empty() && options_.cache_size > 0) {
+    if (cache_.size() >= options_.cache_size) {
+      cache_.erase(lru_.back());
+      lru_.pop_back();
+    }
+    lru_.push_front(cid);
+    cache_.emplace(cid, CacheEntry{node, lru_.begin()});
+  }
+
+  return node;
+}
+
+void FileReader::ScheduleReadahead() {
+  /* The blocks that follow the current leaf are its next siblings, then the
+  next siblings of its parent, and so on upwards. */
+  std::vector<std::string> wanted;
+  for (auto level = path_.rbegin();
+       level != path_.rend() && wanted.size() < options_.readahead; ++level) {
+    const auto& links = level->node->node.links;
+    for (size_t i = level->index + 1;
+         i < links.size() && wanted.size() < options_.readahead; ++i) {
+      std::string cid(links[i].hash);
+      if (cache_.count(cid) == 0) {
+        wanted.push_back(std::move(cid));
+      }
+    }
+  }
+  prefetcher_->Want(wanted);
+}
+
+} /* namespace ipfs */
@@ -0,0 +1,442 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+#include <ipfs/tar.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace ipfs {
+
+namespace {
+
+/** A file being extracted. It is closed once the last write to it is done,
+ * which may happen after the parser moved on to other entries. */
+class OutputFile {
+ public:
+#ifdef _WIN32
+  OutputFile(const std::filesystem::path& path, uint32_t /* mode */)
+      : path_(path.string()) {
+    if (std::filesystem::is_symlink(std::filesystem::symlink_status(path))) {
+      throw std::runtime_error("Refusing to write through symbolic link " +
+                               path_);
+    }
+    stream_.open(path, std::ios::binary | std::ios::trunc);
+    if (!stream_) {
+      throw std::runtime_error("Cannot create " + path_);
+    }
+  }
+
+  void Preallocate(uint64_t /* size */) {}
+
+  void Write(uint64_t offset, std::string_view data) {
+    /* The stream has a single position, so the writes are serialized. */
+    std::lock_guard<std::mutex> lock(mutex_);
+    stream_.seekp(static_cast<std::streamoff>(offset));
+    stream_.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!stream_) {
+      throw std::runtime_error("Cannot write to " + path_);
+    }
+  }
+#else
+  OutputFile(const std::filesystem::path& path, uint32_t mode)
+      : path_(path.string()) {
+    /* Never write through a symbolic link, which could point anywhere. */
+    fd_ = open(path_.c_str(),
+               O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW,
+               mode != 0 ? (mode & 0777) : 0666);
+    if (fd_ < 0) {
+      throw std::runtime_error("Cannot create " + path_ + ": " +
+                               std::strerror(errno));
+    }
+  }
+
+  ~OutputFile() { close(fd_); }
+
+  /** Reserve the space of the whole file at once, which keeps it contiguous
+   * even though its pieces are written out of order. */
+  void Preallocate(uint64_t size) {
+    if (size == 0) {
+      return;
+    }
+#ifdef __linux__
+    const int error = posix_fallocate(fd_, 0, static_cast<off_t>(size));
+#else
+    const int error =
+        ftruncate(fd_, static_cast<off_t>(size)) == 0 ? 0 : errno;
+#endif
+    if (error != 0) {
+      throw std::runtime_error("Cannot allocate " + std::to_string(size) +
+                               " bytes for " + path_ + ": " +
+                               std::strerror(error));
+    }
+  }
+
+  void Write(uint64_t offset, std::string_view data) {
+    while (!data.empty()) {
+      const ssize_t n = pwrite(fd_, data.data(), data.size(),
+                               static_cast<off_t>(offset));
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::runtime_error("Cannot write to " + path_ + ": " +
+                                 std::strerror(errno));
+      }
+      data.remove_prefix(static_cast<size_t>(n));
+      offset += static_cast<uint64_t>(n);
+    }
+  }
+#endif
+
+  OutputFile(const OutputFile&) = delete;
+  OutputFile& operator=(const OutputFile&) = delete;
+
+ private:
+  std::string path_;
+#ifdef _WIN32
+  std::mutex mutex_;
+  std::ofstream stream_;
+#else
+  int fd_;
+#endif
+};
+
+/** Extracts the entries of an archive below a directory. The parser thread
+ * only creates directories and files and cuts their contents in chunks,
+ * which a pool of writers write at their offset. */
+class Extractor : public tar::Handler {
+ public:
+  Extractor(const std::string& destination, const GetOptions& options)
+      : destination_(destination), options_(options) {
+    std::filesystem::create_directories(destination_);
+
+    writers_.reserve(options_.writers);
+    for (size_t i = 0; i < options_.writers; ++i) {
+      writers_.emplace_back([this]() { Work(); });
+    }
+  }
+
+  ~Extractor() override { Stop(); }
+
+  void Begin(const tar::Entry& entry) override {
+    ThrowIfFailed();
+
+    std::string key;
+    const std::filesystem::path path = Resolve(entry.path, &key);
+    if (symlinks_.erase(key) > 0) {
+      /* An entry replaces a symbolic link extracted before it, rather than
+      being created wherever the link points to. */
+      std::filesystem::remove(path);
+    }
+
+    switch (entry.type) {
+      case tar::Entry::Type::kDirectory:
+        std::filesystem::create_directories(path);
+        break;
+
+      case tar::Entry::Type::kSymlink:
+        std::filesystem::create_directories(path.parent_path());
+        std::filesystem::remove(path);
+        std::filesystem::create_symlink(entry.link_target, path);
+        symlinks_.insert(key);
+        break;
+
+      case tar::Entry::Type::kFile:
+        std::filesystem::create_directories(path.parent_path());
+        file_ = std::make_shared<OutputFile>(path, entry.mode);
+        file_->Preallocate(entry.size);
+        offset_ = 0;
+        break;
+
+      case tar::Entry::Type::kOther:
+        /* The daemon only sends files, directories and symlinks. */
+        break;
+    }
+  }
+
+  void Data(std::string_view data) override {
+    if (!file_) {
+      return;
+    }
+
+    while (!data.empty()) {
+      const size_t n = std::min(kChunkSize - chunk_.size(), data.size());
+      chunk_.append(data.substr(0, n));
+      data.remove_prefix(n);
+      if (chunk_.size() == kChunkSize) {
+        Submit();
+      }
+    }
+  }
+
+  void End() override {
+    if (file_) {
+      Submit();
+      file_.reset();
+    }
+  }
+
+  /** Wait for all the pending writes to complete.
+   * @throw std::exception the first error of any writer */
+  void Finish() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      drained_.wait(lock, [this]() { return failed_ || busy_ == 0; });
+    }
+    Stop();
+    ThrowIfFailed();
+  }
+
+ private:
+  /** Size of the pieces handed to the writers. */
+  static constexpr size_t kChunkSize = 1024 * 1024;
+
+  /** Maximum number of pieces waiting for a writer, whatever their size,
+   * which also bounds the number of files open at once. */
+  static constexpr size_t kMaxJobs = 256;
+
+  /** A piece of a file to write. */
+  struct Job {
+    std::shared_ptr<OutputFile> file;
+    uint64_t offset;
+    std::string data;
+  };
+
+  /** Get where to extract an entry.
+   * @throw std::runtime_error if the entry would end up outside of the
+   * destination */
+  std::filesystem::path Resolve(
+      /** [in] Path of the entry in the archive. */
+      const std::string& entry_path,
+      /** [out] Path of the entry without its empty and "." components, as
+       * recorded in `symlinks_`. */
+      std::string* key) const {
+    if (entry_path.empty() || entry_path.front() == '/') {
+      throw std::runtime_error("Refusing to extract \"" + entry_path +
+                               "\": not a relative path");
+    }
+
+    std::filesystem::path path = destination_;
+    key->clear();
+    for (size_t begin = 0; begin <= entry_path.size();) {
+      size_t end = entry_path.find('/', begin);
+      if (end == entry_path.npos) {
+        end = entry_path.size();
+      }
+      const std::string_view component(entry_path.data() + begin,
+                                       end - begin);
+      if (component == "..") {
+        throw std::runtime_error("Refusing to extract \"" + entry_path +
+                                 "\": path escapes the destination");
+      }
+      if (!component.empty() && component != ".") {
+        /* Writing below a symbolic link of the archive could write anywhere
+        on the file system. */
+        if (!key->empty() && symlinks_.count(*key) > 0) {
+          throw std::runtime_error("Refusing to extract \"" + entry_path +
+                                   "\": path goes through a symbolic link");
+        }
+        if (!key->empty()) {
+          key->push_back('/');
+        }
+        key->append(component);
+        path /= std::u8string(component.begin(), component.end());
+      }
+      begin = end + 1;
+    }
+    return path;
+  }
+
+  /** Hand the buffered piece of the current file to the writers, waiting for
+   * room in the queue if needed. */
+  void Submit() {
+    if (chunk_.empty()) {
+      return;
+    }
+
+    const size_t size = chunk_.size();
+    Job job{file_, offset_, std::move(chunk_)};
+    offset_ += size;
+    chunk_.clear();
+    chunk_.reserve(kChunkSize);
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      room_.wait(lock, [this, size]() {
+        return failed_ || (queue_.size() < kMaxJobs &&
+                           (buffered_ == 0 ||
+                            buffered_ + size <= options_.max_buffered));
+      });
+      if (failed_) {
+        std::rethrow_exception(error_);
+      }
+      buffered_ += size;
+      ++busy_;
+      queue_.push_back(std::move(job));
+    }
+    ready_.notify_one();
+  }
+
+  /** Main loop of a writer. */
+  void Work() {
+    for (;;) {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        job = std::move(queue_.front());
+        queue_.pop_front();
+      }
+
+      std::exception_ptr error;
+      try {
+        job.file->Write(job.offset, job.data);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      const size_t size = job.data.size();
+      /* Close the file, if this was its last piece, outside of the lock. */
+      job = Job();
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffered_ -= size;
+        --busy_;
+        if (error && !failed_) {
+          failed_ = true;
+          error_ = error;
+          /* Nothing else will be written: drop the queued pieces. */
+          for (const auto& queued : queue_) {
+            buffered_ -= queued.data.size();
+            --busy_;
+          }
+          queue_.clear();
+        }
+      }
+      room_.notify_all();
+      drained_.notify_all();
+    }
+  }
+
+  /** Stop the writers once the queue is empty, and wait for them. */
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+      if (failed_) {
+        queue_.clear();
+      }
+    }
+    ready_.notify_all();
+    for (auto& writer : writers_) {
+      if (writer.joinable()) {
+        writer.join();
+      }
+    }
+  }
+
+  void ThrowIfFailed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+  const std::filesystem::path destination_;
+  const GetOptions& options_;
+
+  /** The file being received, if any. */
+  std::shared_ptr<OutputFile> file_;
+
+  /** Offset of `chunk_` in `file_`. */
+  uint64_t offset_ = 0;
+
+  /** Contents of `file_` not yet handed to the writers. */
+  std::string chunk_;
+
+  /** Paths, in the archive and without empty or "." components, of the
+   * symbolic links extracted so far. */
+  std::unordered_set<std::string> symlinks_;
+
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::condition_variable room_;
+  std::condition_variable drained_;
+  std::deque<Job> queue_;
+
+  /** Bytes of the pieces queued or being written. */
+  size_t buffered_ = 0;
+
+  /** Number of pieces queued or being written. */
+  size_t busy_ = 0;
+
+  bool stopping_ = false;
+  bool failed_ = false;
+  std::exception_ptr error_;
+
+  std::vector<std::thread> writers_;
+};
+
+} /* namespace */
+
+void Client::Get(const std::string& path, const std::string& destination,
+                 const GetOptions& options) {
+  if (options.writers == 0) {
+    throw std::invalid_argument("Get(): writers must be positive");
+  }
+
+  Extractor extractor(destination, options);
+  tar::Parser parser(&extractor);
+
+  FetchChunks(MakeUrl("get", {{"arg", path}}), {},
+              [&parser](std::string_view chunk) { parser.Feed(chunk); });
+
+  parser.Finish();
+  extractor.Finish();
+}
+
+} /* namespace ipfs */
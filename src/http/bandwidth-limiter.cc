@@ -0,0 +1,131 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/http/bandwidth-limiter.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace ipfs {
+
+namespace http {
+
+namespace {
+
+/** Narrow a limit down to a share of another one.
+ * @return the smallest of the two, 0 meaning no limit */
+uint64_t Narrow(uint64_t limit, uint64_t total, size_t transfers) {
+  if (total == 0) {
+    return limit;
+  }
+  const uint64_t share =
+      std::max<uint64_t>(1, total / std::max<size_t>(1, transfers));
+  return limit == 0 ? share : std::min(limit, share);
+}
+
+} /* namespace */
+
+BandwidthLimiter::Transfer::Transfer(Transfer&& other) noexcept
+    : limiter_(other.limiter_), sends_(other.sends_) {
+  other.limiter_ = nullptr;
+}
+
+BandwidthLimiter::Transfer& BandwidthLimiter::Transfer::operator=(
+    Transfer&& other) noexcept {
+  if (this != &other) {
+    if (limiter_ != nullptr) {
+      limiter_->Release(sends_);
+    }
+    limiter_ = other.limiter_;
+    sends_ = other.sends_;
+    other.limiter_ = nullptr;
+  }
+  return *this;
+}
+
+BandwidthLimiter::Transfer::~Transfer() {
+  if (limiter_ != nullptr) {
+    limiter_->Release(sends_);
+  }
+}
+
+BandwidthLimits BandwidthLimiter::Transfer::Share() const {
+  BandwidthLimits share;
+  for (const BandwidthLimiter* limiter = limiter_; limiter != nullptr;
+       limiter = limiter->parent_.get()) {
+    share.send_bytes_per_second =
+        Narrow(share.send_bytes_per_second, limiter->send_bytes_per_second_,
+               limiter->sending_);
+    share.recv_bytes_per_second =
+        Narrow(share.recv_bytes_per_second, limiter->recv_bytes_per_second_,
+               limiter->transfers_);
+  }
+  return share;
+}
+
+BandwidthLimiter::BandwidthLimiter(const BandwidthLimits& limits,
+                                   std::shared_ptr<BandwidthLimiter> parent)
+    : send_bytes_per_second_(limits.send_bytes_per_second),
+      recv_bytes_per_second_(limits.recv_bytes_per_second),
+      parent_(std::move(parent)) {}
+
+std::shared_ptr<BandwidthLimiter> BandwidthLimiter::Global() {
+  static const std::shared_ptr<BandwidthLimiter> global =
+      std::make_shared<BandwidthLimiter>(BandwidthLimits(), nullptr);
+  return global;
+}
+
+void BandwidthLimiter::SetLimits(const BandwidthLimits& limits) {
+  send_bytes_per_second_ = limits.send_bytes_per_second;
+  recv_bytes_per_second_ = limits.recv_bytes_per_second;
+}
+
+BandwidthLimits BandwidthLimiter::Limits() const {
+  return BandwidthLimits{send_bytes_per_second_, recv_bytes_per_second_};
+}
+
+BandwidthLimiter::Transfer BandwidthLimiter::Start(bool sends) {
+  for (BandwidthLimiter* limiter = this; limiter != nullptr;
+       limiter = limiter->parent_.get()) {
+    ++limiter->transfers_;
+    if (sends) {
+      ++limiter->sending_;
+    }
+  }
+  return Transfer(this, sends);
+}
+
+size_t BandwidthLimiter::Transfers() const { return transfers_; }
+
+size_t BandwidthLimiter::Sending() const { return sending_; }
+
+void BandwidthLimiter::Release(bool sends) {
+  for (BandwidthLimiter* limiter = this; limiter != nullptr;
+       limiter = limiter->parent_.get()) {
+    --limiter->transfers_;
+    if (sends) {
+      --limiter->sending_;
+    }
+  }
+}
+
+} /* namespace http */
+} /* namespace ipfs */
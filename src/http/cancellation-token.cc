@@ -0,0 +1,84 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/http/cancellation-token.h>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+namespace ipfs {
+
+namespace http {
+
+CancellationToken::Registration::Registration(Registration&& other) noexcept
+    : token_(other.token_), id_(other.id_) {
+  other.token_ = nullptr;
+}
+
+CancellationToken::Registration& CancellationToken::Registration::operator=(
+    Registration&& other) noexcept {
+  if (this != &other) {
+    if (token_ != nullptr) {
+      token_->Unregister(id_);
+    }
+    token_ = other.token_;
+    id_ = other.id_;
+    other.token_ = nullptr;
+  }
+  return *this;
+}
+
+CancellationToken::Registration::~Registration() {
+  if (token_ != nullptr) {
+    token_->Unregister(id_);
+  }
+}
+
+void CancellationToken::Cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cancelled_.exchange(true)) {
+    return;
+  }
+  for (const auto& callback : callbacks_) {
+    callback.second();
+  }
+}
+
+bool CancellationToken::IsCancelled() const { return cancelled_; }
+
+CancellationToken::Registration CancellationToken::Register(
+    std::function<void()> callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cancelled_) {
+    callback();
+  }
+  const uint64_t id = next_id_++;
+  callbacks_.emplace(id, std::move(callback));
+  return Registration(this, id);
+}
+
+void CancellationToken::Unregister(uint64_t id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callbacks_.erase(id);
+}
+
+} /* namespace http */
+} /* namespace ipfs */
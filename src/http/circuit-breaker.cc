@@ -0,0 +1,173 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/http/circuit-breaker.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace ipfs {
+
+namespace http {
+
+CircuitBreaker::CircuitBreaker(const CircuitBreakerOptions& options)
+    : options_(options) {
+  if (options_.window == 0) {
+    throw std::invalid_argument("CircuitBreaker(): window must be positive");
+  }
+  if (!(options_.failure_rate > 0 && options_.failure_rate <= 1)) {
+    throw std::invalid_argument(
+        "CircuitBreaker(): failure_rate must be in (0, 1]");
+  }
+  if (options_.half_open_calls == 0) {
+    throw std::invalid_argument(
+        "CircuitBreaker(): half_open_calls must be positive");
+  }
+  window_.reserve(options_.window);
+}
+
+std::shared_ptr<CircuitBreaker> CircuitBreaker::Shared(
+    const std::string& url_prefix, const CircuitBreakerOptions& options) {
+  static std::mutex mutex;
+  static std::map<std::string, std::weak_ptr<CircuitBreaker>> breakers;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<CircuitBreaker> breaker = breakers[url_prefix].lock();
+  if (!breaker) {
+    breaker = std::make_shared<CircuitBreaker>(options);
+    breakers[url_prefix] = breaker;
+  }
+  return breaker;
+}
+
+bool CircuitBreaker::Admit() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto now = std::chrono::steady_clock::now();
+
+  if (state_ == State::kOpen && now - opened_at_ >= options_.open_duration) {
+    state_ = State::kHalfOpen;
+    trials_ = 0;
+    trial_successes_ = 0;
+  }
+
+  switch (state_) {
+    case State::kClosed:
+      return false;
+    case State::kHalfOpen:
+      if (trials_ < options_.half_open_calls) {
+        ++trials_;
+        return true;
+      }
+      break;
+    case State::kOpen:
+      break;
+  }
+
+  ++rejected_;
+  throw CircuitOpenError("Circuit breaker open, the peer is failing");
+}
+
+void CircuitBreaker::Record(bool trial, Outcome outcome,
+                            std::chrono::microseconds first_byte) {
+  if (outcome == Outcome::kSuccess && options_.slow_call.count() > 0 &&
+      first_byte > options_.slow_call) {
+    outcome = Outcome::kFailure;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto now = std::chrono::steady_clock::now();
+
+  if (trial) {
+    /* Trials of an older half-open state are not counted. */
+    if (state_ != State::kHalfOpen) {
+      return;
+    }
+    switch (outcome) {
+      case Outcome::kSuccess:
+        if (++trial_successes_ == options_.half_open_calls) {
+          state_ = State::kClosed;
+          window_.clear();
+          next_ = 0;
+          failures_ = 0;
+        }
+        break;
+      case Outcome::kFailure:
+        Open(now);
+        break;
+      case Outcome::kUnknown:
+        --trials_;
+        break;
+    }
+    return;
+  }
+
+  /* Calls admitted before the breaker opened are not counted. */
+  if (state_ != State::kClosed || outcome == Outcome::kUnknown) {
+    return;
+  }
+
+  const bool failed = outcome == Outcome::kFailure;
+  if (window_.size() < options_.window) {
+    window_.push_back(failed);
+  } else {
+    failures_ -= window_[next_];
+    window_[next_] = failed;
+    next_ = (next_ + 1) % options_.window;
+  }
+  failures_ += failed;
+
+  if (window_.size() >= std::min(options_.minimum_calls, options_.window) &&
+      failures_ >= options_.failure_rate * window_.size()) {
+    Open(now);
+  }
+}
+
+bool CircuitBreaker::IsFailureStatus(long status) const {
+  return std::find(options_.failure_statuses.begin(),
+                   options_.failure_statuses.end(),
+                   status) != options_.failure_statuses.end();
+}
+
+CircuitBreaker::State CircuitBreaker::GetState() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (state_ == State::kOpen &&
+      std::chrono::steady_clock::now() - opened_at_ >=
+          options_.open_duration) {
+    return State::kHalfOpen;
+  }
+  return state_;
+}
+
+uint64_t CircuitBreaker::Rejected() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return rejected_;
+}
+
+void CircuitBreaker::Open(std::chrono::steady_clock::time_point now) {
+  state_ = State::kOpen;
+  opened_at_ = now;
+}
+
+} /* namespace http */
+} /* namespace ipfs */
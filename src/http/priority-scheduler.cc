@@ -0,0 +1,210 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/http/priority-scheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace ipfs {
+
+namespace http {
+
+namespace {
+
+/** Longest wait between two calls of the `keep_waiting` callback. */
+constexpr std::chrono::milliseconds kPollInterval{40};
+
+} /* namespace */
+
+PriorityScheduler::Ticket& PriorityScheduler::Ticket::operator=(
+    Ticket&& other) noexcept {
+  if (this != &other) {
+    if (entry_) {
+      scheduler_->Release(entry_);
+    }
+    scheduler_ = other.scheduler_;
+    entry_ = std::move(other.entry_);
+  }
+  return *this;
+}
+
+PriorityScheduler::Ticket::~Ticket() {
+  if (entry_) {
+    scheduler_->Release(entry_);
+  }
+}
+
+PriorityScheduler::PriorityScheduler(const PrioritySchedulerOptions& options)
+    : options_(options) {
+  if (options_.slots == 0) {
+    throw std::invalid_argument("PriorityScheduler(): no slots");
+  }
+  for (const unsigned weight : options_.weights) {
+    if (weight == 0) {
+      throw std::invalid_argument("PriorityScheduler(): weight of 0");
+    }
+  }
+}
+
+PriorityScheduler::Ticket PriorityScheduler::Acquire(
+    Priority priority, std::function<void()> wake,
+    const std::function<bool()>& keep_waiting) {
+  const size_t index = static_cast<size_t>(priority);
+  Queue& queue = queues_[index];
+
+  auto entry = std::make_shared<Entry>();
+  entry->priority = priority;
+  entry->wake = std::move(wake);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto arrived = std::chrono::steady_clock::now();
+
+  /* A priority that waited for nothing gets no credit for it. */
+  if (queue.waiting.empty()) {
+    queue.pass = std::max(queue.pass, virtual_time_);
+  }
+  queue.waiting.push_back(entry.get());
+  ++queue.stats.queued;
+
+  bool woken = false;
+  for (;;) {
+    if (active_ < options_.slots && NextQueue() == index &&
+        queue.waiting.front() == entry.get()) {
+      break;
+    }
+
+    /* Make the lower priorities see that they should pause. */
+    if (options_.pause_lower && !woken) {
+      for (const auto& other : running_) {
+        if (other->priority > priority && !other->paused && other->wake) {
+          other->wake();
+        }
+      }
+      woken = true;
+    }
+
+    if (keep_waiting && !keep_waiting()) {
+      queue.waiting.erase(
+          std::find(queue.waiting.begin(), queue.waiting.end(), entry.get()));
+      --queue.stats.queued;
+      cv_.notify_all();
+      return Ticket();
+    }
+    cv_.wait_for(lock, kPollInterval);
+  }
+
+  queue.waiting.pop_front();
+  --queue.stats.queued;
+  ++queue.stats.running;
+  ++queue.stats.admitted;
+  queue.stats.total_wait +=
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - arrived);
+
+  virtual_time_ = queue.pass;
+  queue.pass += 1.0 / options_.weights[index];
+  ++active_;
+  running_.push_back(entry);
+  cv_.notify_all();
+
+  return Ticket(this, std::move(entry));
+}
+
+bool PriorityScheduler::ShouldPause(Ticket* ticket) {
+  Entry& entry = *ticket->entry_;
+  Queue& queue = queues_[static_cast<size_t>(entry.priority)];
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto now = std::chrono::steady_clock::now();
+
+  if (entry.paused) {
+    const bool expired = now - entry.paused_at >= options_.max_pause;
+    if (expired ||
+        (active_ < options_.slots && !HigherWaiting(entry.priority))) {
+      entry.paused = false;
+      if (expired) {
+        entry.exempt_until = now + options_.max_pause;
+      }
+      ++active_;
+      --queue.stats.paused;
+      ++queue.stats.running;
+    }
+    return entry.paused;
+  }
+
+  if (options_.pause_lower && now >= entry.exempt_until &&
+      active_ >= options_.slots && HigherWaiting(entry.priority)) {
+    entry.paused = true;
+    entry.paused_at = now;
+    --active_;
+    --queue.stats.running;
+    ++queue.stats.paused;
+    ++queue.stats.pauses;
+    cv_.notify_all();
+  }
+  return entry.paused;
+}
+
+PrioritySchedulerStats PriorityScheduler::Stats(Priority priority) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queues_[static_cast<size_t>(priority)].stats;
+}
+
+bool PriorityScheduler::HigherWaiting(Priority priority) const {
+  for (size_t i = 0; i < static_cast<size_t>(priority); ++i) {
+    if (!queues_[i].waiting.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t PriorityScheduler::NextQueue() const {
+  size_t next = queues_.size();
+  double pass = std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < queues_.size(); ++i) {
+    if (!queues_[i].waiting.empty() && queues_[i].pass < pass) {
+      next = i;
+      pass = queues_[i].pass;
+    }
+  }
+  return next;
+}
+
+void PriorityScheduler::Release(const std::shared_ptr<Entry>& entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Queue& queue = queues_[static_cast<size_t>(entry->priority)];
+  if (entry->paused) {
+    --queue.stats.paused;
+  } else {
+    --active_;
+    --queue.stats.running;
+  }
+  running_.remove(entry);
+  cv_.notify_all();
+}
+
+} /* namespace http */
+} /* namespace ipfs */
@@ -0,0 +1,216 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/http/rate-limiter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ipfs {
+
+namespace http {
+
+namespace {
+
+/** Longest wait between two calls of the `keep_waiting` callback. */
+constexpr std::chrono::milliseconds kPollInterval{40};
+
+/** Commands that store or change data. */
+constexpr std::string_view kWriteCommands[] = {
+    "add",          "block/put",    "block/rm",      "config/replace",
+    "dag/import",   "dag/put",      "files/chcid",   "files/cp",
+    "files/flush",  "files/mkdir",  "files/mv",      "files/rm",
+    "files/write",  "key/gen",      "key/import",    "key/rename",
+    "key/rm",       "object/new",   "object/patch",  "object/put",
+    "repo/gc",
+};
+
+/** Check whether a command is a given one or one of its subcommands.
+ * @return true if it is */
+bool IsCommand(std::string_view command, std::string_view name) {
+  return command.compare(0, name.size(), name) == 0 &&
+         (command.size() == name.size() || command[name.size()] == '/');
+}
+
+} /* namespace */
+
+RateLimiter::Permit::Permit(Permit&& other) noexcept
+    : limiter_(other.limiter_), class_(other.class_) {
+  other.limiter_ = nullptr;
+}
+
+RateLimiter::Permit& RateLimiter::Permit::operator=(Permit&& other) noexcept {
+  if (this != &other) {
+    if (limiter_ != nullptr) {
+      limiter_->Release(class_);
+    }
+    limiter_ = other.limiter_;
+    class_ = other.class_;
+    other.limiter_ = nullptr;
+  }
+  return *this;
+}
+
+RateLimiter::Permit::~Permit() {
+  if (limiter_ != nullptr) {
+    limiter_->Release(class_);
+  }
+}
+
+RateLimiter::RateLimiter(const RateLimiterOptions& options) {
+  const RateLimit* limits[] = {&options.reads, &options.writes, &options.dht,
+                               &options.pins};
+  const auto now = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    if (limits[i]->requests_per_second < 0 || limits[i]->burst < 1 ||
+        limits[i]->max_wait.count() < 0) {
+      throw std::invalid_argument("RateLimiter(): limit out of range");
+    }
+    buckets_[i].limit = *limits[i];
+    buckets_[i].tokens = limits[i]->burst;
+    buckets_[i].refilled = now;
+  }
+}
+
+RequestClass RateLimiter::Classify(std::string_view url) {
+  static constexpr std::string_view kApi = "/api/v0/";
+  const size_t start = url.find(kApi);
+  if (start == std::string_view::npos) {
+    return RequestClass::kRead;
+  }
+  std::string_view command = url.substr(start + kApi.size());
+  command = command.substr(0, command.find('?'));
+
+  if (IsCommand(command, "dht") || IsCommand(command, "routing") ||
+      IsCommand(command, "name")) {
+    return RequestClass::kDht;
+  }
+  if (IsCommand(command, "pin")) {
+    return RequestClass::kPin;
+  }
+  for (const auto& write : kWriteCommands) {
+    if (IsCommand(command, write)) {
+      return RequestClass::kWrite;
+    }
+  }
+  return RequestClass::kRead;
+}
+
+RateLimiter::Permit RateLimiter::Acquire(
+    RequestClass request_class, const std::function<bool()>& keep_waiting) {
+  Bucket& bucket = buckets_[static_cast<size_t>(request_class)];
+  const RateLimit& limit = bucket.limit;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto arrived = std::chrono::steady_clock::now();
+  const auto deadline = arrived + limit.max_wait;
+
+  const uint64_t ticket = next_ticket_++;
+  bucket.queue.push_back(ticket);
+  ++bucket.stats.queued;
+
+  /* Leave the queue, letting the next request try its turn. */
+  const auto leave = [this, &bucket, ticket]() {
+    bucket.queue.erase(
+        std::find(bucket.queue.begin(), bucket.queue.end(), ticket));
+    --bucket.stats.queued;
+    cv_.notify_all();
+  };
+
+  for (;;) {
+    const auto now = std::chrono::steady_clock::now();
+    auto wake = now + kPollInterval;
+
+    if (bucket.queue.front() == ticket) {
+      if (limit.requests_per_second > 0) {
+        const std::chrono::duration<double> elapsed = now - bucket.refilled;
+        bucket.tokens = std::min(
+            limit.burst,
+            bucket.tokens + elapsed.count() * limit.requests_per_second);
+        bucket.refilled = now;
+      }
+
+      const bool slot = limit.max_in_flight == 0 ||
+                        bucket.stats.in_flight < limit.max_in_flight;
+      const bool token = limit.requests_per_second == 0 || bucket.tokens >= 1;
+      if (slot && token) {
+        if (limit.requests_per_second > 0) {
+          bucket.tokens -= 1;
+        }
+        leave();
+        ++bucket.stats.in_flight;
+        ++bucket.stats.admitted;
+        const auto waited =
+            std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                                  arrived);
+        bucket.stats.total_wait += waited;
+        bucket.stats.max_wait = std::max(bucket.stats.max_wait, waited);
+        return Permit(this, request_class);
+      }
+
+      if (slot) {
+        /* Sleep until the next token. */
+        const std::chrono::duration<double> until_token(
+            (1 - bucket.tokens) / limit.requests_per_second);
+        wake = std::min(
+            wake, now + std::chrono::duration_cast<
+                            std::chrono::steady_clock::duration>(until_token));
+      }
+    }
+
+    /* This request is waiting too, if it gets here. */
+    const bool full = bucket.stats.queued > limit.max_queued;
+    if (full || (limit.max_wait.count() > 0 && now >= deadline)) {
+      leave();
+      ++bucket.stats.rejected;
+      throw RateLimitError(full ? "Rate limiter queue full"
+                                : "Rate limiter wait too long");
+    }
+
+    if (keep_waiting && !keep_waiting()) {
+      leave();
+      return Permit();
+    }
+
+    if (limit.max_wait.count() > 0) {
+      wake = std::min(wake, deadline);
+    }
+    cv_.wait_until(lock, wake);
+  }
+}
+
+RateLimiterStats RateLimiter::Stats(RequestClass request_class) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return buckets_[static_cast<size_t>(request_class)].stats;
+}
+
+void RateLimiter::Release(RequestClass request_class) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  --buckets_[static_cast<size_t>(request_class)].stats.in_flight;
+  cv_.notify_all();
+}
+
+} /* namespace http */
+} /* namespace ipfs */
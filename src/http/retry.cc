@@ -0,0 +1,109 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/http/retry.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+
+namespace ipfs {
+
+namespace http {
+
+RetryBudget::RetryBudget(double ratio, unsigned reserve)
+    : ratio_(ratio), reserve_(reserve), balance_(reserve) {
+  if (ratio < 0) {
+    throw std::invalid_argument("RetryBudget(): negative ratio");
+  }
+}
+
+std::shared_ptr<RetryBudget> RetryBudget::Global() {
+  static const std::shared_ptr<RetryBudget> global =
+      std::make_shared<RetryBudget>();
+  return global;
+}
+
+void RetryBudget::Deposit() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  balance_ = std::min(reserve_, balance_ + ratio_);
+}
+
+bool RetryBudget::Withdraw() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (balance_ < 1) {
+    ++refused_;
+    return false;
+  }
+  balance_ -= 1;
+  ++retries_;
+  return true;
+}
+
+double RetryBudget::Balance() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return balance_;
+}
+
+uint64_t RetryBudget::Retries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return retries_;
+}
+
+uint64_t RetryBudget::Refused() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return refused_;
+}
+
+bool RetryPolicy::IsIdempotent(std::string_view url) const {
+  std::string_view path = url.substr(0, url.find('?'));
+  for (const auto& command : idempotent_commands) {
+    if (path.size() > command.size() &&
+        path.compare(path.size() - command.size(), command.size(), command) ==
+            0 &&
+        path[path.size() - command.size() - 1] == '/') {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::chrono::milliseconds RetryPolicy::Backoff(unsigned retry) const {
+  /* Double the bound for each retry, without overflowing. */
+  std::chrono::milliseconds bound = base_backoff;
+  for (unsigned i = 1; i < retry && bound < max_backoff; ++i) {
+    bound *= 2;
+  }
+  bound = std::min(bound, max_backoff);
+  if (bound.count() <= 0) {
+    return std::chrono::milliseconds(0);
+  }
+
+  thread_local std::mt19937_64 random(std::random_device{}());
+  std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter(
+      0, bound.count());
+  return std::chrono::milliseconds(jitter(random));
+}
+
+} /* namespace http */
+} /* namespace ipfs */
@@ -21,6 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 #include <ipfs/http/transport-curl.h>
 #include <ipfs/test/utils.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -44,6 +49,22 @@ std::string replace_body;
  * @return true if 2xx HTTP status code */
 inline bool status_is_success(long code) { return code >= 200 && code <= 299; }
 
+/** Where `curl_cb_stream()` writes a response body. */
+struct ResponseSink {
+  /** The cURL easy handle of the transfer. */
+  CURL* curl;
+
+  /** Stream for the body of successful responses. */
+  std::iostream* response;
+
+  /** Body of an error response, kept apart so that it does not end up in
+   * `response` among the results. */
+  std::string error_body;
+
+  /** Number of bytes written to `response`. */
+  uint64_t written = 0;
+};
+
 /** CURL callback for writing the result to a stream. */
 static size_t curl_cb_stream(
     /** [in] Pointer to the result. */
@@ -52,18 +73,49 @@ static size_t curl_cb_stream(
     size_t size,
     /** [in] Number of chunks in the result. */
     size_t nmemb,
-    /** [out] Response (a pointer to `std::iostream`). */
-    void* response_void) {
-  std::iostream* response = static_cast<std::iostream*>(response_void);
+    /** [out] Response (a pointer to `ResponseSink`). */
+    void* sink_void) {
+  ResponseSink* sink = static_cast<ResponseSink*>(sink_void);
 
   const size_t n = size * nmemb;
   if (static_cast<std::streamsize>(n) < 0) {
-    throw std::runtime_error("Buffer Size overflowing");
-  } else {
-    response->write(ptr, static_cast<std::streamsize>(n));
+    return 0;
+  }
+
+  /* The status line has been received before any of the body. */
+  long status_code = 0;
+  curl_easy_getinfo(sink->curl, CURLINFO_RESPONSE_CODE, &status_code);
+  if (!status_is_success(status_code)) {
+    sink->error_body.append(ptr, n);
+    return n;
   }
 
-  return n;
+  sink->response->write(ptr, static_cast<std::streamsize>(n));
+  sink->written += n;
+
+  /* Returning less than `n` aborts the transfer, for example if the stream is
+   * a consumer that gave up. */
+  return *sink->response ? n : 0;
+}
+
+/** CURL callback for reading an upload from a stream. */
+static size_t curl_cb_read_stream(
+    /** [out] Buffer to fill. */
+    char* buffer,
+    /** [in] Size of each item of the buffer. */
+    size_t size,
+    /** [in] Number of items in the buffer. */
+    size_t nitems,
+    /** [in,out] Data to upload (a pointer to `std::istream`). */
+    void* stream_void) {
+  std::istream* stream = static_cast<std::istream*>(stream_void);
+
+  stream->read(buffer, static_cast<std::streamsize>(size * nitems));
+  if (stream->bad() || (stream->fail() && !stream->eof())) {
+    return CURL_READFUNC_ABORT;
+  }
+
+  return static_cast<size_t>(stream->gcount());
 }
 
 void TransportCurl::InitCurl() {
@@ -112,18 +164,36 @@ void TransportCurl::InitCurl() {
 
 TransportCurl::TransportCurl(bool curlVerbose)
     : keep_perform_running_(true), curl_verbose_(curlVerbose) {
+  retry_policy_.max_attempts = 1;
   InitCurl();
 }
 
 TransportCurl::TransportCurl(const TransportCurl& other)
-    : keep_perform_running_(true), curl_verbose_(other.curl_verbose_) {
+    : keep_perform_running_(true),
+      curl_verbose_(other.curl_verbose_),
+      retry_policy_(other.retry_policy_),
+      circuit_breaker_(other.circuit_breaker_),
+      rate_limiter_(other.rate_limiter_),
+      scheduler_(other.scheduler_),
+      priority_(other.priority_),
+      bandwidth_limiter_(other.bandwidth_limiter_),
+      deadline_(other.deadline_),
+      cancellation_token_(other.cancellation_token_) {
   InitCurl();
 }
 
 TransportCurl::TransportCurl(TransportCurl&& other) noexcept
     : keep_perform_running_(true),
       global_init_result_(other.global_init_result_),
-      curl_verbose_(other.curl_verbose_) {
+      curl_verbose_(other.curl_verbose_),
+      retry_policy_(std::move(other.retry_policy_)),
+      circuit_breaker_(std::move(other.circuit_breaker_)),
+      rate_limiter_(std::move(other.rate_limiter_)),
+      scheduler_(std::move(other.scheduler_)),
+      priority_(other.priority_),
+      bandwidth_limiter_(std::move(other.bandwidth_limiter_)),
+      deadline_(other.deadline_),
+      cancellation_token_(std::move(other.cancellation_token_)) {
   multi_handle_ = other.multi_handle_;
   curl_ = other.curl_;
   other.multi_handle_ = nullptr;
@@ -136,6 +206,14 @@ TransportCurl& TransportCurl::operator=(const TransportCurl& other) {
   }
   keep_perform_running_ = true;
   curl_verbose_ = other.curl_verbose_;
+  retry_policy_ = other.retry_policy_;
+  circuit_breaker_ = other.circuit_breaker_;
+  rate_limiter_ = other.rate_limiter_;
+  scheduler_ = other.scheduler_;
+  priority_ = other.priority_;
+  bandwidth_limiter_ = other.bandwidth_limiter_;
+  deadline_ = other.deadline_;
+  cancellation_token_ = other.cancellation_token_;
   InitCurl();
   return *this;
 }
@@ -147,6 +225,14 @@ TransportCurl& TransportCurl::operator=(TransportCurl&& other) noexcept {
   keep_perform_running_ = true;
   global_init_result_ = other.global_init_result_;
   curl_verbose_ = other.curl_verbose_;
+  retry_policy_ = std::move(other.retry_policy_);
+  circuit_breaker_ = std::move(other.circuit_breaker_);
+  rate_limiter_ = std::move(other.rate_limiter_);
+  scheduler_ = std::move(other.scheduler_);
+  priority_ = other.priority_;
+  bandwidth_limiter_ = std::move(other.bandwidth_limiter_);
+  deadline_ = other.deadline_;
+  cancellation_token_ = std::move(other.cancellation_token_);
   multi_handle_ = other.multi_handle_;
   curl_ = other.curl_;
   other.multi_handle_ = nullptr;
@@ -174,6 +260,8 @@ void TransportCurl::Fetch(const std::string& url,
   curl_easy_setopt(curl_, CURLOPT_POST, 1L);
 
   multipart_ = curl_mime_init(curl_);
+  replayable_ = true;
+  sending_ = !files.empty();
 
   if (multipart_) {
     for (size_t i = 0; i < files.size(); ++i) {
@@ -203,6 +291,32 @@ void TransportCurl::Fetch(const std::string& url,
           // Override filename (instead of using the remote file name)
           curl_mime_filename(part, file.path.c_str());
           curl_mime_type(part, content_type);
+          /* Where the file is on disk, which lets the daemon reference it in
+           * place rather than copy it when adding with "nocopy".
+           * https://curl.se/libcurl/c/curl_mime_headers.html */
+          if (file.data.find_first_of("\r\n") == std::string::npos) {
+            curl_mime_headers(
+                part,
+                curl_slist_append(
+                    NULL, ("Abspath: " +
+                           std::filesystem::absolute(file.data).string())
+                              .c_str()),
+                1);
+          }
+          break;
+        case FileUpload::Type::kStream:
+          /* Add a part.
+           * https://curl.se/libcurl/c/curl_mime_addpart.html */
+          part = curl_mime_addpart(multipart_);
+          curl_mime_name(part, name.c_str());
+          /* Callback source of unknown size:
+           * https://curl.se/libcurl/c/curl_mime_data_cb.html */
+          curl_mime_data_cb(part, -1, curl_cb_read_stream, NULL, NULL,
+                            file.stream);
+          /* The stream cannot be rewound for a retry. */
+          replayable_ = false;
+          curl_mime_filename(part, file.path.c_str());
+          curl_mime_type(part, content_type);
           break;
       }
     }
@@ -236,7 +350,90 @@ void TransportCurl::Fetch(const std::string& url,
   Perform(url, response);
 }
 
-void TransportCurl::StopFetch() { keep_perform_running_ = false; }
+void TransportCurl::FetchStreamingBody(const std::string& url,
+                                       const std::string& content_type,
+                                       std::istream* body,
+                                       std::iostream* response) {
+  /* https://curl.se/libcurl/c/CURLOPT_POST.html */
+  curl_easy_setopt(curl_, CURLOPT_POST, 1L);
+
+  /* No mime structure: the body comes from the read callback.
+   * https://curl.se/libcurl/c/CURLOPT_READFUNCTION.html */
+  multipart_ = nullptr;
+  replayable_ = false;
+  sending_ = true;
+  curl_easy_setopt(curl_, CURLOPT_READFUNCTION, curl_cb_read_stream);
+  curl_easy_setopt(curl_, CURLOPT_READDATA, body);
+
+  curl_slist* headers = NULL;
+  headers = curl_slist_append(headers, "Expect:");
+  headers =
+      curl_slist_append(headers, ("Content-Type: " + content_type).c_str());
+  /* The size of the body is unknown. */
+  headers = curl_slist_append(headers, "Transfer-Encoding: chunked");
+
+  /* Auto free the resources occupied by `headers`. */
+  std::unique_ptr<curl_slist, void (*)(curl_slist*)> headers_deleter(
+      headers, [](curl_slist* d) { curl_slist_free_all(d); });
+
+  /* https://curl.se/libcurl/c/CURLOPT_HTTPHEADER.html */
+  curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers);
+
+#ifndef NDEBUG
+  if (!replace_body.empty()) {
+    *response << replace_body;
+    return;
+  }
+#endif /* NDEBUG */
+
+  Perform(url, response);
+}
+
+void TransportCurl::SetRetryPolicy(const RetryPolicy& policy) {
+  if (policy.max_attempts == 0) {
+    throw std::invalid_argument(
+        "SetRetryPolicy(): max_attempts must be positive");
+  }
+  retry_policy_ = policy;
+}
+
+void TransportCurl::SetCircuitBreaker(
+    std::shared_ptr<CircuitBreaker> breaker) {
+  circuit_breaker_ = std::move(breaker);
+}
+
+void TransportCurl::SetRateLimiter(std::shared_ptr<RateLimiter> limiter) {
+  rate_limiter_ = std::move(limiter);
+}
+
+void TransportCurl::SetScheduler(std::shared_ptr<PriorityScheduler> scheduler,
+                                 Priority priority) {
+  scheduler_ = std::move(scheduler);
+  priority_ = priority;
+}
+
+void TransportCurl::SetBandwidthLimiter(
+    std::shared_ptr<BandwidthLimiter> limiter) {
+  bandwidth_limiter_ = std::move(limiter);
+}
+
+void TransportCurl::SetDeadline(
+    std::chrono::steady_clock::time_point deadline) {
+  deadline_ = deadline;
+}
+
+void TransportCurl::SetCancellationToken(
+    std::shared_ptr<CancellationToken> token) {
+  cancellation_token_ = std::move(token);
+}
+
+void TransportCurl::StopFetch() {
+  keep_perform_running_ = false;
+  /* Do not wait for the poll of `Perform()` to time out. */
+  if (multi_handle_ != nullptr) {
+    curl_multi_wakeup(multi_handle_);
+  }
+}
 
 void TransportCurl::ResetFetch() { keep_perform_running_ = true; }
 
@@ -252,13 +449,13 @@ void TransportCurl::UrlEncode(const std::string& raw, std::string* encoded) {
 }
 
 void TransportCurl::Perform(const std::string& url, std::iostream* response) {
-  int still_running = 0; /* keep number of running handles */
-  CURLMsg* msg;          /* for picking up messages with the transfer status */
-  int msgs_left;         /* how many messages are left */
+  CURLMsg* msg;  /* for picking up messages with the transfer status */
+  int msgs_left; /* how many messages are left */
   char curl_error[CURL_ERROR_SIZE]; /* cURL error message buffer */
   std::string generic_error;
   std::vector<std::string> get_info_errors;
   std::vector<std::string> status_code_errors;
+  std::exception_ptr rejected;
 
   /* https://curl.se/libcurl/c/CURLOPT_URL.html */
   curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
@@ -266,76 +463,293 @@ void TransportCurl::Perform(const std::string& url, std::iostream* response) {
   /* https://curl.se/libcurl/c/CURLOPT_WRITEFUNCTION.html */
   curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, curl_cb_stream);
 
+  ResponseSink sink{curl_, response, std::string()};
+
   /* https://curl.se/libcurl/c/CURLOPT_WRITEDATA.html */
-  curl_easy_setopt(curl_, CURLOPT_WRITEDATA, response);
+  curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &sink);
 
   /* https://curl.se/libcurl/c/CURLOPT_ERRORBUFFER.html */
   curl_easy_setopt(curl_, CURLOPT_ERRORBUFFER, curl_error);
 
-  /* End of string (empty string) */
-  curl_error[0] = '\0';
+  const std::shared_ptr<RetryBudget> budget =
+      retry_policy_.budget ? retry_policy_.budget : RetryBudget::Global();
+  if (retry_policy_.max_attempts > 1) {
+    budget->Deposit();
+  }
 
-  /* Add easy handle to multi stack.
-   * https://curl.se/libcurl/c/curl_multi_add_handle.html */
-  curl_multi_add_handle(multi_handle_, curl_);
+  const RequestClass request_class = RateLimiter::Classify(url);
+  const std::shared_ptr<BandwidthLimiter> bandwidth =
+      bandwidth_limiter_ ? bandwidth_limiter_ : BandwidthLimiter::Global();
+  /* Speed limits of `curl_`, 0 until set. */
+  BandwidthLimits speed;
+
+  /* Stop at once when the token of the request is cancelled. */
+  const std::shared_ptr<CancellationToken> token = cancellation_token_;
+  const CancellationToken::Registration wakeup =
+      token ? token->Register([this]() { curl_multi_wakeup(multi_handle_); })
+            : CancellationToken::Registration();
+  const auto running = [this, &token]() {
+    return keep_perform_running_ && !(token && token->IsCancelled());
+  };
+
+  /* Whether the request failed for running out of time. */
+  bool expired = false;
+  /* Whether the last attempt completed, with or without errors. */
+  bool finished = false;
+  const auto keep_waiting = [this, &running]() {
+    return running() && std::chrono::steady_clock::now() < deadline_;
+  };
+
+  for (unsigned attempt = 1;; ++attempt) {
+    if (attempt > 1) {
+      /* Wait before the retry, once the slots of the previous attempt are
+       * released so that other requests may use them meanwhile.
+       * `StopFetch()` wakes the poll up.
+       * https://curl.se/libcurl/c/curl_multi_poll.html */
+      const auto deadline =
+          std::min(deadline_, std::chrono::steady_clock::now() +
+                                  retry_policy_.Backoff(attempt - 1));
+      while (running()) {
+        const auto left =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+        if (left.count() <= 0) {
+          break;
+        }
+        curl_multi_poll(multi_handle_, NULL, 0,
+                        static_cast<int>(left.count()), NULL);
+      }
+    }
 
-  do {
-    /* https://curl.se/libcurl/c/curl_multi_perform.html */
-    CURLMcode mc = curl_multi_perform(multi_handle_, &still_running);
+    int still_running = 0; /* keep number of running handles */
+    long status_code = 0;
+    CURLcode result = CURLE_OK;
+    finished = false;
+    generic_error.clear();
+    get_info_errors.clear();
+    status_code_errors.clear();
+    sink.error_body.clear();
+
+    /* End of string (empty string) */
+    curl_error[0] = '\0';
+
+    RateLimiter::Permit permit;
+    if (rate_limiter_) {
+      try {
+        permit = rate_limiter_->Acquire(request_class, keep_waiting);
+      } catch (const RateLimitError&) {
+        rejected = std::current_exception();
+        break;
+      }
+      if (!permit) {
+        /* Aborted or out of time while waiting. */
+        expired = running();
+        break;
+      }
+    }
 
-    /* Allow to break/stop the perform task at any given moment.
-     * Very useful if you want to stop this call when running inside a thread.
-     */
-    if (!keep_perform_running_) break;
+    PriorityScheduler::Ticket ticket;
+    bool paused = false;
+    if (scheduler_) {
+      ticket = scheduler_->Acquire(
+          priority_, [this]() { curl_multi_wakeup(multi_handle_); },
+          keep_waiting);
+      if (!ticket) {
+        /* Aborted or out of time while waiting. */
+        expired = running();
+        break;
+      }
+    }
 
-    if (!mc && still_running)
-      /* wait for activity, timeout or "nothing"
-       * https://curl.se/libcurl/c/curl_multi_poll.html */
-      mc = curl_multi_poll(multi_handle_, NULL, 0, 40, NULL);
+    if (deadline_ != std::chrono::steady_clock::time_point::max()) {
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+          deadline_ - std::chrono::steady_clock::now());
+      if (left.count() <= 0) {
+        expired = true;
+        break;
+      }
+      /* https://curl.se/libcurl/c/CURLOPT_TIMEOUT_MS.html */
+      curl_easy_setopt(curl_, CURLOPT_TIMEOUT_MS,
+                       static_cast<long>(left.count()));
+      /* https://curl.se/libcurl/c/CURLOPT_CONNECTTIMEOUT_MS.html */
+      curl_easy_setopt(curl_, CURLOPT_CONNECTTIMEOUT_MS,
+                       static_cast<long>(left.count()));
+    }
 
-    if (mc) {
-      generic_error = std::string(curl_multi_strerror(mc));
-      break;
+    bool trial = false;
+    if (circuit_breaker_) {
+      try {
+        trial = circuit_breaker_->Admit();
+      } catch (const CircuitOpenError&) {
+        rejected = std::current_exception();
+        break;
+      }
     }
 
-  } while (still_running);
-
-  /* Check for HTTP status code, only if there are no generic errors and the
-   * atomic bool is still true */
-  if (generic_error.empty() && keep_perform_running_) {
-    /* Future-proof - by looping over each easy handle; altough we only use one
-     * handle for now. https://curl.se/libcurl/c/curl_multi_info_read.html */
-    while ((msg = curl_multi_info_read(multi_handle_, &msgs_left))) {
-      if (msg->msg == CURLMSG_DONE) {
-        long status_code;
-
-        /* https://curl.se/libcurl/c/curl_easy_getinfo.html */
-        CURLcode res = curl_easy_getinfo(msg->easy_handle,
-                                         CURLINFO_RESPONSE_CODE, &status_code);
-        if (res != CURLE_OK || perform_injected_failure) {
-          get_info_errors.push_back(
-              "Can't get the HTTP status code from CURL: " +
-              std::string(curl_easy_strerror(res)));
+    /* The bandwidth is split between the transfers in progress, so the
+     * speed limits follow as transfers start, end, pause and resume. */
+    BandwidthLimiter::Transfer transfer = bandwidth->Start(sending_);
+
+    /* Add easy handle to multi stack.
+     * https://curl.se/libcurl/c/curl_multi_add_handle.html */
+    curl_multi_add_handle(multi_handle_, curl_);
+
+    /* When the last byte of the request body went out and when the first
+     * byte of the response came in, as far as the loop below can tell. */
+    auto upload_ended = std::chrono::steady_clock::now();
+    auto answered_at = std::chrono::steady_clock::time_point::max();
+    curl_off_t uploaded = 0;
+
+    do {
+      /* The limits of a paused transfer are left as they were. */
+      const BandwidthLimits share = paused ? speed : transfer.Share();
+      if (share.send_bytes_per_second != speed.send_bytes_per_second) {
+        speed.send_bytes_per_second = share.send_bytes_per_second;
+        /* https://curl.se/libcurl/c/CURLOPT_MAX_SEND_SPEED_LARGE.html */
+        curl_easy_setopt(curl_, CURLOPT_MAX_SEND_SPEED_LARGE,
+                         static_cast<curl_off_t>(speed.send_bytes_per_second));
+      }
+      if (share.recv_bytes_per_second != speed.recv_bytes_per_second) {
+        speed.recv_bytes_per_second = share.recv_bytes_per_second;
+        /* https://curl.se/libcurl/c/CURLOPT_MAX_RECV_SPEED_LARGE.html */
+        curl_easy_setopt(curl_, CURLOPT_MAX_RECV_SPEED_LARGE,
+                         static_cast<curl_off_t>(speed.recv_bytes_per_second));
+      }
+
+      /* https://curl.se/libcurl/c/curl_multi_perform.html */
+      CURLMcode mc = curl_multi_perform(multi_handle_, &still_running);
+
+      if (circuit_breaker_ &&
+          answered_at == std::chrono::steady_clock::time_point::max()) {
+        /* https://curl.se/libcurl/c/CURLINFO_SIZE_UPLOAD_T.html */
+        curl_off_t sent = 0;
+        curl_easy_getinfo(curl_, CURLINFO_SIZE_UPLOAD_T, &sent);
+        if (sent > uploaded) {
+          uploaded = sent;
+          upload_ended = std::chrono::steady_clock::now();
+        }
+        /* https://curl.se/libcurl/c/CURLINFO_HEADER_SIZE.html */
+        long header_size = 0;
+        curl_easy_getinfo(curl_, CURLINFO_HEADER_SIZE, &header_size);
+        if (header_size > 0) {
+          answered_at = std::chrono::steady_clock::now();
         }
-        if (!status_is_success(status_code)) {
-          std::streambuf* b = response->rdbuf();
-          status_code_errors.push_back(
-              "HTTP request failed with status code " +
-              std::to_string(status_code) + ". Response body:\n" +
-              /* Read the whole body back from the stream where we wrote it and
-               * append it to this error message string. Usually the bodies of
-               * HTTP error responses represent a short HTML or JSON that
-               * describes the error. */
-              static_cast<const std::stringstream&>(std::stringstream() << b)
-                  .str());
+      }
+
+      /* Allow to break/stop the perform task at any given moment.
+       * Very useful if you want to stop this call when running inside a
+       * thread. */
+      if (!running()) break;
+
+      /* Give way to transfers of a higher priority.
+       * https://curl.se/libcurl/c/curl_easy_pause.html */
+      if (ticket && scheduler_->ShouldPause(&ticket) != paused) {
+        paused = !paused;
+        curl_easy_pause(curl_, paused ? CURLPAUSE_ALL : CURLPAUSE_CONT);
+        /* A paused transfer leaves its share of the bandwidth to the
+         * others. */
+        transfer = paused ? BandwidthLimiter::Transfer()
+                          : bandwidth->Start(sending_);
+      }
+
+      if (!mc && still_running)
+        /* wait for activity, timeout or "nothing"
+         * https://curl.se/libcurl/c/curl_multi_poll.html */
+        mc = curl_multi_poll(multi_handle_, NULL, 0, 40, NULL);
+
+      if (mc) {
+        generic_error = std::string(curl_multi_strerror(mc));
+        break;
+      }
+
+    } while (still_running);
+
+    /* Check for HTTP status code, only if there are no generic errors and
+     * the atomic bool is still true */
+    if (generic_error.empty() && running()) {
+      finished = true;
+      /* Future-proof - by looping over each easy handle; altough we only use
+       * one handle for now.
+       * https://curl.se/libcurl/c/curl_multi_info_read.html */
+      while ((msg = curl_multi_info_read(multi_handle_, &msgs_left))) {
+        if (msg->msg == CURLMSG_DONE) {
+          /* https://curl.se/libcurl/c/curl_easy_getinfo.html */
+          CURLcode res = curl_easy_getinfo(
+              msg->easy_handle, CURLINFO_RESPONSE_CODE, &status_code);
+          if (res != CURLE_OK || perform_injected_failure) {
+            get_info_errors.push_back(
+                "Can't get the HTTP status code from CURL: " +
+                std::string(curl_easy_strerror(res)));
+          }
+          result = msg->data.result;
+          if (status_code != 0 && !status_is_success(status_code)) {
+            status_code_errors.push_back(
+                "HTTP request failed with status code " +
+                std::to_string(status_code) + ". Response body:\n" +
+                /* Usually the bodies of HTTP error responses represent a
+                 * short HTML or JSON that describes the error. */
+                sink.error_body);
+          } else if (result != CURLE_OK) {
+            /* No status was received, or the transfer broke after a
+             * successful one, for example because the connection was lost
+             * or the response stream refused data. */
+            status_code_errors.push_back(
+                "HTTP transfer failed: " +
+                std::string(curl_easy_strerror(result)) +
+                (curl_error[0] != '\0' ? std::string(": ") + curl_error
+                                       : ""));
+          }
         }
       }
     }
-  }
 
-  /* Always execute the curl_multi_remove_handle()!
-   * https://curl.se/libcurl/c/curl_multi_remove_handle.html */
-  curl_multi_remove_handle(multi_handle_, curl_);
+    /* Always execute the curl_multi_remove_handle()!
+     * https://curl.se/libcurl/c/curl_multi_remove_handle.html */
+    curl_multi_remove_handle(multi_handle_, curl_);
+
+    /* Timed out, or cut short by the server-side time-out. */
+    if (deadline_ != std::chrono::steady_clock::time_point::max() &&
+        (result == CURLE_OPERATION_TIMEDOUT ||
+         (!status_code_errors.empty() &&
+          std::chrono::steady_clock::now() >= deadline_))) {
+      expired = true;
+    }
+
+    if (circuit_breaker_) {
+      /* The peer is only slow to answer once it has the whole request: the
+       * time spent uploading does not count. CURLINFO_STARTTRANSFER_TIME_T
+       * can't tell, as some versions of cURL set it when the upload starts.
+       * DHT, pin and write requests take long by nature, so only reads are
+       * held to `slow_call`. */
+      std::chrono::microseconds waited(0);
+      if (request_class == RequestClass::kRead) {
+        waited = std::max(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::min(answered_at, std::chrono::steady_clock::now()) -
+                upload_ended),
+            std::chrono::microseconds(0));
+      }
+
+      CircuitBreaker::Outcome outcome = CircuitBreaker::Outcome::kSuccess;
+      if (!running() || !generic_error.empty() ||
+          result == CURLE_WRITE_ERROR || expired) {
+        /* Aborted, stopped by the response stream, or out of time. */
+        outcome = CircuitBreaker::Outcome::kUnknown;
+      } else if ((status_code == 0 && result != CURLE_OK) ||
+                 circuit_breaker_->IsFailureStatus(status_code)) {
+        outcome = CircuitBreaker::Outcome::kFailure;
+      }
+      circuit_breaker_->Record(trial, outcome, waited);
+    }
+
+    if (!running() || expired || !generic_error.empty() ||
+        !get_info_errors.empty() || status_code_errors.empty() ||
+        attempt >= retry_policy_.max_attempts ||
+        !IsRetryable(url, status_code, result, sink.written) ||
+        !budget->Withdraw()) {
+      break;
+    }
+  }
 
   /*
    * Note: We re-use easy curl handle and multiple handle, so we don't clean it
@@ -351,6 +765,18 @@ void TransportCurl::Perform(const std::string& url, std::iostream* response) {
     curl_mime_free(multipart_);
   }
 
+  if (rejected) {
+    std::rethrow_exception(rejected);
+  }
+
+  if (!finished && token && token->IsCancelled() && keep_perform_running_) {
+    throw CancelledError("Request cancelled");
+  }
+
+  if (expired && keep_perform_running_) {
+    throw DeadlineExceededError("Request deadline exceeded");
+  }
+
   /* If there were errors, throw them now (if atomic bool is still true) */
   if (keep_perform_running_) {
     if (!generic_error.empty()) {
@@ -374,6 +800,39 @@ void TransportCurl::Perform(const std::string& url, std::iostream* response) {
   }
 }
 
+bool TransportCurl::IsRetryable(const std::string& url, long status_code,
+                                CURLcode result, uint64_t written) const {
+  if (!replayable_ || written > 0) {
+    return false;
+  }
+
+  /* The request never reached the peer. */
+  if (status_code == 0 && result == CURLE_COULDNT_CONNECT) {
+    return true;
+  }
+
+  if (!retry_policy_.IsIdempotent(url)) {
+    return false;
+  }
+
+  if (status_code != 0 && !status_is_success(status_code)) {
+    const auto& statuses = retry_policy_.retry_statuses;
+    return std::find(statuses.begin(), statuses.end(), status_code) !=
+           statuses.end();
+  }
+
+  switch (result) {
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_OPERATION_TIMEDOUT:
+      return true;
+    default:
+      return false;
+  }
+}
+
 void TransportCurl::Test() {
   curl_global_injected_failure = true;
   test::must_fail("TransportCurl::TransportCurl()",
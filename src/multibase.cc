@@ -0,0 +1,321 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/multibase.h>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ipfs {
+
+namespace multibase {
+
+/** The Bitcoin base58 alphabet. */
+static const char base58_alphabet[] =
+    "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+/** The RFC 4648 base32 alphabet, lowercase. */
+static const char base32_alphabet[] = "abcdefghijklmnopqrstuvwxyz234567";
+
+/** Value of an invalid character in the decoding tables. */
+static constexpr uint8_t kInvalid = 0xff;
+
+/** Build the table mapping characters to their values in an alphabet. Both
+ * cases map to the same value if `ignore_case` is set. */
+static std::array<uint8_t, 256> MakeDecodingTable(const char* alphabet,
+                                                  bool ignore_case) {
+  std::array<uint8_t, 256> table;
+  table.fill(kInvalid);
+  for (uint8_t i = 0; alphabet[i] != '\0'; ++i) {
+    const unsigned char c = static_cast<unsigned char>(alphabet[i]);
+    table[c] = i;
+    if (ignore_case && c >= 'a' && c <= 'z') {
+      table[c - 'a' + 'A'] = i;
+    }
+  }
+  return table;
+}
+
+static const std::array<uint8_t, 256> base58_values =
+    MakeDecodingTable(base58_alphabet, false);
+
+static const std::array<uint8_t, 256> base32_values =
+    MakeDecodingTable(base32_alphabet, true);
+
+/* Base58 is a positional number system, so converting to and from it is a
+ * big number base conversion, quadratic in the size of the input. Instead of
+ * moving one byte and one digit at a time, the conversions below work on
+ * limbs of 32 bits on the binary side and of 5 digits on the base58 side,
+ * which divides the number of multiplications by 20 while the intermediate
+ * products still fit in 64 bits. */
+
+/** 58^5, the base of the limbs of 5 base58 digits. */
+static constexpr uint64_t kBase58Limb = 58ULL * 58 * 58 * 58 * 58;
+
+std::string EncodeBase58btc(std::string_view bytes) {
+  size_t zeros = 0;
+  while (zeros < bytes.size() && bytes[zeros] == '\0') {
+    ++zeros;
+  }
+
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(bytes.data()) + zeros;
+  size_t n = bytes.size() - zeros;
+
+  /* Little-endian limbs of 5 base58 digits each. log(256) / log(58^5) is
+  about 0.27 limbs per byte. */
+  std::vector<uint32_t> limbs;
+  limbs.reserve(n * 28 / 100 + 2);
+
+  /* The first group takes the odd bytes so that the others have 4. */
+  size_t group = n % 4 == 0 ? 4 : n % 4;
+  while (n > 0) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < group; ++i) {
+      carry = (carry << 8) | p[i];
+    }
+    const unsigned shift = static_cast<unsigned>(8 * group);
+    for (auto& limb : limbs) {
+      const uint64_t t = (static_cast<uint64_t>(limb) << shift) | carry;
+      limb = static_cast<uint32_t>(t % kBase58Limb);
+      carry = t / kBase58Limb;
+    }
+    while (carry != 0) {
+      limbs.push_back(static_cast<uint32_t>(carry % kBase58Limb));
+      carry /= kBase58Limb;
+    }
+    p += group;
+    n -= group;
+    group = 4;
+  }
+
+  std::string text(zeros + limbs.size() * 5, '1');
+  char* out = &text[0] + text.size();
+  for (uint32_t limb : limbs) {
+    for (size_t i = 0; i < 5; ++i) {
+      *--out = base58_alphabet[limb % 58];
+      limb /= 58;
+    }
+  }
+
+  /* The most significant limb may have produced leading zero digits. */
+  size_t leading = 0;
+  while (zeros + leading < text.size() && text[zeros + leading] == '1') {
+    ++leading;
+  }
+  text.erase(zeros, leading);
+  return text;
+}
+
+std::string DecodeBase58btc(std::string_view text) {
+  size_t zeros = 0;
+  while (zeros < text.size() && text[zeros] == '1') {
+    ++zeros;
+  }
+
+  const char* p = text.data() + zeros;
+  size_t n = text.size() - zeros;
+
+  /* Little-endian limbs of 32 bits. log(58) / log(2^32) is about 0.18 limbs
+  per digit. */
+  std::vector<uint32_t> limbs;
+  limbs.reserve(n * 19 / 100 + 2);
+
+  size_t group = n % 5 == 0 ? 5 : n % 5;
+  while (n > 0) {
+    uint64_t carry = 0;
+    uint64_t multiplier = 1;
+    for (size_t i = 0; i < group; ++i) {
+      const uint8_t value = base58_values[static_cast<uint8_t>(p[i])];
+      if (value == kInvalid) {
+        throw std::runtime_error("Invalid base58btc character in \"" +
+                                 std::string(text) + "\"");
+      }
+      carry = carry * 58 + value;
+      multiplier *= 58;
+    }
+    for (auto& limb : limbs) {
+      const uint64_t t = limb * multiplier + carry;
+      limb = static_cast<uint32_t>(t);
+      carry = t >> 32;
+    }
+    while (carry != 0) {
+      limbs.push_back(static_cast<uint32_t>(carry));
+      carry >>= 32;
+    }
+    p += group;
+    n -= group;
+    group = 5;
+  }
+
+  std::string binary(zeros + limbs.size() * 4, '\0');
+  char* out = &binary[0] + binary.size();
+  for (uint32_t limb : limbs) {
+    for (size_t i = 0; i < 4; ++i) {
+      *--out = static_cast<char>(limb & 0xff);
+      limb >>= 8;
+    }
+  }
+
+  /* The most significant limb may have produced leading zero bytes. */
+  size_t leading = 0;
+  while (zeros + leading < binary.size() && binary[zeros + leading] == '\0') {
+    ++leading;
+  }
+  binary.erase(zeros, leading);
+  return binary;
+}
+
+/* Base32 maps every 5 bytes to 8 characters, so whole groups are converted
+ * through a 40-bit integer rather than bit by bit. */
+
+std::string EncodeBase32(std::string_view bytes) {
+  std::string text((bytes.size() * 8 + 4) / 5, '\0');
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(bytes.data());
+  char* out = &text[0];
+
+  size_t n = bytes.size();
+  for (; n >= 5; n -= 5, p += 5, out += 8) {
+    const uint64_t group = static_cast<uint64_t>(p[0]) << 32 |
+                           static_cast<uint64_t>(p[1]) << 24 |
+                           static_cast<uint64_t>(p[2]) << 16 |
+                           static_cast<uint64_t>(p[3]) << 8 | p[4];
+    for (size_t i = 0; i < 8; ++i) {
+      out[i] = base32_alphabet[(group >> (35 - 5 * i)) & 31];
+    }
+  }
+
+  uint32_t buffer = 0;
+  int bits = 0;
+  for (; n > 0; --n, ++p) {
+    buffer = (buffer << 8) | *p;
+    bits += 8;
+    while (bits >= 5) {
+      bits -= 5;
+      *out++ = base32_alphabet[(buffer >> bits) & 31];
+    }
+  }
+  if (bits > 0) {
+    *out = base32_alphabet[(buffer << (5 - bits)) & 31];
+  }
+  return text;
+}
+
+std::string DecodeBase32(std::string_view text) {
+  std::string binary(text.size() * 5 / 8, '\0');
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(text.data());
+  char* out = &binary[0];
+
+  auto invalid = [&text]() {
+    return std::runtime_error("Invalid base32 character in \"" +
+                              std::string(text) + "\"");
+  };
+
+  size_t n = text.size();
+  for (; n >= 8; n -= 8, p += 8, out += 5) {
+    uint64_t group = 0;
+    uint8_t check = 0;
+    for (size_t i = 0; i < 8; ++i) {
+      const uint8_t value = base32_values[p[i]];
+      check |= value;
+      group = (group << 5) | value;
+    }
+    /* Valid values are below 32, so a single test catches any invalid
+    character of the group. */
+    if (check >= 32) {
+      throw invalid();
+    }
+    for (size_t i = 0; i < 5; ++i) {
+      out[i] = static_cast<char>(group >> (32 - 8 * i));
+    }
+  }
+
+  uint32_t buffer = 0;
+  int bits = 0;
+  for (; n > 0; --n, ++p) {
+    const uint8_t value = base32_values[*p];
+    if (value == kInvalid) {
+      throw invalid();
+    }
+    buffer = (buffer << 5) | value;
+    bits += 5;
+    if (bits >= 8) {
+      bits -= 8;
+      *out++ = static_cast<char>((buffer >> bits) & 0xff);
+    }
+  }
+  return binary;
+}
+
+/** Decode base16 text, either lowercase or uppercase.
+ * @return the decoded binary data */
+static std::string DecodeBase16(std::string_view text) {
+  if (text.size() % 2 != 0) {
+    throw std::runtime_error("Odd length of base16 text \"" +
+                             std::string(text) + "\"");
+  }
+
+  auto nibble = [&text](char c) -> uint8_t {
+    if (c >= '0' && c <= '9') {
+      return static_cast<uint8_t>(c - '0');
+    }
+    if (c >= 'a' && c <= 'f') {
+      return static_cast<uint8_t>(c - 'a' + 10);
+    }
+    if (c >= 'A' && c <= 'F') {
+      return static_cast<uint8_t>(c - 'A' + 10);
+    }
+    throw std::runtime_error("Invalid base16 character in \"" +
+                             std::string(text) + "\"");
+  };
+
+  std::string binary(text.size() / 2, '\0');
+  for (size_t i = 0; i < binary.size(); ++i) {
+    binary[i] =
+        static_cast<char>((nibble(text[2 * i]) << 4) | nibble(text[2 * i + 1]));
+  }
+  return binary;
+}
+
+std::string Decode(std::string_view text) {
+  if (text.empty()) {
+    throw std::runtime_error("Empty multibase text");
+  }
+
+  switch (text[0]) {
+    case 'z':
+      return DecodeBase58btc(text.substr(1));
+    case 'b':
+    case 'B':
+      return DecodeBase32(text.substr(1));
+    case 'f':
+    case 'F':
+      return DecodeBase16(text.substr(1));
+  }
+
+  throw std::runtime_error("Unsupported multibase prefix '" +
+                           std::string(1, text[0]) + "' in \"" +
+                           std::string(text) + "\"");
+}
+
+} /* namespace multibase */
+} /* namespace ipfs */
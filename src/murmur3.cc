@@ -0,0 +1,111 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include "murmur3.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ipfs {
+
+namespace {
+
+inline uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t Fmix(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccd;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53;
+  k ^= k >> 33;
+  return k;
+}
+
+/** Read `n` bytes (at most 8) as a little-endian integer. */
+inline uint64_t Load(const uint8_t* p, size_t n) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < n; ++i) {
+    value |= static_cast<uint64_t>(p[i]) << (8 * i);
+  }
+  return value;
+}
+
+constexpr uint64_t kC1 = 0x87c37b91114253d5;
+constexpr uint64_t kC2 = 0x4cf5ad432745937f;
+
+} /* namespace */
+
+uint64_t Murmur3X64_64(std::string_view data) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+  const size_t length = data.size();
+  const size_t blocks = length / 16;
+
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+
+  for (size_t i = 0; i < blocks; ++i, p += 16) {
+    uint64_t k1 = Load(p, 8);
+    uint64_t k2 = Load(p + 8, 8);
+
+    k1 *= kC1;
+    k1 = Rotl(k1, 31);
+    k1 *= kC2;
+    h1 ^= k1;
+    h1 = Rotl(h1, 27);
+    h1 += h2;
+    h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= kC2;
+    k2 = Rotl(k2, 33);
+    k2 *= kC1;
+    h2 ^= k2;
+    h2 = Rotl(h2, 31);
+    h2 += h1;
+    h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  const size_t tail = length % 16;
+  if (tail > 8) {
+    uint64_t k2 = Load(p + 8, tail - 8);
+    k2 *= kC2;
+    k2 = Rotl(k2, 33);
+    k2 *= kC1;
+    h2 ^= k2;
+  }
+  if (tail > 0) {
+    uint64_t k1 = Load(p, tail < 8 ? tail : 8);
+    k1 *= kC1;
+    k1 = Rotl(k1, 31);
+    k1 *= kC2;
+    h1 ^= k1;
+  }
+
+  h1 ^= length;
+  h2 ^= length;
+  h1 += h2;
+  h2 += h1;
+  h1 = Fmix(h1);
+  h2 = Fmix(h2);
+  h1 += h2;
+
+  return h1;
+}
+
+} /* namespace ipfs */
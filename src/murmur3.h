@@ -0,0 +1,39 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_MURMUR3_H
+#define IPFS_MURMUR3_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace ipfs {
+
+/** MurmurHash3, x64 128-bit variant with a seed of 0, truncated to its first
+ * 64 bits. This is the "murmur3-x64-64" multihash (0x22) that UnixFS uses to
+ * place the entries of sharded directories. Not part of the public
+ * interface.
+ * @return the hash */
+uint64_t Murmur3X64_64(
+    /** [in] Data to hash. */
+    std::string_view data);
+
+} /* namespace ipfs */
+
+#endif /* IPFS_MURMUR3_H */
@@ -0,0 +1,143 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ipfs {
+
+void Client::PinReconcile(const std::unordered_set<Cid>& desired,
+                          PinReconcileResult* result,
+                          const PinReconcileOptions& options) {
+  std::vector<Cid> pinned;
+  ListRecursivePins(&pinned);
+
+  *result = PinReconcileResult();
+  for (const auto& cid : pinned) {
+    if (desired.count(cid) == 0) {
+      result->removed.push_back(cid);
+    } else {
+      ++result->kept;
+    }
+  }
+  for (const auto& cid : desired) {
+    if (!std::binary_search(pinned.begin(), pinned.end(), cid)) {
+      result->added.push_back(cid);
+    }
+  }
+
+  if (!options.dry_run) {
+    ApplyPinChanges(result->added, result->removed, options);
+  }
+}
+
+void Client::PinReconcile(const std::vector<Cid>& desired_sorted,
+                          PinReconcileResult* result,
+                          const PinReconcileOptions& options) {
+  if (std::adjacent_find(desired_sorted.begin(), desired_sorted.end(),
+                         [](const Cid& a, const Cid& b) { return !(a < b); }) !=
+      desired_sorted.end()) {
+    throw std::invalid_argument(
+        "PinReconcile(): the desired CIDs must be sorted and unique");
+  }
+
+  std::vector<Cid> pinned;
+  ListRecursivePins(&pinned);
+
+  *result = PinReconcileResult();
+  auto want = desired_sorted.begin();
+  auto have = pinned.begin();
+  while (want != desired_sorted.end() || have != pinned.end()) {
+    if (have == pinned.end() ||
+        (want != desired_sorted.end() && *want < *have)) {
+      result->added.push_back(*want++);
+    } else if (want == desired_sorted.end() || *have < *want) {
+      result->removed.push_back(*have++);
+    } else {
+      ++result->kept;
+      ++want;
+      ++have;
+    }
+  }
+
+  if (!options.dry_run) {
+    ApplyPinChanges(result->added, result->removed, options);
+  }
+}
+
+void Client::ListRecursivePins(std::vector<Cid>* pinned) {
+  pinned->clear();
+
+  FetchJsonLines(
+      MakeUrl("pin/ls", {{"type", "recursive"}, {"stream", "true"}}), {},
+      [pinned](const Json& pin) {
+        if (!pin.contains("Cid") || !pin["Cid"].is_string()) {
+          throw std::runtime_error("Unexpected pin/ls reply: " + pin.dump());
+        }
+        pinned->emplace_back(pin["Cid"].get<std::string>());
+      });
+
+  std::sort(pinned->begin(), pinned->end());
+  /* The merge in `PinReconcile()` relies on each CID appearing once. */
+  pinned->erase(std::unique(pinned->begin(), pinned->end()), pinned->end());
+}
+
+void Client::ApplyPinChanges(const std::vector<Cid>& add,
+                             const std::vector<Cid>& remove,
+                             const PinReconcileOptions& options) {
+  if (options.concurrency == 0 || options.batch_size == 0) {
+    throw std::invalid_argument(
+        "PinReconcile(): concurrency and batch_size must be positive");
+  }
+
+  /* Pin first, so that objects shared by an old and a new pin are never left
+  unpinned (and possibly garbage collected) in between. */
+  for (const auto* cids : {&add, &remove}) {
+    const char* path = cids == &add ? "pin/add" : "pin/rm";
+    const size_t batches =
+        (cids->size() + options.batch_size - 1) / options.batch_size;
+
+    RunConcurrently(
+        batches, options.concurrency, [&](Client* client, size_t batch) {
+          const size_t begin = batch * options.batch_size;
+          const size_t end =
+              std::min(begin + options.batch_size, cids->size());
+
+          std::vector<std::pair<std::string, std::string>> parameters;
+          parameters.reserve(end - begin + 1);
+          for (size_t i = begin; i < end; ++i) {
+            parameters.emplace_back("arg", (*cids)[i].ToString());
+          }
+          parameters.emplace_back("recursive", "true");
+
+          Json response;
+          client->FetchAndParseJson(client->MakeUrl(path, parameters),
+                                    &response);
+        });
+  }
+}
+
+} /* namespace ipfs */
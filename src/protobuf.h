@@ -0,0 +1,193 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_PROTOBUF_H
+#define IPFS_PROTOBUF_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace ipfs {
+
+/** Minimal protocol buffers wire format support, just enough for the dag-pb
+ * and UnixFS messages. Not part of the public interface. */
+namespace protobuf {
+
+/** Protocol buffers wire types. */
+enum class WireType : uint8_t {
+  kVarint = 0,
+  kFixed64 = 1,
+  kLengthDelimited = 2,
+  kFixed32 = 5,
+};
+
+/** Sequential reader of protocol buffers fields. It never copies: the
+ * length-delimited values it returns point inside the input buffer. */
+class Reader {
+ public:
+  /** Constructor. */
+  explicit Reader(
+      /** [in] Serialized message. Must outlive the reader. */
+      std::string_view input,
+      /** [in] Name of the message, used in error messages. */
+      const char* what)
+      : input_(input), what_(what) {}
+
+  /** Read the key of the next field.
+   * @return false if the end of the input has been reached
+   * @throw std::runtime_error if the input is malformed */
+  bool Next(
+      /** [out] Field number. */
+      uint64_t* field,
+      /** [out] Wire type of the field. */
+      WireType* type) {
+    if (pos_ == input_.size()) {
+      return false;
+    }
+    const uint64_t key = Varint();
+    *field = key >> 3;
+    *type = static_cast<WireType>(key & 7);
+    if (*field == 0) {
+      Fail("invalid field number 0");
+    }
+    return true;
+  }
+
+  /** Read a varint value.
+   * @return the value */
+  uint64_t Varint() {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      if (pos_ == input_.size()) {
+        Fail("truncated varint");
+      }
+      const uint8_t byte = static_cast<uint8_t>(input_[pos_++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    Fail("varint too long");
+    return 0;
+  }
+
+  /** Read a length-delimited value.
+   * @return a view of the value inside the input */
+  std::string_view Bytes() {
+    const uint64_t length = Varint();
+    if (length > input_.size() - pos_) {
+      Fail("truncated length-delimited field");
+    }
+    const std::string_view bytes = input_.substr(pos_, length);
+    pos_ += length;
+    return bytes;
+  }
+
+  /** Read a little-endian fixed-width value of `width` bytes.
+   * @return the value */
+  uint64_t Fixed(size_t width) {
+    if (width > input_.size() - pos_) {
+      Fail("truncated fixed-width field");
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < width; ++i) {
+      value |= static_cast<uint64_t>(static_cast<uint8_t>(input_[pos_ + i]))
+               << (8 * i);
+    }
+    pos_ += width;
+    return value;
+  }
+
+  /** Skip the value of a field of a given wire type. */
+  void Skip(WireType type) {
+    switch (type) {
+      case WireType::kVarint:
+        Varint();
+        return;
+      case WireType::kFixed64:
+        Fixed(8);
+        return;
+      case WireType::kLengthDelimited:
+        Bytes();
+        return;
+      case WireType::kFixed32:
+        Fixed(4);
+        return;
+    }
+    Fail("unsupported wire type " + std::to_string(static_cast<int>(type)));
+  }
+
+  /** Check that a field has the expected wire type. */
+  void Expect(WireType actual, WireType expected, uint64_t field) {
+    if (actual != expected) {
+      Fail("unexpected wire type " + std::to_string(static_cast<int>(actual)) +
+           " for field " + std::to_string(field));
+    }
+  }
+
+  /** Get the number of bytes read so far.
+   * @return the offset of the next byte to read */
+  size_t Position() const { return pos_; }
+
+  /** Get the size of the input.
+   * @return the size in bytes */
+  size_t Size() const { return input_.size(); }
+
+  /** Throw an error about the message being read. */
+  [[noreturn]] void Fail(const std::string& reason) const {
+    throw std::runtime_error(std::string("Malformed ") + what_ + ": " +
+                             reason + " at offset " + std::to_string(pos_));
+  }
+
+ private:
+  std::string_view input_;
+  const char* what_;
+  size_t pos_ = 0;
+};
+
+/** Append the varint encoding of `value` to `out`. */
+inline void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+/** Append a varint field to `out`. */
+inline void AppendVarintField(uint64_t field, uint64_t value, std::string* out) {
+  AppendVarint(field << 3 | static_cast<uint64_t>(WireType::kVarint), out);
+  AppendVarint(value, out);
+}
+
+/** Append a length-delimited field to `out`. */
+inline void AppendBytesField(uint64_t field, std::string_view value,
+                             std::string* out) {
+  AppendVarint(field << 3 | static_cast<uint64_t>(WireType::kLengthDelimited),
+               out);
+  AppendVarint(value.size(), out);
+  out->append(value);
+}
+
+} /* namespace protobuf */
+} /* namespace ipfs */
+
+#endif /* IPFS_PROTOBUF_H */
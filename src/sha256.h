@@ -0,0 +1,62 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#ifndef IPFS_SHA256_H
+#define IPFS_SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ipfs {
+
+/** Incremental SHA-256 (FIPS 180-4), used to compute CIDs locally. Not part of
+ * the public interface. */
+class Sha256 {
+ public:
+  /** Size of a digest in bytes. */
+  static constexpr size_t kDigestSize = 32;
+
+  Sha256();
+
+  /** Hash more data. */
+  void Update(std::string_view data);
+
+  /** Finish the hash. The object must not be used afterwards.
+   * @return the digest, `kDigestSize` bytes */
+  std::string Final();
+
+  /** Hash a whole buffer at once.
+   * @return the digest, `kDigestSize` bytes */
+  static std::string Digest(std::string_view data);
+
+ private:
+  /** Process `blocks` 64-byte blocks. */
+  void Compress(const uint8_t* data, size_t blocks);
+
+  uint32_t state_[8];
+  uint64_t length_ = 0;
+  uint8_t buffer_[64];
+  size_t buffered_ = 0;
+};
+
+} /* namespace ipfs */
+
+#endif /* IPFS_SHA256_H */
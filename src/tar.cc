@@ -0,0 +1,321 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/tar.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace ipfs {
+
+namespace tar {
+
+namespace {
+
+/** Largest metadata entry (PAX extended header or GNU long name) accepted. */
+constexpr size_t kMaxMetaSize = 1024 * 1024;
+
+/** Get a NUL-terminated field of a header. */
+std::string_view Field(const std::string& header, size_t offset, size_t size) {
+  std::string_view field(header.data() + offset, size);
+  return field.substr(0, field.find('\0'));
+}
+
+/** Parse a numeric field of a header: octal digits, possibly surrounded by
+ * spaces and NULs, or a big-endian base-256 number (GNU extension) if its
+ * first byte has its high bit set. */
+uint64_t Number(const std::string& header, size_t offset, size_t size) {
+  const auto* field = reinterpret_cast<const uint8_t*>(header.data() + offset);
+
+  if ((field[0] & 0x80) != 0) {
+    if ((field[0] & 0x40) != 0) {
+      throw std::runtime_error("Malformed TAR header: negative number");
+    }
+    uint64_t value = field[0] & 0x3f;
+    for (size_t i = 1; i < size; ++i) {
+      if (value > (UINT64_MAX >> 8)) {
+        throw std::runtime_error("Malformed TAR header: number too large");
+      }
+      value = (value << 8) | field[i];
+    }
+    return value;
+  }
+
+  size_t i = 0;
+  while (i < size && field[i] == ' ') {
+    ++i;
+  }
+  uint64_t value = 0;
+  for (; i < size && field[i] != ' ' && field[i] != '\0'; ++i) {
+    if (field[i] < '0' || field[i] > '7') {
+      throw std::runtime_error("Malformed TAR header: invalid octal number");
+    }
+    if (value > (UINT64_MAX >> 3)) {
+      throw std::runtime_error("Malformed TAR header: number too large");
+    }
+    value = (value << 3) | static_cast<uint64_t>(field[i] - '0');
+  }
+  return value;
+}
+
+/** Parse a decimal number of a PAX record. */
+uint64_t Decimal(std::string_view text) {
+  if (text.empty()) {
+    throw std::runtime_error("Malformed TAR PAX header: empty number");
+  }
+  uint64_t value = 0;
+  for (const char c : text) {
+    if (c < '0' || c > '9' || value > (UINT64_MAX - 9) / 10) {
+      throw std::runtime_error("Malformed TAR PAX header: invalid number");
+    }
+    value = value * 10 + static_cast<uint64_t>(c - '0');
+  }
+  return value;
+}
+
+} /* namespace */
+
+Parser::Parser(Handler* handler) : handler_(handler) {
+  header_.reserve(kBlockSize);
+}
+
+void Parser::Feed(std::string_view data) {
+  while (!data.empty()) {
+    switch (state_) {
+      case State::kHeader: {
+        const size_t n = std::min(kBlockSize - header_.size(), data.size());
+        header_.append(data.substr(0, n));
+        data.remove_prefix(n);
+        if (header_.size() == kBlockSize) {
+          ParseHeader();
+          header_.clear();
+        }
+        break;
+      }
+      case State::kData: {
+        const size_t n =
+            static_cast<size_t>(std::min<uint64_t>(remaining_, data.size()));
+        handler_->Data(data.substr(0, n));
+        data.remove_prefix(n);
+        remaining_ -= n;
+        if (remaining_ == 0) {
+          handler_->End();
+          EndEntry();
+        }
+        break;
+      }
+      case State::kMeta: {
+        const size_t n =
+            static_cast<size_t>(std::min<uint64_t>(remaining_, data.size()));
+        meta_.append(data.substr(0, n));
+        data.remove_prefix(n);
+        remaining_ -= n;
+        if (remaining_ == 0) {
+          if (meta_type_ == 'x') {
+            ParsePax(meta_);
+          } else if (meta_type_ == 'L') {
+            next_path_ = meta_.substr(0, meta_.find('\0'));
+          } else if (meta_type_ == 'K') {
+            next_link_ = meta_.substr(0, meta_.find('\0'));
+          }
+          meta_.clear();
+          EndEntry();
+        }
+        break;
+      }
+      case State::kPadding: {
+        const size_t n =
+            static_cast<size_t>(std::min<uint64_t>(remaining_, data.size()));
+        data.remove_prefix(n);
+        remaining_ -= n;
+        if (remaining_ == 0) {
+          state_ = State::kHeader;
+        }
+        break;
+      }
+      case State::kEnd:
+        return;
+    }
+  }
+}
+
+void Parser::Finish() const {
+  if (state_ != State::kEnd &&
+      !(state_ == State::kHeader && header_.empty() && next_path_.empty() &&
+        next_link_.empty() && !has_next_size_)) {
+    throw std::runtime_error("Truncated TAR archive");
+  }
+}
+
+void Parser::ParseHeader() {
+  if (std::all_of(header_.begin(), header_.end(),
+                  [](char c) { return c == '\0'; })) {
+    state_ = State::kEnd;
+    return;
+  }
+
+  /* The checksum is the sum of the bytes of the header, with the checksum
+  field itself taken as spaces. Some old archivers summed signed bytes. */
+  uint64_t unsigned_sum = 0;
+  int64_t signed_sum = 0;
+  for (size_t i = 0; i < kBlockSize; ++i) {
+    const char c = i >= 148 && i < 156 ? ' ' : header_[i];
+    unsigned_sum += static_cast<uint8_t>(c);
+    signed_sum += static_cast<signed char>(c);
+  }
+  const uint64_t checksum = Number(header_, 148, 8);
+  if (checksum != unsigned_sum &&
+      static_cast<int64_t>(checksum) != signed_sum) {
+    throw std::runtime_error("Malformed TAR header: bad checksum");
+  }
+
+  const char type = header_[156];
+  uint64_t size = Number(header_, 124, 12);
+
+  if (type == 'x' || type == 'g' || type == 'L' || type == 'K') {
+    if (size > kMaxMetaSize) {
+      throw std::runtime_error("TAR metadata entry too large");
+    }
+    /* Global PAX headers are read and ignored. */
+    meta_type_ = type;
+    remaining_ = size;
+    padding_ = (kBlockSize - size % kBlockSize) % kBlockSize;
+    if (size == 0) {
+      EndEntry();
+    } else {
+      state_ = State::kMeta;
+    }
+    return;
+  }
+
+  Entry entry;
+  if (!next_path_.empty()) {
+    entry.path = std::move(next_path_);
+  } else {
+    entry.path = Field(header_, 0, 100);
+    /* POSIX ustar archives split long paths in a prefix and a name. GNU
+    archives ("ustar  ") use the prefix field for something else. */
+    const std::string_view prefix = Field(header_, 345, 155);
+    if (header_.compare(257, 6, std::string("ustar\0", 6)) == 0 &&
+        !prefix.empty()) {
+      entry.path = std::string(prefix) + "/" + entry.path;
+    }
+  }
+  while (entry.path.size() > 1 && entry.path.back() == '/') {
+    entry.path.pop_back();
+  }
+
+  if (!next_link_.empty()) {
+    entry.link_target = std::move(next_link_);
+  } else {
+    entry.link_target = Field(header_, 157, 100);
+  }
+
+  if (has_next_size_) {
+    size = next_size_;
+  }
+
+  switch (type) {
+    case '0':
+    case '\0':
+    case '7':
+      entry.type = Entry::Type::kFile;
+      break;
+    case '5':
+      entry.type = Entry::Type::kDirectory;
+      break;
+    case '2':
+      entry.type = Entry::Type::kSymlink;
+      break;
+    default:
+      entry.type = Entry::Type::kOther;
+      break;
+  }
+  if (entry.type != Entry::Type::kSymlink && type != '1') {
+    entry.link_target.clear();
+  }
+
+  entry.size = size;
+  entry.mode = static_cast<uint32_t>(Number(header_, 100, 8) & 07777);
+
+  next_path_.clear();
+  next_link_.clear();
+  has_next_size_ = false;
+
+  remaining_ = size;
+  padding_ = (kBlockSize - size % kBlockSize) % kBlockSize;
+  meta_type_ = 0;
+
+  handler_->Begin(entry);
+  if (size == 0) {
+    handler_->End();
+    EndEntry();
+  } else {
+    state_ = State::kData;
+  }
+}
+
+void Parser::ParsePax(const std::string& records) {
+  /* Each record is "<length> <key>=<value>\n", where the length counts the
+  whole record. */
+  std::string_view rest(records);
+  while (!rest.empty()) {
+    const size_t space = rest.find(' ');
+    if (space == rest.npos) {
+      throw std::runtime_error("Malformed TAR PAX header: missing length");
+    }
+    const uint64_t length = Decimal(rest.substr(0, space));
+    if (length <= space + 1 || length > rest.size() ||
+        rest[length - 1] != '\n') {
+      throw std::runtime_error("Malformed TAR PAX header: bad record length");
+    }
+
+    const std::string_view record =
+        rest.substr(space + 1, length - space - 2);
+    rest.remove_prefix(length);
+
+    const size_t equal = record.find('=');
+    if (equal == record.npos) {
+      throw std::runtime_error("Malformed TAR PAX header: missing '='");
+    }
+    const std::string_view key = record.substr(0, equal);
+    const std::string_view value = record.substr(equal + 1);
+
+    if (key == "path") {
+      next_path_ = value;
+    } else if (key == "linkpath") {
+      next_link_ = value;
+    } else if (key == "size") {
+      next_size_ = Decimal(value);
+      has_next_size_ = true;
+    }
+  }
+}
+
+void Parser::EndEntry() {
+  remaining_ = padding_;
+  state_ = remaining_ > 0 ? State::kPadding : State::kHeader;
+}
+
+} /* namespace tar */
+
+} /* namespace ipfs */
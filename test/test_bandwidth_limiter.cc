@@ -0,0 +1,139 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+#include <ipfs/http/bandwidth-limiter.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+/** Check the share of a transfer.
+ * @throw std::runtime_error if it is not the expected one */
+void check_share(const ipfs::http::BandwidthLimiter::Transfer& transfer,
+                 uint64_t send, uint64_t recv, const std::string& label) {
+  const ipfs::http::BandwidthLimits share = transfer.Share();
+  if (share.send_bytes_per_second != send ||
+      share.recv_bytes_per_second != recv) {
+    throw std::runtime_error(
+        label + ": share is " + std::to_string(share.send_bytes_per_second) +
+        "/" + std::to_string(share.recv_bytes_per_second) + " instead of " +
+        std::to_string(send) + "/" + std::to_string(recv));
+  }
+}
+
+} /* namespace */
+
+int main(int, char**) {
+  try {
+    using ipfs::http::BandwidthLimiter;
+    using ipfs::http::BandwidthLimits;
+
+    /** [ipfs::Client::SetBandwidthLimiter] */
+    /* The whole process sends and receives at most 100 MB/s. */
+    BandwidthLimiter::Global()->SetLimits(
+        BandwidthLimits{100000000, 100000000});
+
+    /* Replication gets up to 10 MB/s of it, split between its transfers. */
+    auto replication =
+        std::make_shared<BandwidthLimiter>(BandwidthLimits{10000000, 10000000});
+    ipfs::Client client("localhost", 5001);
+    client.SetBandwidthLimiter(replication);
+
+    /* Off-peak, the limit may be raised without stopping anything. */
+    replication->SetLimits(BandwidthLimits{50000000, 50000000});
+    /** [ipfs::Client::SetBandwidthLimiter] */
+
+    check_share(BandwidthLimiter::Transfer(), 0, 0, "empty transfer");
+
+    {
+      BandwidthLimiter::Transfer first = replication->Start(true);
+      check_share(first, 50000000, 50000000, "single transfer");
+
+      BandwidthLimiter::Transfer second = replication->Start(true);
+      check_share(first, 25000000, 25000000, "two transfers");
+
+      /* Other transfers take their share of the process limit. */
+      BandwidthLimiter::Transfer other =
+          BandwidthLimiter::Global()->Start(true);
+      check_share(other, 33333333, 33333333, "other transfer");
+      check_share(second, 25000000, 25000000, "replication transfer");
+
+      replication->SetLimits(BandwidthLimits{80000000, 0});
+      check_share(second, 33333333, 33333333, "raised limits");
+
+      /* Moving a transfer does not end it. */
+      BandwidthLimiter::Transfer moved = std::move(first);
+      if (replication->Transfers() != 2 ||
+          BandwidthLimiter::Global()->Transfers() != 3) {
+        throw std::runtime_error("BandwidthLimiter: lost a transfer");
+      }
+
+      /* Downloads take no share of the send limit. */
+      BandwidthLimiter::Transfer download = replication->Start(false);
+      check_share(second, 33333333, 25000000, "download started");
+      if (replication->Transfers() != 3 || replication->Sending() != 2) {
+        throw std::runtime_error("BandwidthLimiter: download counted as "
+                                 "sending");
+      }
+    }
+
+    if (replication->Transfers() != 0 || replication->Sending() != 0 ||
+        BandwidthLimiter::Global()->Transfers() != 0) {
+      throw std::runtime_error("BandwidthLimiter: transfers not ended");
+    }
+
+    /* No parent, no limits from above. */
+    BandwidthLimiter alone(BandwidthLimits{0, 1000}, nullptr);
+    BandwidthLimiter::Transfer transfer = alone.Start(true);
+    check_share(transfer, 0, 1000, "limiter without parent");
+
+    /* libcurl holds a download to its share: 3 MB at 1 MB/s take more than
+     * a second, even though the first megabyte or so comes at full speed. */
+    replication->SetLimits(BandwidthLimits{0, 1000000});
+    ipfs::Json added;
+    client.FilesAdd(
+        {{"throttled.bin", ipfs::http::FileUpload::Type::kFileContents,
+          std::string(3000000, 't')}},
+        &added);
+    std::stringstream throttled;
+    const auto start = std::chrono::steady_clock::now();
+    client.FilesGet("/ipfs/" + added[0]["hash"].get<std::string>(),
+                    &throttled);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    if (throttled.str() != std::string(3000000, 't') ||
+        elapsed < std::chrono::milliseconds(1000)) {
+      throw std::runtime_error("BandwidthLimiter: download not throttled, "
+                               "took " +
+                               std::to_string(elapsed.count()) + " ms");
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -17,12 +17,15 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
 IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
+#include <ipfs/block-index.h>
+#include <ipfs/cid.h>
 #include <ipfs/client.h>
 #include <ipfs/test/utils.h>
 
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 
 int main(int, char**) {
   try {
@@ -63,6 +66,48 @@ int main(int, char**) {
     /** [ipfs::Client::BlockStat] */
     ipfs::test::check_if_properties_exist("client.BlockStat()", stat_result,
                                           {"Key", "Size"});
+
+    /** [ipfs::Client::Refs] */
+    /* E.g. block["Key"] is "QmQpWo5TL9nivqvL18Bq8bS34eewAA6jcgdVsUu4tGeVHo". */
+    size_t links = 0;
+    client.Refs(block["Key"], true /* recursive */, true /* unique */,
+                [&links](const ipfs::Cid& cid) {
+                  std::cout << "Linked block: " << cid.ToString() << std::endl;
+                  ++links;
+                });
+    std::cout << "Number of linked blocks: " << links << std::endl;
+    /* An example output:
+    Number of linked blocks: 0
+    */
+    /** [ipfs::Client::Refs] */
+
+    /** [ipfs::Client::RefsLocal] */
+    size_t local_blocks = 0;
+    client.RefsLocal([&local_blocks](const ipfs::Cid&) { ++local_blocks; });
+    std::cout << "Number of local blocks: " << local_blocks << std::endl;
+    /* An example output:
+    Number of local blocks: 17
+    */
+    /** [ipfs::Client::RefsLocal] */
+
+    /** [ipfs::BlockIndex] */
+    /* Takes about 1.2 byte per block stored by the peer. */
+    const ipfs::BlockIndex local(&client);
+
+    /* E.g. block["Key"] is "QmQpWo5TL9nivqvL18Bq8bS34eewAA6jcgdVsUu4tGeVHo". */
+    const ipfs::Cid key(block["Key"].get<std::string>());
+    std::cout << "Blocks: " << local.Size() << ", " << key.ToString()
+              << (local.Contains(key) ? " is" : " is not") << " stored"
+              << std::endl;
+    /* An example output:
+    Blocks: 17, QmQpWo5TL9nivqvL18Bq8bS34eewAA6jcgdVsUu4tGeVHo is stored
+    */
+    /** [ipfs::BlockIndex] */
+
+    if (links != 0 || local_blocks == 0 || local.Size() != local_blocks ||
+        !local.Contains(key)) {
+      throw std::runtime_error("Refs(), RefsLocal() or BlockIndex is wrong");
+    }
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
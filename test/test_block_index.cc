@@ -0,0 +1,122 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/block-index.h>
+#include <ipfs/cid.h>
+#include <ipfs/test/utils.h>
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/** Make a CID with a pseudo-random sha2-256 digest. */
+static ipfs::Cid random_cid(std::mt19937_64* rng, unsigned version,
+                            uint64_t codec) {
+  std::string digest;
+  for (int i = 0; i < 4; ++i) {
+    const uint64_t word = (*rng)();
+    digest.append(reinterpret_cast<const char*>(&word), sizeof(word));
+  }
+  return ipfs::Cid::FromBinary(ipfs::cid::FromSha256(version, codec, digest));
+}
+
+int main(int, char**) {
+  try {
+    std::mt19937_64 rng(42);
+
+    std::vector<ipfs::Cid> stored;
+    for (int i = 0; i < 10000; ++i) {
+      stored.push_back(random_cid(&rng, 0, ipfs::cid::kDagPb));
+    }
+    stored.push_back(stored.front());
+
+    std::vector<ipfs::Cid> absent;
+    for (int i = 0; i < 100000; ++i) {
+      absent.push_back(random_cid(&rng, 1, ipfs::cid::kRaw));
+    }
+
+    /* The multihash of a CIDv0 is the CID itself. */
+    const ipfs::Cid& v0 = stored.front();
+    if (ipfs::cid::Multihash(v0.Binary()) != v0.Binary() ||
+        ipfs::cid::Multihash(absent.front().Binary()) !=
+            absent.front().Binary().substr(2)) {
+      throw std::runtime_error("cid::Multihash() returned a wrong multihash");
+    }
+
+    /* Same multihash as `v0`, as CIDv1 with the raw multicodec, as listed by
+    refs/local. */
+    const ipfs::Cid v1_raw = ipfs::Cid::FromBinary(
+        std::string("\x01\x55", 2) + std::string(v0.Binary()));
+
+    ipfs::BlockIndexOptions exact_options;
+    exact_options.exact = true;
+    const ipfs::BlockIndex exact(stored, exact_options);
+    const ipfs::BlockIndex bloom(stored);
+
+    for (const ipfs::BlockIndex* index : {&exact, &bloom}) {
+      const std::string label =
+          index == &exact ? "BlockIndex(exact)" : "BlockIndex(Bloom)";
+
+      if (index->Size() != 10000) {
+        throw std::runtime_error(label + ": size is " +
+                                 std::to_string(index->Size()));
+      }
+      for (const auto& cid : stored) {
+        if (!index->Contains(cid)) {
+          throw std::runtime_error(label + ": missing " + cid.ToString());
+        }
+      }
+      if (!index->Contains(v1_raw)) {
+        throw std::runtime_error(label + ": missing the CIDv1 of " +
+                                 v0.ToString());
+      }
+
+      size_t false_positives = 0;
+      for (const auto& cid : absent) {
+        false_positives += index->Contains(cid) ? 1 : 0;
+      }
+      /* 1% is expected from the Bloom filter, leave some margin. */
+      const size_t allowed = index == &exact ? 0 : absent.size() * 2 / 100;
+      if (false_positives > allowed) {
+        throw std::runtime_error(label + ": " +
+                                 std::to_string(false_positives) +
+                                 " false positives");
+      }
+    }
+
+    const ipfs::BlockIndex empty(std::vector<ipfs::Cid>{});
+    if (empty.Size() != 0 || empty.Contains(v0)) {
+      throw std::runtime_error("BlockIndex(empty) is not empty");
+    }
+
+    ipfs::test::must_fail("BlockIndex(false_positive_rate = 0)", [&stored]() {
+      ipfs::BlockIndexOptions options;
+      options.false_positive_rate = 0;
+      ipfs::BlockIndex index(stored, options);
+    });
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
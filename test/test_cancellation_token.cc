@@ -0,0 +1,208 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+#include <ipfs/http/bandwidth-limiter.h>
+#include <ipfs/http/cancellation-token.h>
+#include <ipfs/http/rate-limiter.h>
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+
+/** Buffer of a response, which calls a function when the first bytes are
+ * written to it. */
+class FirstByteBuffer : public std::stringbuf {
+ public:
+  explicit FirstByteBuffer(std::function<void()> on_first_byte)
+      : on_first_byte_(std::move(on_first_byte)) {}
+
+ protected:
+  std::streamsize xsputn(const char* data, std::streamsize size) override {
+    Notify();
+    return std::stringbuf::xsputn(data, size);
+  }
+
+  int_type overflow(int_type c) override {
+    Notify();
+    return std::stringbuf::overflow(c);
+  }
+
+ private:
+  void Notify() {
+    if (on_first_byte_) {
+      on_first_byte_();
+      on_first_byte_ = nullptr;
+    }
+  }
+
+  std::function<void()> on_first_byte_;
+};
+
+} /* namespace */
+
+int main(int, char**) {
+  try {
+    using ipfs::http::CancellationToken;
+    using ipfs::http::CancelledError;
+
+    ipfs::Client client("localhost", 5001);
+    ipfs::Json added;
+    client.FilesAdd({{"large.bin", ipfs::http::FileUpload::Type::kFileContents,
+                      std::string(3000000, 'l')}},
+                    &added);
+    const std::string path = "/ipfs/" + added[0]["hash"].get<std::string>();
+
+    /* Slow down the downloads, one at a time. */
+    ipfs::http::RateLimiterOptions one_read;
+    one_read.reads.max_in_flight = 1;
+    client.SetRateLimiter(std::make_shared<ipfs::http::RateLimiter>(one_read));
+    auto bandwidth = std::make_shared<ipfs::http::BandwidthLimiter>(
+        ipfs::http::BandwidthLimits{0, 1000000});
+    client.SetBandwidthLimiter(bandwidth);
+    ipfs::Client other(client);
+
+    /** [ipfs::Client::CancelScope] */
+    auto token = std::make_shared<CancellationToken>();
+    std::promise<void> started;
+    FirstByteBuffer buffer([&started]() { started.set_value(); });
+    std::iostream contents(&buffer);
+
+    bool cancelled = false;
+    std::thread worker([&client, token, &path, &contents, &cancelled]() {
+      ipfs::Client::CancelScope scope(&client, token);
+      try {
+        client.FilesGet(path, &contents);
+      } catch (const CancelledError& e) {
+        std::cout << e.what() << std::endl;
+        cancelled = true;
+      }
+    });
+
+    /* Give up on the download once it started. Other clients, and later
+     * requests of this one, are not affected: there is no need to call
+     * Reset(). */
+    started.get_future().wait();
+    const auto cancelled_at = std::chrono::steady_clock::now();
+    token->Cancel();
+    worker.join();
+    /* An example output:
+    Request cancelled
+    */
+    /** [ipfs::Client::CancelScope] */
+    if (!cancelled || buffer.str().size() >= 3000000 ||
+        std::chrono::steady_clock::now() - cancelled_at >
+            std::chrono::milliseconds(500)) {
+      throw std::runtime_error("CancelScope: download not cancelled");
+    }
+
+    /* The limiters the download went through are free for the others. */
+    if (bandwidth->Transfers() != 0) {
+      throw std::runtime_error("CancelScope: transfer not ended");
+    }
+    std::stringstream rest;
+    other.FilesGet(path, &rest);
+    if (rest.str() != std::string(3000000, 'l')) {
+      throw std::runtime_error("CancelScope: other download incomplete");
+    }
+    ipfs::Json version;
+    client.Version(&version);
+
+    /* The callbacks of a token run once, from Cancel(), or at once if it is
+     * already cancelled, and not after their registration is gone. */
+    CancellationToken callbacks;
+    int called = 0;
+    int removed = 0;
+    {
+      CancellationToken::Registration gone =
+          callbacks.Register([&removed]() { ++removed; });
+    }
+    CancellationToken::Registration registration =
+        callbacks.Register([&called]() { ++called; });
+    callbacks.Cancel();
+    callbacks.Cancel();
+    CancellationToken::Registration late =
+        callbacks.Register([&called]() { ++called; });
+    if (called != 2 || removed != 0 || !callbacks.IsCancelled()) {
+      throw std::runtime_error("CancellationToken: wrong callbacks");
+    }
+
+    /* Nothing listens on port 1, but a cancelled request does not even get
+     * to find out. */
+    ipfs::Client offline("localhost", 1);
+    auto gone = std::make_shared<CancellationToken>();
+    gone->Cancel();
+    cancelled = false;
+    try {
+      ipfs::Client::CancelScope scope(&offline, gone);
+      offline.Version(&version);
+    } catch (const CancelledError&) {
+      cancelled = true;
+    }
+    if (!cancelled) {
+      throw std::runtime_error("CancelScope: cancelled request was sent");
+    }
+
+    /* A request waiting for its turn is cancelled at once, and the scope
+     * ends with the cancellation. */
+    ipfs::http::RateLimiterOptions options;
+    options.reads.max_in_flight = 1;
+    auto limiter = std::make_shared<ipfs::http::RateLimiter>(options);
+    offline.SetRateLimiter(limiter);
+    const ipfs::http::RateLimiter::Permit busy =
+        limiter->Acquire(ipfs::http::RequestClass::kRead);
+
+    auto waiting = std::make_shared<CancellationToken>();
+    cancelled = false;
+    std::thread stuck([&offline, waiting, &cancelled]() {
+      ipfs::Client::CancelScope scope(&offline, waiting);
+      try {
+        ipfs::Json version;
+        offline.Version(&version);
+      } catch (const CancelledError&) {
+        cancelled = true;
+      }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto start = std::chrono::steady_clock::now();
+    waiting->Cancel();
+    stuck.join();
+    if (!cancelled || std::chrono::steady_clock::now() - start >
+                          std::chrono::milliseconds(500)) {
+      throw std::runtime_error("CancelScope: request not cancelled");
+    }
+    if (limiter->Stats(ipfs::http::RequestClass::kRead).queued != 0) {
+      throw std::runtime_error("CancelScope: request still queued");
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
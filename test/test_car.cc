@@ -0,0 +1,117 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/car.h>
+#include <ipfs/cid.h>
+#include <ipfs/test/utils.h>
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/** Throw if two values differ. */
+template <class T>
+static void check_equal(const std::string& label, const T& actual,
+                        const T& expected) {
+  if (actual != expected) {
+    throw std::runtime_error(label + ": unexpected value");
+  }
+}
+
+int main(int, char**) {
+  try {
+    const std::string empty_dir = ipfs::cid::FromString(
+        "QmUNLLsPACCz1vLxQVkXqqLX5R1X345qqfHbsf67hvA3Nn");
+    const std::string empty_dir_block("\x0a\x02\x08\x01", 4);
+    const std::string hello = ipfs::cid::FromString(
+        "bafkreifzjut3te2nhyekklss27nh3k72ysco7y32koao5eei66wof36n5e");
+    const std::string hello_block = "hello world";
+
+    /** [ipfs::car] */
+    /* Write an archive with two blocks, then read it back. */
+    std::stringstream archive;
+    {
+      ipfs::car::Writer writer(&archive, {empty_dir});
+      writer.Add(empty_dir, empty_dir_block);
+      writer.Add(hello, hello_block);
+    }
+
+    ipfs::car::Reader reader(&archive);
+    std::cout << "Roots: " << ipfs::cid::ToString(reader.Roots()[0])
+              << std::endl;
+
+    std::string cid;
+    std::string block;
+    while (reader.Next(&cid, &block)) {
+      std::cout << ipfs::cid::ToString(cid) << ": " << block.size()
+                << " bytes" << std::endl;
+    }
+    /* An example output:
+    Roots: QmUNLLsPACCz1vLxQVkXqqLX5R1X345qqfHbsf67hvA3Nn
+    QmUNLLsPACCz1vLxQVkXqqLX5R1X345qqfHbsf67hvA3Nn: 4 bytes
+    bafkreifzjut3te2nhyekklss27nh3k72ysco7y32koao5eei66wof36n5e: 11 bytes
+    */
+    /** [ipfs::car] */
+
+    /* The header is the canonical DAG-CBOR map {"roots": [...], "version": 1}
+    preceded by its length. */
+    check_equal("car::Writer header",
+                archive.str().substr(0, 14),
+                std::string("\x38\xa2\x65roots\x81\xd8\x2a\x58\x23\x00", 14));
+
+    std::stringstream copy(archive.str());
+    ipfs::car::Reader second(&copy);
+    check_equal("car::Reader::Roots()", second.Roots(),
+                std::vector<std::string>{empty_dir});
+    std::vector<std::string> blocks;
+    while (second.Next(&cid, &block)) {
+      blocks.push_back(cid);
+      blocks.push_back(block);
+    }
+    check_equal("car::Reader::Next()", blocks,
+                std::vector<std::string>{empty_dir, empty_dir_block, hello,
+                                         hello_block});
+
+    const std::string truncated =
+        archive.str().substr(0, archive.str().size() - 1);
+    ipfs::test::must_fail("car::Reader::Next(truncated)", [&truncated]() {
+      std::stringstream in(truncated);
+      ipfs::car::Reader r(&in);
+      std::string c;
+      std::string b;
+      while (r.Next(&c, &b)) {
+      }
+    });
+    ipfs::test::must_fail("car::Reader(empty)", []() {
+      std::stringstream in;
+      ipfs::car::Reader r(&in);
+    });
+    ipfs::test::must_fail("car::Reader(version 2)", []() {
+      std::stringstream in(std::string("\x0a\xa1\x67version\x02", 11));
+      ipfs::car::Reader r(&in);
+    });
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,201 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+#include <ipfs/http/bandwidth-limiter.h>
+#include <ipfs/http/circuit-breaker.h>
+#include <ipfs/http/transport-curl.h>
+#include <ipfs/test/stub-server.h>
+#include <ipfs/test/utils.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+/** Check that a breaker is in a given state. */
+void check_state(const ipfs::http::CircuitBreaker& breaker,
+                 ipfs::http::CircuitBreaker::State expected,
+                 const char* label) {
+  if (breaker.GetState() != expected) {
+    throw std::runtime_error(std::string("CircuitBreaker: wrong state ") +
+                             label);
+  }
+}
+
+/** A read whose request body takes long to upload is not a slow call: the
+ * peer answers as soon as it has the whole body. */
+void slow_upload() {
+  ipfs::test::StubServer peer("{}");
+
+  ipfs::http::CircuitBreakerOptions options;
+  options.window = 1;
+  options.minimum_calls = 1;
+  options.slow_call = std::chrono::milliseconds(300);
+  const auto breaker = std::make_shared<ipfs::http::CircuitBreaker>(options);
+
+  /* 3 MB at 1 MB/s take well over `slow_call` to upload. */
+  ipfs::http::TransportCurl transport(false);
+  transport.SetCircuitBreaker(breaker);
+  transport.SetBandwidthLimiter(std::make_shared<ipfs::http::BandwidthLimiter>(
+      ipfs::http::BandwidthLimits{1024 * 1024, 0}));
+
+  const auto start = std::chrono::steady_clock::now();
+  std::stringstream response;
+  transport.Fetch(
+      "http://127.0.0.1:" + std::to_string(peer.Port()) + "/api/v0/cat",
+      {{"big", ipfs::http::FileUpload::Type::kFileContents,
+        std::string(3 * 1024 * 1024, 'u')}},
+      &response);
+  if (std::chrono::steady_clock::now() - start < options.slow_call) {
+    throw std::runtime_error("CircuitBreaker: the upload was not throttled");
+  }
+  check_state(*breaker, ipfs::http::CircuitBreaker::State::kClosed,
+              "after a slow upload");
+}
+
+/** A read that the peer is slow to answer is a slow call. */
+void slow_answer() {
+  ipfs::test::StubServer peer("{}", false, std::chrono::milliseconds(500));
+
+  ipfs::http::CircuitBreakerOptions options;
+  options.window = 1;
+  options.minimum_calls = 1;
+  options.slow_call = std::chrono::milliseconds(300);
+  const auto breaker = std::make_shared<ipfs::http::CircuitBreaker>(options);
+
+  ipfs::http::TransportCurl transport(false);
+  transport.SetCircuitBreaker(breaker);
+  std::stringstream response;
+  transport.Fetch(
+      "http://127.0.0.1:" + std::to_string(peer.Port()) + "/api/v0/version",
+      {}, &response);
+  check_state(*breaker, ipfs::http::CircuitBreaker::State::kOpen,
+              "after a slow answer");
+}
+
+} /* namespace */
+
+int main(int, char**) {
+  try {
+    using State = ipfs::http::CircuitBreaker::State;
+    using Outcome = ipfs::http::CircuitBreaker::Outcome;
+
+    /** [ipfs::Client::SetCircuitBreaker] */
+    ipfs::http::CircuitBreakerOptions options;
+    options.window = 4;
+    options.minimum_calls = 4;
+    options.open_duration = std::chrono::milliseconds(100);
+
+    /* Nothing listens on port 1: the calls fail until the breaker opens. */
+    ipfs::Client client("localhost", 1);
+    client.SetCircuitBreaker(options);
+
+    for (int i = 0; i < 6; ++i) {
+      try {
+        ipfs::Json version;
+        client.Version(&version);
+      } catch (const ipfs::http::CircuitOpenError& e) {
+        std::cout << "Failed fast: " << e.what() << std::endl;
+      } catch (const std::exception& e) {
+        std::cout << "Failed: " << e.what() << std::endl;
+      }
+    }
+    /* An example output:
+    Failed: HTTP transfer failed: Couldn't connect to server: Failed to co...
+    Failed: HTTP transfer failed: Couldn't connect to server: Failed to co...
+    Failed: HTTP transfer failed: Couldn't connect to server: Failed to co...
+    Failed: HTTP transfer failed: Couldn't connect to server: Failed to co...
+    Failed fast: Circuit breaker open, the peer is failing
+    Failed fast: Circuit breaker open, the peer is failing
+    */
+    /** [ipfs::Client::SetCircuitBreaker] */
+
+    /* Other clients of the same peer share the breaker. */
+    const auto breaker = ipfs::http::CircuitBreaker::Shared(client.UrlPrefix());
+    check_state(*breaker, State::kOpen, "after the failures");
+    if (breaker->Rejected() != 2) {
+      throw std::runtime_error("CircuitBreaker: expected 2 rejected calls");
+    }
+    ipfs::Client other("localhost", 1);
+    other.SetCircuitBreaker();
+    ipfs::Client copy(client);
+    for (ipfs::Client* c : {&other, &copy}) {
+      try {
+        ipfs::Json id;
+        c->Id(&id);
+        throw std::runtime_error("CircuitBreaker: the call went through");
+      } catch (const ipfs::http::CircuitOpenError&) {
+      }
+    }
+
+    /* Once half-open, a failed trial opens the breaker again. */
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    check_state(*breaker, State::kHalfOpen, "after open_duration");
+    ipfs::test::must_fail("Client::Version()", [&client]() {
+      ipfs::Json version;
+      client.Version(&version);
+    });
+    check_state(*breaker, State::kOpen, "after a failed trial");
+
+    /* Slow calls count as failed, and successful trials close the
+     * breaker. */
+    ipfs::http::CircuitBreakerOptions slow;
+    slow.window = 10;
+    slow.minimum_calls = 5;
+    slow.slow_call = std::chrono::milliseconds(100);
+    slow.open_duration = std::chrono::milliseconds(0);
+    slow.half_open_calls = 2;
+    ipfs::http::CircuitBreaker standalone(slow);
+    for (int i = 0; i < 3; ++i) {
+      standalone.Record(standalone.Admit(), Outcome::kSuccess,
+                        std::chrono::milliseconds(10));
+      standalone.Record(standalone.Admit(), Outcome::kSuccess,
+                        std::chrono::milliseconds(500));
+    }
+    check_state(standalone, State::kHalfOpen, "after slow calls");
+    const bool first = standalone.Admit();
+    const bool second = standalone.Admit();
+    ipfs::test::must_fail("CircuitBreaker::Admit()",
+                          [&standalone]() { standalone.Admit(); });
+    standalone.Record(first, Outcome::kSuccess, std::chrono::milliseconds(1));
+    check_state(standalone, State::kHalfOpen, "after one trial");
+    standalone.Record(second, Outcome::kSuccess, std::chrono::milliseconds(1));
+    check_state(standalone, State::kClosed, "after the trials");
+
+    slow_upload();
+    slow_answer();
+
+    ipfs::test::must_fail("CircuitBreaker()", []() {
+      ipfs::http::CircuitBreakerOptions bad;
+      bad.failure_rate = 0;
+      ipfs::http::CircuitBreaker breaker(bad);
+    });
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,371 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+#include <ipfs/cluster-client.h>
+#include <ipfs/test/stub-server.h>
+#include <ipfs/test/utils.h>
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Answer of the stub peers to "version". */
+static const char kVersion[] =
+    "{\"Version\":\"0.18.0\",\"Commit\":\"\",\"Repo\":\"13\","
+    "\"System\":\"amd64/linux\",\"Golang\":\"go1.19.1\"}";
+
+/** Get the time elapsed since `start`, in milliseconds. */
+static int64_t elapsed_ms(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/** A node that accepts connections but never answers is drained within
+ * about `probe_timeout`, and the destructor does not wait for a probe stuck
+ * on it. */
+static void probe_hung_node() {
+  ipfs::test::StubServer live(kVersion);
+  ipfs::test::StubServer hung("", true);
+
+  ipfs::ClusterOptions options;
+  options.probe_interval = std::chrono::milliseconds(50);
+  options.probe_timeout = std::chrono::milliseconds(200);
+  options.failure_threshold = 1;
+
+  const auto start = std::chrono::steady_clock::now();
+  {
+    ipfs::ClusterClient cluster({ipfs::Client("127.0.0.1", live.Port()),
+                                 ipfs::Client("127.0.0.1", hung.Port())},
+                                options);
+    while (cluster.Status()[1].healthy && elapsed_ms(start) < 5000) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    /* Well before the 2 s of the default probe_timeout. */
+    const int64_t drained = elapsed_ms(start);
+    if (cluster.Status()[1].healthy || drained > 1500) {
+      throw std::runtime_error("ClusterClient: the hung node was drained in " +
+                               std::to_string(drained) + " ms");
+    }
+    if (!cluster.Status()[0].healthy) {
+      throw std::runtime_error("ClusterClient: the live node was drained");
+    }
+
+    for (int i = 0; i < 10; ++i) {
+      ipfs::Json version;
+      cluster.Call(
+          [&version](ipfs::Client* client) { client->Version(&version); });
+    }
+    if (cluster.Status()[0].requests != 10 ||
+        cluster.Status()[0].failures != 0 ||
+        cluster.Status()[1].requests != 0) {
+      throw std::runtime_error("ClusterClient: calls went to the hung node");
+    }
+  }
+
+  /* A probe that would last 10 s is in progress when the client goes. */
+  options.probe_timeout = std::chrono::milliseconds(10000);
+  std::unique_ptr<ipfs::ClusterClient> cluster =
+      std::make_unique<ipfs::ClusterClient>(
+          std::vector<ipfs::Client>{ipfs::Client("127.0.0.1", hung.Port())},
+          options);
+  while (hung.Requests() == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  const auto destroyed = std::chrono::steady_clock::now();
+  cluster.reset();
+  if (elapsed_ms(destroyed) > 1000) {
+    throw std::runtime_error("~ClusterClient() waited for a probe for " +
+                             std::to_string(elapsed_ms(destroyed)) + " ms");
+  }
+}
+
+/** With kLeastOutstanding, the calls go to the node with no call in
+ * progress. */
+static void least_outstanding() {
+  ipfs::test::StubServer a(kVersion);
+  ipfs::test::StubServer b(kVersion);
+
+  ipfs::ClusterOptions options;
+  options.balancing = ipfs::ClusterOptions::Balancing::kLeastOutstanding;
+  options.probe_interval = std::chrono::milliseconds(0);
+  ipfs::ClusterClient cluster({ipfs::Client("127.0.0.1", a.Port()),
+                               ipfs::Client("127.0.0.1", b.Port())},
+                              options);
+
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::thread blocked([&cluster, released]() {
+    cluster.Call([released](ipfs::Client*) { released.wait(); });
+  });
+  while (cluster.Status()[0].outstanding + cluster.Status()[1].outstanding ==
+         0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const size_t busy = cluster.Status()[0].outstanding == 1 ? 0 : 1;
+
+  for (int i = 0; i < 10; ++i) {
+    ipfs::Json version;
+    cluster.Call(
+        [&version](ipfs::Client* client) { client->Version(&version); });
+  }
+  release.set_value();
+  blocked.join();
+
+  const auto status = cluster.Status();
+  if (status[busy].requests != 1 || status[1 - busy].requests != 10 ||
+      (busy == 0 ? a : b).Requests() != 0) {
+    throw std::runtime_error(
+        "kLeastOutstanding: calls went to the busy node");
+  }
+}
+
+/** A read sent to a node that never answers is hedged onto a healthy node,
+ * which wins long before the stall would end. */
+static void hedged_read() {
+  ipfs::test::StubServer stalled("", true);
+  ipfs::test::StubServer healthy("Hello and Welcome to IPFS!");
+
+  /** [ipfs::ClusterClient::CallHedged] */
+  ipfs::ClusterOptions hedged;
+  hedged.hedge = true;
+  hedged.hedge_delay = std::chrono::milliseconds(50);
+  hedged.replication = 2;
+  hedged.probe_interval = std::chrono::milliseconds(0);
+  ipfs::ClusterClient reader({ipfs::Client("127.0.0.1", stalled.Port()),
+                              ipfs::Client("127.0.0.1", healthy.Port())},
+                             hedged);
+
+  for (int i = 0; i < 10; ++i) {
+    std::stringstream contents;
+    reader.CallHedged(
+        [](ipfs::Client* client, std::iostream* response) {
+          client->FilesGet(
+              "/ipfs/QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG/readme",
+              response);
+        },
+        &contents);
+    ipfs::test::check_if_string_contains("ClusterClient::CallHedged()",
+                                         contents.str(),
+                                         "Hello and Welcome to IPFS!");
+  }
+
+  ipfs::ClusterHedgeStatus stats = reader.HedgeStatus();
+  std::cout << stats.reads << " reads, " << stats.hedges << " hedges, "
+            << stats.wins << " won, hedging after " << stats.delay.count()
+            << " us" << std::endl;
+  /* An example output:
+  10 reads, 4 hedges, 4 won, hedging after 50000 us
+  */
+  /** [ipfs::ClusterClient::CallHedged] */
+
+  /* A block whose first owner is the stalled node, which is always asked
+  first. */
+  ipfs::Cid cid;
+  for (int i = 0; cid.Empty() || reader.Owners(cid)[0] != 0; ++i) {
+    std::string digest(32, 'h');
+    digest.replace(0, 8, std::to_string(10000000 + i));
+    cid = ipfs::Cid::FromBinary(
+        ipfs::cid::FromSha256(1, ipfs::cid::kRaw, digest));
+  }
+
+  const ipfs::ClusterHedgeStatus before = reader.HedgeStatus();
+  const auto start = std::chrono::steady_clock::now();
+  std::stringstream block;
+  reader.BlockGet(cid, &block);
+  const int64_t took = elapsed_ms(start);
+
+  stats = reader.HedgeStatus();
+  const auto status = reader.Status();
+  if (block.str() != "Hello and Welcome to IPFS!" ||
+      stats.hedges < before.hedges + 1 || stats.wins < before.wins + 1) {
+    throw std::runtime_error("ClusterClient::BlockGet(): not hedged");
+  }
+  if (took > 1000) {
+    throw std::runtime_error("ClusterClient::BlockGet(): hedged read took " +
+                             std::to_string(took) + " ms");
+  }
+  /* The stalled read was cancelled, which is not a failure. */
+  if (status[0].outstanding != 0 || status[0].failures != 0 ||
+      status[1].failures != 0) {
+    throw std::runtime_error("ClusterClient::BlockGet(): unexpected status");
+  }
+}
+
+int main(int, char**) {
+  try {
+    ipfs::test::StubServer live(kVersion);
+    ipfs::test::StubServer dead(kVersion);
+    const uint16_t live_port = live.Port();
+    const uint16_t dead_port = dead.Port();
+    /* Nothing listens on its port anymore. */
+    dead.Stop();
+
+    /** [ipfs::ClusterClient] */
+    ipfs::ClusterOptions options;
+    options.probe_interval = std::chrono::milliseconds(50);
+    options.failure_threshold = 1;
+
+    /* E.g. live_port is 5001 and nothing listens on dead_port: that node
+     * gets drained by the probes. */
+    ipfs::ClusterClient cluster({ipfs::Client("127.0.0.1", live_port),
+                                 ipfs::Client("127.0.0.1", dead_port)},
+                                options);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&cluster]() {
+        for (int i = 0; i < 5; ++i) {
+          ipfs::Json version;
+          try {
+            cluster.Call([&version](ipfs::Client* client) {
+              client->Version(&version);
+            });
+          } catch (const std::exception& e) {
+            /* Sent to the dead node before its first probe. */
+            std::cerr << e.what() << std::endl;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (const auto& node : cluster.Status()) {
+      std::cout << node.url_prefix << (node.healthy ? " up" : " down") << ", "
+                << node.requests << " requests, " << node.failures
+                << " failures" << std::endl;
+    }
+    /* An example output:
+    http://127.0.0.1:5001/api/v0 up, 18 requests, 0 failures
+    http://127.0.0.1:5002/api/v0 down, 2 requests, 2 failures
+    */
+    /** [ipfs::ClusterClient] */
+
+    /* Wait for the dead node to be drained, then nothing may fail. Only the
+    dead node may have failed so far. */
+    for (int i = 0; i < 100 && cluster.Status()[1].healthy; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    if (cluster.Status()[1].healthy || !cluster.Status()[0].healthy ||
+        cluster.Status()[0].failures != 0) {
+      throw std::runtime_error("ClusterClient: the probes did not work");
+    }
+    for (int i = 0; i < 10; ++i) {
+      ipfs::Json version;
+      cluster.Call(
+          [&version](ipfs::Client* client) { client->Version(&version); });
+    }
+
+    probe_hung_node();
+    least_outstanding();
+
+    /** [ipfs::ClusterClient::Owners] */
+    ipfs::ClusterOptions sharded;
+    sharded.replication = 2;
+    /* The owners are computed without contacting the nodes. */
+    sharded.probe_interval = std::chrono::milliseconds(0);
+    ipfs::ClusterClient shards({ipfs::Client("localhost", 5001),
+                                ipfs::Client("localhost", 5002),
+                                ipfs::Client("localhost", 5003)},
+                               sharded);
+
+    const ipfs::Cid readme("QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG");
+    for (size_t owner : shards.Owners(readme)) {
+      std::cout << "owner: " << shards.Status()[owner].url_prefix
+                << std::endl;
+    }
+    /* An example output:
+    owner: http://localhost:5003/api/v0
+    owner: http://localhost:5001/api/v0
+    */
+    /** [ipfs::ClusterClient::Owners] */
+
+    hedged_read();
+
+    /* Rendezvous hashing: adding a node moves CIDs only to the new node, and
+     * spreads them evenly. The nodes are not contacted. */
+    ipfs::ClusterOptions offline;
+    offline.probe_interval = std::chrono::milliseconds(0);
+    std::vector<ipfs::Client> nodes;
+    for (int i = 0; i < 4; ++i) {
+      nodes.emplace_back("node-" + std::to_string(i), 5001);
+    }
+    ipfs::ClusterClient four(nodes, offline);
+    nodes.emplace_back("node-4", 5001);
+    ipfs::ClusterClient five(nodes, offline);
+
+    const int kKeys = 5000;
+    int moved = 0;
+    std::vector<int> load(nodes.size());
+    for (int i = 0; i < kKeys; ++i) {
+      std::string digest(32, 'k');
+      digest.replace(0, 8, std::to_string(10000000 + i));
+      const ipfs::Cid cid = ipfs::Cid::FromBinary(
+          ipfs::cid::FromSha256(1, ipfs::cid::kRaw, digest));
+      const size_t before = four.Owners(cid).at(0);
+      const size_t after = five.Owners(cid).at(0);
+      ++load[after];
+      if (after != before) {
+        ++moved;
+        if (after != 4) {
+          throw std::runtime_error("Owners(): a CID moved between old nodes");
+        }
+      }
+    }
+    for (int n : load) {
+      if (n < kKeys / 5 / 2 || n > kKeys / 5 * 2) {
+        throw std::runtime_error("Owners(): unbalanced, a node owns " +
+                                 std::to_string(n) + " CIDs");
+      }
+    }
+    std::cout << moved << " of " << kKeys << " CIDs moved to the new node"
+              << std::endl;
+
+    ipfs::test::must_fail("ClusterClient(replication 0)", [&nodes]() {
+      ipfs::ClusterOptions none;
+      none.replication = 0;
+      ipfs::ClusterClient cluster(nodes, none);
+    });
+
+    ipfs::test::must_fail("ClusterClient(probe_timeout 0)", [&nodes]() {
+      ipfs::ClusterOptions no_timeout;
+      no_timeout.probe_timeout = std::chrono::milliseconds(0);
+      ipfs::ClusterClient cluster(nodes, no_timeout);
+    });
+
+    ipfs::test::must_fail("ClusterClient(no nodes)", []() {
+      ipfs::ClusterClient empty(std::vector<ipfs::Client>{});
+    });
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
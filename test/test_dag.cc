@@ -0,0 +1,176 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/car.h>
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+#include <ipfs/directory-builder.h>
+
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+int main(int, char**) {
+  try {
+    ipfs::Client client("localhost", 5001);
+
+    /* Build a small DAG where "shared" is reachable through two paths:
+    root -> {middle, shared}, middle -> {shared, leaf}. */
+    ipfs::Json stored;
+    client.ObjectPut(R"({"Data": "leaf"})"_json, &stored);
+    const std::string leaf = stored["Hash"];
+    client.ObjectPut(R"({"Data": "shared"})"_json, &stored);
+    const std::string shared = stored["Hash"];
+    client.ObjectPut({{"Data", "middle"},
+                      {"Links",
+                       {{{"Name", "shared"}, {"Hash", shared}, {"Size", 14}},
+                        {{"Name", "leaf"}, {"Hash", leaf}, {"Size", 12}}}}},
+                     &stored);
+    const std::string middle = stored["Hash"];
+    client.ObjectPut({{"Data", "root"},
+                      {"Links",
+                       {{{"Name", "middle"}, {"Hash", middle}, {"Size", 100}},
+                        {{"Name", "shared"}, {"Hash", shared}, {"Size", 14}}}}},
+                     &stored);
+    const std::string root = stored["Hash"];
+
+    /** [ipfs::Client::DagWalk] */
+    ipfs::DagWalkOptions options;
+    options.concurrency = 4;
+
+    std::multiset<std::string> visited;
+    client.DagWalk(
+        root,
+        [&visited](const ipfs::DagNode& node) {
+          std::cout << std::string(node.depth * 2, ' ') << node.cid << " ("
+                    << node.node.links.size() << " links)" << std::endl;
+          visited.insert(node.cid);
+          return true;
+        },
+        options);
+    /* An example output:
+    QmVmrUzuH3v2eMSn... (2 links)
+      QmcNbdBvwuq8vsW8... (2 links)
+      QmSgFKFkDvMVXEvV... (0 links)
+        QmTrQSaJcFkMe7jd... (0 links)
+    */
+    /** [ipfs::Client::DagWalk] */
+
+    const std::multiset<std::string> expected{root, middle, shared, leaf};
+    if (visited != expected) {
+      throw std::runtime_error(
+          "client.DagWalk(): visited an unexpected set of nodes");
+    }
+
+    options.max_depth = 0;
+    visited.clear();
+    client.DagWalk(
+        root,
+        [&visited](const ipfs::DagNode& node) {
+          visited.insert(node.cid);
+          return true;
+        },
+        options);
+    if (visited.size() != 1) {
+      throw std::runtime_error(
+          "client.DagWalk(): descended below max_depth = 0");
+    }
+
+    /** [ipfs::Client::DagExport] */
+    std::stringstream car;
+    client.DagExport(root, &car);
+
+    ipfs::car::Reader reader(&car);
+    std::string cid;
+    std::string block;
+    size_t blocks = 0;
+    while (reader.Next(&cid, &block)) {
+      std::cout << ipfs::cid::ToString(cid) << ": " << block.size() << " bytes"
+                << std::endl;
+      ++blocks;
+    }
+    /* An example output:
+    QmVmrUzuH3v2eMSn...: 104 bytes
+    QmcNbdBvwuq8vsW8...: 102 bytes
+    QmSgFKFkDvMVXEvV...: 8 bytes
+    QmTrQSaJcFkMe7jd...: 6 bytes
+    */
+    /** [ipfs::Client::DagExport] */
+
+    if (reader.Roots().size() != 1 ||
+        ipfs::cid::ToString(reader.Roots()[0]) != root || blocks != 4) {
+      throw std::runtime_error("client.DagExport(): unexpected archive");
+    }
+
+    /** [ipfs::Client::DagImport] */
+    /* Import the archive straight from memory. */
+    car.clear();
+    car.seekg(0);
+
+    ipfs::DagImportOptions import_options;
+    import_options.stats = true;
+
+    ipfs::Json imported;
+    client.DagImport({{"dag.car", ipfs::http::FileUpload::Type::kStream, "",
+                       &car}},
+                     &imported, import_options);
+    std::cout << "DagImport() result:" << std::endl
+              << imported.dump(2) << std::endl;
+    /* An example output:
+    {
+      "Roots": [
+        {
+          "Cid": "QmVmrUzuH3v2eMSn...",
+          "PinErrorMsg": ""
+        }
+      ],
+      "Stats": {
+        "BlockBytesCount": 220,
+        "BlockCount": 4
+      }
+    }
+    */
+    /** [ipfs::Client::DagImport] */
+
+    if (imported["Roots"].size() != 1 || imported["Roots"][0]["Cid"] != root) {
+      throw std::runtime_error("client.DagImport(): unexpected roots");
+    }
+
+    /* A directory built locally is stored with a single request, and the peer
+    sees the same links. */
+    ipfs::DirectoryBuilder directory;
+    directory.Add("root", ipfs::Cid(root), 0);
+    const std::string directory_id = directory.Put(&client);
+    ipfs::Json links;
+    client.ObjectLinks(directory_id, &links);
+    if (directory_id != directory.Build() || links["Links"].size() != 1 ||
+        links["Links"][0]["Name"] != "root" ||
+        links["Links"][0]["Hash"] != root) {
+      throw std::runtime_error("DirectoryBuilder::Put(): unexpected result " +
+                               links.dump());
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
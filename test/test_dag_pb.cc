@@ -0,0 +1,176 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/dag-pb.h>
+#include <ipfs/multibase.h>
+#include <ipfs/test/utils.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+/** Throw if two values differ. */
+template <class T>
+static void check_equal(const std::string& label, const T& actual,
+                        const T& expected) {
+  if (actual != expected) {
+    throw std::runtime_error(label + ": unexpected value");
+  }
+}
+
+int main(int, char**) {
+  try {
+    const std::string empty_dir = "QmUNLLsPACCz1vLxQVkXqqLX5R1X345qqfHbsf67hvA3Nn";
+    const std::string hello_raw =
+        "bafkreifzjut3te2nhyekklss27nh3k72ysco7y32koao5eei66wof36n5e";
+
+    /* CID text <-> binary conversions. */
+    const std::string empty_dir_binary = ipfs::cid::FromString(empty_dir);
+    check_equal("cid::FromString(v0) size", empty_dir_binary.size(),
+                static_cast<size_t>(34));
+    check_equal("cid::ToString(v0)", ipfs::cid::ToString(empty_dir_binary),
+                empty_dir);
+    check_equal("cid::Codec(v0)", ipfs::cid::Codec(empty_dir_binary),
+                ipfs::cid::kDagPb);
+
+    const std::string hello_raw_binary = ipfs::cid::FromString(hello_raw);
+    check_equal("cid::ToString(v1)", ipfs::cid::ToString(hello_raw_binary),
+                hello_raw);
+    check_equal("cid::Codec(v1)", ipfs::cid::Codec(hello_raw_binary),
+                ipfs::cid::kRaw);
+    check_equal("cid::FromString(base32 uppercase)",
+                ipfs::cid::FromString("BAFKREIFZJUT3TE2NHYEKKLSS27NH3K72YSCO7Y3"
+                                      "2KOAO5EEI66WOF36N5E"),
+                hello_raw_binary);
+
+    ipfs::test::must_fail("cid::FromString(garbage)", []() {
+      ipfs::cid::FromString("QmThisIsNotAValidCIDThisIsNotAValidCID0OIlxxxx");
+    });
+    ipfs::test::must_fail("cid::FromString(truncated)", [&hello_raw]() {
+      ipfs::cid::FromString(hello_raw.substr(0, hello_raw.size() - 4));
+    });
+
+    /** [ipfs::Cid] */
+    std::unordered_set<ipfs::Cid> pinned;
+    pinned.insert(ipfs::Cid("QmUNLLsPACCz1vLxQVkXqqLX5R1X345qqfHbsf67hvA3Nn"));
+    pinned.insert(ipfs::Cid(
+        "bafkreifzjut3te2nhyekklss27nh3k72ysco7y32koao5eei66wof36n5e"));
+
+    const ipfs::Cid wanted(empty_dir);
+    std::cout << wanted.ToString() << " (" << wanted.Binary().size()
+              << " bytes) is pinned: " << pinned.count(wanted) << std::endl;
+    /* An example output:
+    QmUNLLsPACCz1vLxQVkXqqLX5R1X345qqfHbsf67hvA3Nn (34 bytes) is pinned: 1
+    */
+    /** [ipfs::Cid] */
+
+    check_equal("Cid::Binary()", std::string(wanted.Binary()),
+                empty_dir_binary);
+    check_equal("Cid::Codec()", ipfs::Cid(hello_raw).Codec(), ipfs::cid::kRaw);
+    check_equal("Cid::FromBinary()",
+                ipfs::Cid::FromBinary(hello_raw_binary).ToString(), hello_raw);
+    check_equal("Cid ordering", ipfs::Cid(hello_raw) < wanted, true);
+    check_equal("Cid::Empty()", ipfs::Cid().Empty(), true);
+
+    /* A sha2-512 CIDv1 is too large to be stored inline. */
+    const std::string long_binary =
+        std::string("\x01\x55\x13\x40", 4) + std::string(64, '\x2a');
+    ipfs::Cid long_cid = ipfs::Cid::FromBinary(long_binary);
+    ipfs::Cid long_copy = long_cid;
+    ipfs::Cid long_moved = std::move(long_cid);
+    check_equal("Cid copy on the heap", std::string(long_copy.Binary()),
+                long_binary);
+    check_equal("Cid move on the heap", long_moved == long_copy, true);
+    long_copy = wanted;
+    check_equal("Cid assignment", long_copy == wanted, true);
+    check_equal("Cid round trip on the heap",
+                ipfs::Cid(long_moved.ToString()) == long_moved, true);
+
+    ipfs::test::must_fail("Cid::FromBinary(trailing bytes)",
+                          [&empty_dir_binary]() {
+                            ipfs::Cid::FromBinary(empty_dir_binary + "x");
+                          });
+
+    /* Multibase round trips, including leading zero bytes. */
+    const std::string binary("\0\0\x01\x02\xff\xfe\x80", 7);
+    check_equal("multibase base58btc",
+                ipfs::multibase::DecodeBase58btc(
+                    ipfs::multibase::EncodeBase58btc(binary)),
+                binary);
+    check_equal("multibase base32",
+                ipfs::multibase::DecodeBase32(
+                    ipfs::multibase::EncodeBase32(binary)),
+                binary);
+    check_equal("multibase::Decode(base16)",
+                ipfs::multibase::Decode("f00000102fffe80"), binary);
+
+    /** [ipfs::dagpb::Decode] */
+    /* A directory with a single entry "empty", pointing to an empty
+    directory. Usually obtained with client.BlockGet(). */
+    const std::string block = std::string("\x12\x2d\x0a\x22", 4) +
+                              empty_dir_binary + "\x12\x05" + "empty" +
+                              "\x18\x04" + "\x0a\x02\x08\x01";
+
+    ipfs::dagpb::Node node;
+    ipfs::dagpb::Decode(block, &node);
+
+    ipfs::unixfs::Data data;
+    ipfs::unixfs::Decode(node.data, &data);
+
+    for (const auto& link : node.links) {
+      std::cout << link.name << " -> " << ipfs::cid::ToString(link.hash)
+                << " (" << link.tsize << " bytes)" << std::endl;
+    }
+    /* An example output:
+    empty -> QmUNLLsPACCz1vLxQVkXqqLX5R1X345qqfHbsf67hvA3Nn (4 bytes)
+    */
+    /** [ipfs::dagpb::Decode] */
+
+    check_equal("dagpb::Decode() links", node.links.size(),
+                static_cast<size_t>(1));
+    check_equal("dagpb::Decode() name", std::string(node.links[0].name),
+                std::string("empty"));
+    check_equal("dagpb::Decode() tsize", node.links[0].tsize,
+                static_cast<uint64_t>(4));
+    check_equal("unixfs::Decode() type", data.type,
+                ipfs::unixfs::DataType::kDirectory);
+
+    /* A file leaf: Type=File, Data="abc", filesize=3. */
+    const std::string leaf("\x08\x02\x12\x03"
+                           "abc\x18\x03");
+    ipfs::unixfs::Decode(leaf, &data);
+    check_equal("unixfs::Decode() file data", std::string(data.data),
+                std::string("abc"));
+    check_equal("unixfs::Decode() filesize", data.filesize,
+                static_cast<uint64_t>(3));
+
+    ipfs::test::must_fail("dagpb::Decode(truncated)", [&block]() {
+      ipfs::dagpb::Node node;
+      ipfs::dagpb::Decode(block.substr(0, 20), &node);
+    });
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/dag-pb.h>
+#include <ipfs/directory-builder.h>
+#include <ipfs/test/utils.h>
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/** Throw if two values differ. */
+static void check_equal(const std::string& label, const std::string& actual,
+                        const std::string& expected) {
+  if (actual != expected) {
+    throw std::runtime_error(label + ": got " + actual + ", expected " +
+                             expected);
+  }
+}
+
+/** Walk a sharded directory and collect its entries.
+ * @return the number of shard nodes */
+static size_t collect_shard(const std::map<std::string, std::string>& blocks,
+                            const std::string& cid, size_t name_width,
+                            std::map<std::string, std::string>* entries) {
+  const std::string& block = blocks.at(cid);
+  ipfs::dagpb::Node node;
+  ipfs::dagpb::Decode(block, &node);
+  ipfs::unixfs::Data data;
+  ipfs::unixfs::Decode(node.data, &data);
+
+  if (data.type != ipfs::unixfs::DataType::kHAMTShard || data.fanout != 256 ||
+      data.hash_type != 0x22) {
+    throw std::runtime_error("Malformed shard " + ipfs::cid::ToString(cid));
+  }
+
+  /* One bit is set in the bitfield per link. */
+  size_t bits = 0;
+  for (const char byte : data.data) {
+    for (uint8_t b = static_cast<uint8_t>(byte); b != 0; b &= b - 1) {
+      ++bits;
+    }
+  }
+  if (bits != node.links.size()) {
+    throw std::runtime_error("Shard bitfield does not match its links");
+  }
+
+  size_t shards = 1;
+  std::string previous;
+  for (const auto& link : node.links) {
+    const std::string name(link.name);
+    if (name <= previous) {
+      throw std::runtime_error("Shard links are not sorted");
+    }
+    previous = name;
+
+    if (name.size() == name_width) {
+      shards += collect_shard(blocks, std::string(link.hash), name_width,
+                              entries);
+    } else {
+      (*entries)[name.substr(name_width)] = ipfs::cid::ToString(link.hash);
+    }
+  }
+  return shards;
+}
+
+int main(int, char**) {
+  try {
+    const ipfs::Cid file("QmT78zSuBmuS4z925WZfrqQ1qHaJ56DQaTfyMUF7F8ff5o");
+
+    /** [ipfs::DirectoryBuilder] */
+    ipfs::DirectoryBuilder directory;
+    /* const ipfs::Cid file("QmT78zSuBmuS4z925WZfrqQ1...7F8ff5o") for
+    example, a 12-byte file whose single block is 20 bytes. */
+    directory.Add("hello.txt", file, 20);
+    directory.Add("again.txt", file, 20);
+
+    std::cout << "Directory: " << directory.Build() << std::endl;
+    /* An example output:
+    Directory: QmdXuc3HjG3oV9tQfNMUDTJMALQqYNwJfEnzeepFPz8kPV
+    */
+    /** [ipfs::DirectoryBuilder] */
+
+    /* The empty directory, as created by "ipfs object new unixfs-dir". */
+    check_equal("DirectoryBuilder(empty)", ipfs::DirectoryBuilder().Build(),
+                "QmUNLLsPACCz1vLxQVkXqqLX5R1X345qqfHbsf67hvA3Nn");
+
+    /* The links of a basic directory are sorted by name. */
+    std::map<std::string, std::string> blocks;
+    const auto sink = [&blocks](const std::string& cid,
+                                const std::string& block) {
+      blocks[cid] = block;
+    };
+    const std::string basic = directory.Build(sink);
+    ipfs::dagpb::Node node;
+    ipfs::dagpb::Decode(blocks.at(ipfs::cid::FromString(basic)), &node);
+    ipfs::unixfs::Data data;
+    ipfs::unixfs::Decode(node.data, &data);
+    if (data.type != ipfs::unixfs::DataType::kDirectory ||
+        node.links.size() != 2 || node.links[0].name != "again.txt" ||
+        node.links[1].name != "hello.txt" || node.links[0].tsize != 20) {
+      throw std::runtime_error("DirectoryBuilder: malformed basic directory");
+    }
+
+    /* The bucket of a name is given by the first byte of its murmur3 hash,
+    which is 0xCB for "hello". */
+    ipfs::DirectoryBuilderOptions sharded;
+    sharded.shard_threshold = 1;
+    ipfs::DirectoryBuilder single(sharded);
+    single.Add("hello", file, 20);
+    blocks.clear();
+    const std::string single_root = single.Build(sink);
+    ipfs::dagpb::Decode(blocks.at(ipfs::cid::FromString(single_root)), &node);
+    if (node.links.size() != 1 || node.links[0].name != "CBhello") {
+      throw std::runtime_error("DirectoryBuilder: wrong bucket for \"hello\"");
+    }
+
+    /* Enough entries for some buckets to need a second level. */
+    ipfs::DirectoryBuilder large(sharded);
+    for (int i = 0; i < 2000; ++i) {
+      large.Add("entry-" + std::to_string(i), file, 20);
+    }
+    blocks.clear();
+    const std::string large_root = large.Build(sink);
+    std::map<std::string, std::string> entries;
+    const size_t shards = collect_shard(
+        blocks, ipfs::cid::FromString(large_root), 2, &entries);
+    if (entries.size() != 2000 || entries.count("entry-1999") == 0 ||
+        shards < 2 || shards != blocks.size()) {
+      throw std::runtime_error("DirectoryBuilder: malformed sharded directory");
+    }
+
+    /* The default threshold is not reached by a few entries. */
+    if (directory.Build() != basic) {
+      throw std::runtime_error("DirectoryBuilder: unstable result");
+    }
+
+    ipfs::test::must_fail("DirectoryBuilder::Add(duplicate)",
+                          [&]() { directory.Add("hello.txt", file, 20); });
+    ipfs::test::must_fail("DirectoryBuilder::Add(a/b)",
+                          [&]() { directory.Add("a/b", file, 20); });
+    ipfs::test::must_fail("DirectoryBuilder(fanout = 100)", []() {
+      ipfs::DirectoryBuilderOptions options;
+      options.fanout = 100;
+      ipfs::DirectoryBuilder builder(options);
+    });
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/file-hasher.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/** Throw if two values differ. */
+static void check_equal(const std::string& label, const std::string& actual,
+                        const std::string& expected) {
+  if (actual != expected) {
+    throw std::runtime_error(label + ": got " + actual + ", expected " +
+                             expected);
+  }
+}
+
+int main(int, char**) {
+  try {
+    /** [ipfs::FileHasher] */
+    ipfs::FileHasher hasher;
+    hasher.Update("hello ");
+    hasher.Update("world");
+    std::cout << "CID: " << hasher.Finish() << std::endl;
+    /* An example output:
+    CID: Qmf412jQZiuVUtdgnB36FXFX7xg5V6KEbSJ4dpQuhkLyfD
+    */
+    /** [ipfs::FileHasher] */
+
+    /* Recorded from "ipfs add" and "ipfs add --cid-version=1". */
+    ipfs::FileHasherOptions v1;
+    v1.cid_version = 1;
+    v1.raw_leaves = true;
+    check_equal("FileHasher::Hash(empty)", ipfs::FileHasher::Hash(""),
+                "QmbFMke1KXqnYyBBWxB74N4c5SBnJMVAiMNRcGu6x1AwQH");
+    check_equal("FileHasher::Hash(hello world\\n)",
+                ipfs::FileHasher::Hash("hello world\n"),
+                "QmT78zSuBmuS4z925WZfrqQ1qHaJ56DQaTfyMUF7F8ff5o");
+    check_equal("FileHasher::Hash(empty, v1)", ipfs::FileHasher::Hash("", v1),
+                "bafkreihdwdcefgh4dqkjv67uzcmw7ojee6xedzdetojuzjevtenxquvyku");
+    check_equal("FileHasher::Hash(hello world, v1)",
+                ipfs::FileHasher::Hash("hello world", v1),
+                "bafkreifzjut3te2nhyekklss27nh3k72ysco7y32koao5eei66wof36n5e");
+
+    /* Raw leaves are CIDv1 even when the internal nodes are CIDv0, like with
+    "ipfs add --raw-leaves". */
+    ipfs::FileHasherOptions v0_raw;
+    v0_raw.raw_leaves = true;
+    check_equal("FileHasher::Hash(hello world, v0 raw leaves)",
+                ipfs::FileHasher::Hash("hello world", v0_raw),
+                "bafkreifzjut3te2nhyekklss27nh3k72ysco7y32koao5eei66wof36n5e");
+
+    /* Tiny chunks and nodes, to exercise the shape of the balanced tree: one
+    leaf, one level, exactly full levels and partially filled ones. */
+    std::string data;
+    for (size_t i = 0; i < 200; ++i) {
+      data.push_back(static_cast<char>(i * 7 % 251));
+    }
+    struct Expected {
+      size_t size;
+      const char* v0;
+      const char* v1;
+    };
+    const std::vector<Expected> expected = {
+        {1, "QmS9JArPwa55ePgDnyg6TzX24mYTS1b1vLqWNebyVotKxQ",
+         "bafkreidogqfzz75tpkmjzjke425xqcrmpcib2p5tg44hnbirumdbpl5adu"},
+        {7, "QmNdtrYGWyyJNaD38hQE9eWjJmGuybgdZrQfwMoNGv1w7D",
+         "bafkreia5t6ckfqofqkou4bundhu3kkhzfxatubcolx4dgabhwt6djfzeyu"},
+        {8, "QmcBKPk7xZQEShMpWHApjB9vohPuyg7yM1V66p7b4TWexT",
+         "bafybeiflvdco5pcepo5jtbhbrljb4q6tmbzbmmk2tjse43twwqbj466emu"},
+        {21, "QmV1sZu9RHtH5fBp13zpuh42HFuYCwQn9tgibEovNxBzE2",
+         "bafybeib7rlqcsvegugflcchohv4zuyyxyn6tp4z2cssyndpfgoc2sdxxpi"},
+        {22, "QmQ1EzG8a1qubf5EH9TBo5dV9VfckzGxySJYZhkGWd9qS1",
+         "bafybeidiehmwgzn4dhnnd6hkhxxb7gil6koux2e6yged7i7va5pcgumpz4"},
+        {63, "QmcxTUyp253b9ThmZ8FJuQ6m8uMQ1tB2P9gCUHEEo4ZQcj",
+         "bafybeiaybpkrfxlagxd5duoflozykx43lizdbmf4f2agvj6bhea6zs4ftm"},
+        {64, "QmckW61C7vm1YwNtum2CZgrFvkJMzFoi2WMjKhm3ZqFNnh",
+         "bafybeifdooqpsice5ddnoyjfhghkmefy7cpm7h4gkgvyjbnnop4yvpbhk4"},
+        {200, "QmV3cVymBb9BzGSLkmBLP7TuHfhtVYtaPboBw2eaoSfxv9",
+         "bafybeihsqtymjc6mv4ngbj2sbvr6tn7e7irlaorhxo4fa5gvzx2maqjoqm"},
+    };
+    ipfs::FileHasherOptions small;
+    small.chunk_size = 7;
+    small.max_links = 3;
+    ipfs::FileHasherOptions small_v1 = small;
+    small_v1.cid_version = 1;
+    small_v1.raw_leaves = true;
+    ipfs::FileHasherOptions small_v0_raw = small;
+    small_v0_raw.raw_leaves = true;
+    const std::string tree_v0_raw = ipfs::FileHasher::Hash(data, small_v0_raw);
+    if (tree_v0_raw.compare(0, 2, "Qm") != 0 ||
+        tree_v0_raw == expected.back().v0) {
+      throw std::runtime_error(
+          "FileHasher::Hash(v0 raw leaves): unexpected root " + tree_v0_raw);
+    }
+    for (const auto& e : expected) {
+      const std::string label =
+          "FileHasher::Hash(" + std::to_string(e.size) + " bytes";
+      check_equal(label + ")",
+                  ipfs::FileHasher::Hash(data.substr(0, e.size), small), e.v0);
+      check_equal(label + ", v1)",
+                  ipfs::FileHasher::Hash(data.substr(0, e.size), small_v1),
+                  e.v1);
+    }
+
+    /* The blocks are handed to the sink as they are built. */
+    std::vector<std::string> cids;
+    ipfs::FileHasher streaming(small, [&cids](const std::string& cid,
+                                              const std::string&) {
+      cids.push_back(cid);
+    });
+    for (char c : data) {
+      streaming.Update(std::string(1, c));
+    }
+    check_equal("FileHasher::Update() byte by byte", streaming.Finish(),
+                expected.back().v0);
+    /* 29 leaves, 10 nodes over them, 4 over those, 2 over those and the
+    root. */
+    if (cids.size() != 29 + 10 + 4 + 2 + 1) {
+      throw std::runtime_error("FileHasher: unexpected number of blocks " +
+                               std::to_string(cids.size()));
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
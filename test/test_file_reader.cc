@@ -0,0 +1,137 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/cid.h>
+#include <ipfs/client.h>
+#include <ipfs/file-reader.h>
+#include <ipfs/test/utils.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#ifndef NDEBUG
+namespace ipfs {
+namespace http {
+extern std::string replace_body;
+}
+}  // namespace ipfs
+
+/** Read a file whose root announces a 1000 bytes child, while the child is a
+ * raw block much smaller than that. Every block fetch gets the root block, so
+ * the child is the root block itself, read as raw data. */
+static void read_malformed() {
+  const std::string child = ipfs::cid::FromString(
+      "bafkreifzjut3te2nhyekklss27nh3k72ysco7y32koao5eei66wof36n5e");
+  /* UnixFS Data: type file, filesize 1000, blocksizes [1000]. */
+  const std::string data("\x08\x02\x18\xe8\x07\x20\xe8\x07", 8);
+  const std::string link = std::string("\x0a", 1) +
+                           static_cast<char>(child.size()) + child;
+  ipfs::http::replace_body = std::string("\x12", 1) +
+                             static_cast<char>(link.size()) + link +
+                             std::string("\x0a", 1) +
+                             static_cast<char>(data.size()) + data;
+
+  ipfs::Client client("localhost", 1);
+  ipfs::FileReader reader(client,
+                          "QmUNLLsPACCz1vLxQVkXqqLX5R1X345qqfHbsf67hvA3Nn");
+  ipfs::test::must_fail("FileReader::Read(short child)", [&reader]() {
+    std::string data;
+    reader.Read(0, 1000, &data);
+  });
+  ipfs::test::must_fail("FileReader::Read(past short child)", [&reader]() {
+    std::string data;
+    reader.Read(500, 10, &data);
+  });
+
+  ipfs::http::replace_body = "";
+}
+#endif /* NDEBUG */
+
+int main(int, char**) {
+  try {
+#ifndef NDEBUG
+    read_malformed();
+#endif /* NDEBUG */
+
+    ipfs::Client client("localhost", 5001);
+
+    /* Large enough to be split in several blocks by the default chunker. */
+    std::string contents;
+    for (size_t i = 0; contents.size() < 1024 * 1024 + 17; ++i) {
+      contents += std::to_string(i * 7919) + ",";
+    }
+
+    ipfs::Json add_result;
+    client.FilesAdd({{"big.txt", ipfs::http::FileUpload::Type::kFileContents,
+                      contents}},
+                    &add_result);
+    const std::string file_id = add_result[0]["hash"];
+
+    /** [ipfs::FileReader] */
+    /* std::string file_id = "QmWPyMW2u7J2Zyzut7TcBMT8pG6F2cB4hmZk1vBJFBt1nP"
+     * for example. */
+    ipfs::FileReader reader(client, file_id);
+
+    std::string data;
+    reader.Read(300000, 16, &data);
+    std::cout << "File size: " << reader.Size() << ", 16 bytes at 300000: \""
+              << data << "\"" << std::endl;
+    /* An example output:
+    File size: 1048594, 16 bytes at 300000: "357,248688276,24"
+    */
+    /** [ipfs::FileReader] */
+
+    if (reader.Size() != contents.size()) {
+      throw std::runtime_error("FileReader::Size(): unexpected size " +
+                               std::to_string(reader.Size()));
+    }
+    if (data != contents.substr(300000, 16)) {
+      throw std::runtime_error("FileReader::Read(): unexpected data at 300000");
+    }
+
+    /* Sequential reads that straddle the block boundaries. */
+    std::string all;
+    for (reader.Read(100003, &data); !data.empty();
+         reader.Read(100003, &data)) {
+      all += data;
+    }
+    if (all != contents || reader.Tell() != contents.size()) {
+      throw std::runtime_error("FileReader::Read(): sequential reads mismatch");
+    }
+
+    /* Reads at arbitrary offsets, including past the end of the file. */
+    for (uint64_t offset = 0; offset < contents.size() + 1000;
+         offset += 262139) {
+      reader.Read(offset, 5000, &data);
+      if (data != contents.substr(std::min<uint64_t>(offset, contents.size()),
+                                  5000)) {
+        throw std::runtime_error("FileReader::Read(): mismatch at offset " +
+                                 std::to_string(offset));
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -18,11 +18,17 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
 #include <ipfs/client.h>
+#include <ipfs/file-hasher.h>
 #include <ipfs/test/utils.h>
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 int main(int, char**) {
   try {
@@ -69,6 +75,119 @@ int main(int, char**) {
     */
     /** [ipfs::Client::FilesAdd] */
 
+    /** [ipfs::Client::FilesAddIfMissing] */
+    /* Several chunks, so that the local hashing builds a tree. */
+    std::string big(600 * 1024, 'x');
+    for (size_t i = 0; i < big.size(); i += 4096) {
+      big.replace(i, 10, std::to_string(1000000000 + i));
+    }
+
+    std::string big_id;
+    bool uploaded = client.FilesAddIfMissing(
+        {"big.txt", ipfs::http::FileUpload::Type::kFileContents, big}, &big_id);
+    std::cout << big_id << (uploaded ? " was uploaded" : " was already there")
+              << std::endl;
+
+    uploaded = client.FilesAddIfMissing(
+        {"big.txt", ipfs::http::FileUpload::Type::kFileContents, big}, &big_id);
+    std::cout << big_id << (uploaded ? " was uploaded" : " was already there")
+              << std::endl;
+    /* An example output:
+    QmXsnKpRt5gY2eAM... was uploaded
+    QmXsnKpRt5gY2eAM... was already there
+    */
+    /** [ipfs::Client::FilesAddIfMissing] */
+    if (uploaded) {
+      throw std::runtime_error(
+          "client.FilesAddIfMissing(): uploaded a file twice");
+    }
+
+    ipfs::Json big_result;
+    client.FilesAdd(
+        {{"big.txt", ipfs::http::FileUpload::Type::kFileContents, big}},
+        &big_result);
+    if (big_result[0]["hash"] != big_id ||
+        ipfs::FileHasher::Hash(big) != big_id) {
+      throw std::runtime_error(
+          "FileHasher: the CID differs from the one of client.FilesAdd()");
+    }
+
+    /** [ipfs::AddOptions] */
+    ipfs::AddOptions add_options;
+    add_options.cid_version = 1;
+    add_options.raw_leaves = true;
+    add_options.chunker = "size-1000";
+    /* Compute the CID without storing anything. */
+    add_options.only_hash = true;
+    add_options.pin = false;
+
+    ipfs::Json v1_result;
+    client.FilesAdd(
+        {{"big.txt", ipfs::http::FileUpload::Type::kFileContents, big}},
+        &v1_result, add_options);
+    std::cout << "CIDv1: " << v1_result[0]["hash"] << std::endl;
+    /* An example output:
+    CIDv1: "bafkrei..."
+    */
+    /** [ipfs::AddOptions] */
+
+    ipfs::FileHasherOptions v1_hasher;
+    v1_hasher.cid_version = 1;
+    v1_hasher.raw_leaves = true;
+    v1_hasher.chunk_size = 1000;
+    if (v1_result[0]["hash"] != ipfs::FileHasher::Hash(big, v1_hasher) ||
+        client.BlockExists(v1_result[0]["hash"].get<std::string>())) {
+      throw std::runtime_error("client.FilesAdd(): options were not applied");
+    }
+
+    /* The daemon accepts raw leaves with CIDv0: the leaves are CIDv1 and the
+    other nodes CIDv0, which the local hashing must reproduce to find that the
+    file is already there. */
+    ipfs::AddOptions v0_raw;
+    v0_raw.raw_leaves = true;
+    ipfs::Json v0_raw_result;
+    client.FilesAdd(
+        {{"big.txt", ipfs::http::FileUpload::Type::kFileContents, big}},
+        &v0_raw_result, v0_raw);
+    std::string v0_raw_id;
+    uploaded = client.FilesAddIfMissing(
+        {"big.txt", ipfs::http::FileUpload::Type::kFileContents, big},
+        &v0_raw_id, v0_raw);
+    ipfs::FileHasherOptions v0_raw_hasher;
+    v0_raw_hasher.raw_leaves = true;
+    if (uploaded || v0_raw_result[0]["hash"] != v0_raw_id ||
+        ipfs::FileHasher::Hash(big, v0_raw_hasher) != v0_raw_id) {
+      throw std::runtime_error(
+          "client.FilesAddIfMissing(): CIDv0 with raw leaves mismatch");
+    }
+
+    /* Options that the local hashing can't reproduce are left to the peer,
+    which rejects this chunk size. */
+    ipfs::test::must_fail("client.FilesAddIfMissing(huge chunks)", [&]() {
+      ipfs::AddOptions huge;
+      huge.chunker = "size-99999999999999999999999";
+      std::string id;
+      client.FilesAddIfMissing(
+          {"big.txt", ipfs::http::FileUpload::Type::kFileContents, big}, &id,
+          huge);
+    });
+
+    /** [ipfs::Client::BlockExists] */
+    /* std::string big_id = "QmXsnKpRt5gY2eAMWUVBD...kVNsk"
+     * for example. */
+    std::cout << "Have " << big_id << ": " << client.BlockExists(big_id)
+              << std::endl;
+    /* An example output:
+    Have QmXsnKpRt5gY2eAM...: 1
+    */
+    /** [ipfs::Client::BlockExists] */
+    ipfs::FileHasherOptions other;
+    other.chunk_size = 1000;
+    if (!client.BlockExists(big_id) ||
+        client.BlockExists(ipfs::FileHasher::Hash(big, other))) {
+      throw std::runtime_error("client.BlockExists(): unexpected result");
+    }
+
     /** [ipfs::Client::FilesLs] */
     ipfs::Json ls_result;
     client.FilesLs("/ipfs/QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG",
@@ -107,6 +226,102 @@ int main(int, char**) {
     }
     */
     /** [ipfs::Client::FilesLs] */
+
+    /** [ipfs::Client::Ls] */
+    ipfs::LsOptions ls_options;
+    /* Do not make the peer fetch every entry to find out its size. */
+    ls_options.size = false;
+
+    std::vector<std::string> names;
+    client.Ls(
+        "/ipfs/QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG",
+        [&names](const ipfs::LsEntry& entry) {
+          std::cout << entry.name << " " << entry.cid.ToString()
+                    << (entry.type == ipfs::LsEntry::Type::kDirectory ? "/"
+                                                                      : "")
+                    << std::endl;
+          names.push_back(entry.name);
+        },
+        ls_options);
+    /* An example output:
+    about QmZTR5bcpQD7cFgTorqxZDYaew1Wqgfbd2ud9QqGPAkK2V
+    ...
+    quick-start QmdncfsVm2h5Kqq9hPmU7oAVX2zTSVP3L869tgTbPYnsha
+    ...
+    */
+    /** [ipfs::Client::Ls] */
+
+    if (std::find(names.begin(), names.end(), "quick-start") == names.end()) {
+      throw std::runtime_error("client.Ls(): quick-start is missing");
+    }
+
+    const std::filesystem::path download_dir =
+        std::filesystem::temp_directory_path() / "cpp-ipfs-http-client-get";
+    std::filesystem::remove_all(download_dir);
+
+    /** [ipfs::Client::Get] */
+    client.Get("/ipfs/QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG",
+               download_dir.string());
+    /* Creates download_dir/QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG/,
+    with the files about, contact, help, quick-start, readme... */
+    /** [ipfs::Client::Get] */
+
+    std::ifstream readme(download_dir /
+                         "QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG" /
+                         "readme",
+                         std::ios::binary);
+    std::stringstream downloaded;
+    downloaded << readme.rdbuf();
+    if (downloaded.str() != contents.str()) {
+      throw std::runtime_error("client.Get(): readme differs from FilesGet()");
+    }
+    std::filesystem::remove_all(download_dir);
+
+    const std::filesystem::path upload_dir =
+        std::filesystem::temp_directory_path() / "cpp-ipfs-http-client-add";
+    std::filesystem::remove_all(upload_dir);
+    std::filesystem::create_directories(upload_dir / "sub");
+    std::ofstream(upload_dir / "foo.txt") << "abcd";
+    std::ofstream(upload_dir / "sub" / "bar.txt") << "Hello, world!";
+
+    /** [ipfs::Client::AddDirectory] */
+    std::string directory_cid;
+    client.AddDirectory(
+        upload_dir.string(), &directory_cid,
+        [](const ipfs::AddedEntry& entry) {
+          std::cout << entry.path << " " << entry.cid.ToString() << std::endl;
+        });
+    std::cout << "Added directory: " << directory_cid << std::endl;
+    /* An example output:
+    cpp-ipfs-http-client-add/foo.txt QmWPyMW2...
+    cpp-ipfs-http-client-add/sub/bar.txt Qm...
+    cpp-ipfs-http-client-add/sub Qm...
+    cpp-ipfs-http-client-add Qm...
+    Added directory: Qm...
+    */
+    /** [ipfs::Client::AddDirectory] */
+
+    std::vector<std::string> added_names;
+    client.Ls(directory_cid, [&added_names](const ipfs::LsEntry& entry) {
+      added_names.push_back(entry.name);
+    });
+    if (added_names != std::vector<std::string>{"foo.txt", "sub"}) {
+      throw std::runtime_error("client.AddDirectory(): unexpected entries");
+    }
+    std::filesystem::remove_all(upload_dir);
+
+    ipfs::test::must_fail("client.AddDirectory(not a directory)", [&client]() {
+      std::string cid;
+      client.AddDirectory("/dev/null", &cid);
+    });
+
+    ipfs::test::must_fail(
+        "client.Get(writers = 0)", [&client, &download_dir]() {
+          ipfs::GetOptions get_options;
+          get_options.writers = 0;
+          client.Get("QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG",
+                     download_dir.string(), get_options);
+        });
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
@@ -18,12 +18,37 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
 #include <ipfs/client.h>
+#include <ipfs/http/bandwidth-limiter.h>
+#include <ipfs/http/rate-limiter.h>
 #include <ipfs/test/utils.h>
 
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
+#include <string>
 #include <utility>
 
+/** Check that a request fails for its deadline, within a second.
+ * @throw std::runtime_error if it does not */
+static void must_expire(const std::string& label,
+                        const std::function<void()>& request) {
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    request();
+  } catch (const ipfs::http::DeadlineExceededError& e) {
+    if (std::chrono::steady_clock::now() - start > std::chrono::seconds(1)) {
+      throw std::runtime_error(label + ": deadline exceeded too late");
+    }
+    std::cout << label << " failed as expected with error message: "
+              << e.what() << std::endl;
+    return;
+  }
+  throw std::runtime_error(label + ": deadline not exceeded");
+}
+
 int main(int, char**) {
   try {
     // Test client constructor
@@ -76,6 +101,56 @@ int main(int, char**) {
     /** [ipfs::Client::Version] */
     ipfs::test::check_if_properties_exist("client.Version()", version,
                                           {"Repo", "System", "Version"});
+
+    /** [ipfs::Client::Deadline] */
+    {
+      /* Both requests must complete within 2 seconds in total. */
+      ipfs::Client::Deadline deadline(&client, std::chrono::seconds(2));
+      client.Id(&id);
+      client.Version(&version);
+    }
+    /** [ipfs::Client::Deadline] */
+
+    must_expire("Client::Deadline(expired)", [&client]() {
+      ipfs::Client::Deadline deadline(&client, std::chrono::milliseconds(0));
+      ipfs::Json id;
+      client.Id(&id);
+    });
+
+    /* The deadline is reached in the middle of a slow download. */
+    ipfs::Json added;
+    client.FilesAdd({{"slow.bin", ipfs::http::FileUpload::Type::kFileContents,
+                      std::string(3000000, 's')}},
+                    &added);
+    ipfs::Client slow(client);
+    slow.SetBandwidthLimiter(std::make_shared<ipfs::http::BandwidthLimiter>(
+        ipfs::http::BandwidthLimits{0, 100000}));
+    const std::string path = "/ipfs/" + added[0]["hash"].get<std::string>();
+    must_expire("Client::Deadline(transfer)", [&slow, &path]() {
+      ipfs::Client::Deadline deadline(&slow, std::chrono::milliseconds(300));
+      std::stringstream contents;
+      slow.FilesGet(path, &contents);
+    });
+
+    /* The deadline is reached while waiting for the rate limiter. */
+    ipfs::http::RateLimiterOptions single;
+    single.reads.max_in_flight = 1;
+    auto limiter = std::make_shared<ipfs::http::RateLimiter>(single);
+    ipfs::Client queued(client);
+    queued.SetRateLimiter(limiter);
+    {
+      const ipfs::http::RateLimiter::Permit held =
+          limiter->Acquire(ipfs::http::RequestClass::kRead);
+      must_expire("Client::Deadline(rate limiter)", [&queued]() {
+        ipfs::Client::Deadline deadline(&queued,
+                                        std::chrono::milliseconds(100));
+        ipfs::Json id;
+        queued.Id(&id);
+      });
+    }
+    if (limiter->Stats(ipfs::http::RequestClass::kRead).queued != 0) {
+      throw std::runtime_error("Client::Deadline(): still queued");
+    }
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
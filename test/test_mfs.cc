@@ -0,0 +1,131 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+#include <ipfs/test/utils.h>
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(int, char**) {
+  try {
+    ipfs::Client client("localhost", 5001);
+
+    /* Clean up after a previous failed run, if any. */
+    try {
+      client.FilesRm("/test_mfs", true);
+    } catch (const std::exception&) {
+    }
+    ipfs::test::must_fail("client.FilesStat(missing)", [&client]() {
+      ipfs::Json stat;
+      client.FilesStat("/test_mfs", &stat);
+    });
+
+    /** [ipfs::Client::FilesMkdir] */
+    client.FilesMkdir("/test_mfs/logs", true /* parents */);
+    /** [ipfs::Client::FilesMkdir] */
+
+    /** [ipfs::Client::FilesWrite] */
+    client.FilesWrite("/test_mfs/logs/today.log", 0,
+                      {"today.log", ipfs::http::FileUpload::Type::kFileContents,
+                       "first record\n"});
+
+    /* Append without flushing, to batch several changes. */
+    client.FilesWrite("/test_mfs/logs/today.log", 13,
+                      {"today.log", ipfs::http::FileUpload::Type::kFileContents,
+                       "second record\n"},
+                      false /* create */, false /* truncate */,
+                      false /* flush */);
+    /** [ipfs::Client::FilesWrite] */
+
+    /** [ipfs::Client::FilesFlush] */
+    std::string flushed;
+    client.FilesFlush("/test_mfs", &flushed);
+    std::cout << "/test_mfs is now " << flushed << std::endl;
+    /* An example output:
+    /test_mfs is now QmbBJaWz3cnZtd1U3m4rF...
+    */
+    /** [ipfs::Client::FilesFlush] */
+
+    /** [ipfs::Client::FilesRead] */
+    std::stringstream record;
+    client.FilesRead("/test_mfs/logs/today.log", 13, 6, &record);
+    std::cout << "Read: \"" << record.str() << "\"" << std::endl;
+    /* An example output:
+    Read: "second"
+    */
+    /** [ipfs::Client::FilesRead] */
+    if (record.str() != "second") {
+      throw std::runtime_error("client.FilesRead(): unexpected data \"" +
+                               record.str() + "\"");
+    }
+
+    /** [ipfs::Client::FilesStat] */
+    ipfs::Json stat;
+    client.FilesStat("/test_mfs/logs/today.log", &stat);
+    std::cout << "Stat: " << stat.dump() << std::endl;
+    /* An example output:
+    Stat: {"Blocks":0,"CumulativeSize":35,"Hash":"QmS4eCe...","Size":27,
+    "Type":"file"}
+    */
+    /** [ipfs::Client::FilesStat] */
+    if (stat["Size"] != 27 || stat["Type"] != "file") {
+      throw std::runtime_error("client.FilesStat(): unexpected result " +
+                               stat.dump());
+    }
+
+    /** [ipfs::Client::FilesMv] */
+    client.FilesMv("/test_mfs/logs/today.log", "/test_mfs/logs/yesterday.log");
+    /** [ipfs::Client::FilesMv] */
+
+    /** [ipfs::Client::FilesCp] */
+    /* Link an existing object into MFS, without copying its data. */
+    client.FilesCp("/ipfs/" + stat["Hash"].get<std::string>(),
+                   "/test_mfs/copy.log");
+    /** [ipfs::Client::FilesCp] */
+
+    /** [ipfs::Client::FilesList] */
+    std::vector<std::string> names;
+    client.FilesList("/test_mfs", [&names](const ipfs::Json& entry) {
+      std::cout << entry["Name"] << " (" << entry["Size"] << " bytes)"
+                << std::endl;
+      names.push_back(entry["Name"]);
+    });
+    /* An example output:
+    "copy.log" (27 bytes)
+    "logs" (0 bytes)
+    */
+    /** [ipfs::Client::FilesList] */
+    if (names != std::vector<std::string>{"copy.log", "logs"}) {
+      throw std::runtime_error("client.FilesList(): unexpected entries");
+    }
+
+    /** [ipfs::Client::FilesRm] */
+    client.FilesRm("/test_mfs", true /* recursive */);
+    /** [ipfs::Client::FilesRm] */
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
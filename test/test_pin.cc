@@ -18,10 +18,14 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
 #include <ipfs/client.h>
+#include <ipfs/test/utils.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 int main(int, char**) {
   try {
@@ -84,6 +88,30 @@ int main(int, char**) {
     */
     /** [ipfs::Client::PinLs__b] */
 
+    std::string new_version_id;
+    client.ObjectPatchSetData(
+        object_id, {"", ipfs::http::FileUpload::Type::kFileContents, "v2"},
+        &new_version_id);
+
+    /** [ipfs::Client::PinUpdate] */
+    /* std::string object_id = "QmdfTbBqBPQ7VNxZEYEj14V...1zR1n" and
+    std::string new_version_id = "QmZ6fWMoPt2ck1iP2vJEF...yiS5j" for example. */
+    client.PinUpdate(object_id, new_version_id);
+
+    std::cout << "Pin moved from " << object_id << " to " << new_version_id
+              << std::endl;
+    /* An example output:
+    Pin moved from QmdfTbBqBPQ7VNxZEYEj14VmRuZBkqFbiwReogJgS1zR1n to QmZ6fWM...
+    */
+    /** [ipfs::Client::PinUpdate] */
+
+    /* Move the pin back, using the batch version. */
+    client.PinUpdate({{ipfs::Cid(new_version_id), ipfs::Cid(object_id)}});
+
+    ipfs::test::must_fail("client.PinUpdate(not pinned)", [&]() {
+      client.PinUpdate(new_version_id, object_id);
+    });
+
     /** [ipfs::Client::PinRm] */
     /* std::string object_id = "QmdfTbBqBPQ7VNxZEYEj14V...1zR1n" for example. */
 
@@ -103,6 +131,45 @@ int main(int, char**) {
 
     client.PinRm(object_id, ipfs::Client::PinRmOptions::RECURSIVE);
     /** [ipfs::Client::PinRm] */
+
+    /** [ipfs::Client::PinReconcile] */
+    /* std::string object_id = "QmdfTbBqBPQ7VNxZEYEj14V...1zR1n" for example. */
+    const std::unordered_set<ipfs::Cid> desired = {ipfs::Cid(object_id)};
+
+    ipfs::PinReconcileOptions options;
+    /* Only compute the changes, to leave the pins of the peer untouched. */
+    options.dry_run = true;
+
+    ipfs::PinReconcileResult changes;
+    client.PinReconcile(desired, &changes, options);
+
+    std::cout << "Pins to add: " << changes.added.size()
+              << ", to remove: " << changes.removed.size()
+              << ", to keep: " << changes.kept << std::endl;
+    /* An example output:
+    Pins to add: 1, to remove: 3, to keep: 0
+    */
+    /** [ipfs::Client::PinReconcile] */
+
+    if (changes.added.size() != 1 || changes.added[0] != *desired.begin() ||
+        changes.kept != 0) {
+      throw std::runtime_error("PinReconcile() did not plan to pin " +
+                               object_id);
+    }
+
+    std::vector<ipfs::Cid> desired_sorted(changes.removed);
+    desired_sorted.push_back(changes.added[0]);
+    std::sort(desired_sorted.begin(), desired_sorted.end());
+    client.PinReconcile(desired_sorted, &changes, options);
+    if (changes.added.size() != 1 || !changes.removed.empty()) {
+      throw std::runtime_error(
+          "PinReconcile() with a sorted array planned unexpected changes");
+    }
+
+    const std::vector<ipfs::Cid> duplicates(2, changes.added[0]);
+    ipfs::test::must_fail("client.PinReconcile(duplicates)", [&]() {
+      client.PinReconcile(duplicates, &changes, options);
+    });
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
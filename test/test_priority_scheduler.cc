@@ -0,0 +1,214 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+#include <ipfs/http/bandwidth-limiter.h>
+#include <ipfs/http/priority-scheduler.h>
+#include <ipfs/http/retry.h>
+#include <ipfs/test/utils.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int, char**) {
+  try {
+    using ipfs::http::Priority;
+    using ipfs::http::PriorityScheduler;
+
+    /** [ipfs::Client::SetScheduler] */
+    ipfs::http::PrioritySchedulerOptions options;
+    options.slots = 1;
+    auto scheduler = std::make_shared<PriorityScheduler>(options);
+
+    /* Replication downloads in the background, at a limited speed. */
+    ipfs::Client replication("localhost", 5001);
+    replication.SetScheduler(scheduler, Priority::kBulk);
+    replication.SetBandwidthLimiter(
+        std::make_shared<ipfs::http::BandwidthLimiter>(
+            ipfs::http::BandwidthLimits{0, 1000000}));
+
+    /* The requests of the users go first. */
+    ipfs::Client handler("localhost", 5001);
+    handler.SetScheduler(scheduler, Priority::kInteractive);
+
+    ipfs::Json added;
+    handler.FilesAdd(
+        {{"replica.bin", ipfs::http::FileUpload::Type::kFileContents,
+          std::string(2000000, 'r')}},
+        &added);
+    const std::string path = "/ipfs/" + added[0]["hash"].get<std::string>();
+
+    std::stringstream replica;
+    std::thread bulk([&replication, &path, &replica]() {
+      replication.FilesGet(path, &replica);
+    });
+    while (scheduler->Stats(Priority::kBulk).running == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    /* The download is paused while the user waits for this. */
+    ipfs::Json version;
+    handler.Version(&version);
+    bulk.join();
+
+    std::cout << "Version() waited "
+              << scheduler->Stats(Priority::kInteractive).total_wait.count()
+              << " us, replication paused "
+              << scheduler->Stats(Priority::kBulk).pauses << " time(s)"
+              << std::endl;
+    /* An example output:
+    Version() waited 374 us, replication paused 1 time(s)
+    */
+    /** [ipfs::Client::SetScheduler] */
+    /* The download takes about a second, the version must not wait for it. */
+    if (scheduler->Stats(Priority::kBulk).pauses != 1 ||
+        scheduler->Stats(Priority::kInteractive).total_wait >
+            std::chrono::milliseconds(500) ||
+        replica.str() != std::string(2000000, 'r')) {
+      throw std::runtime_error("SetScheduler(): bulk transfer not paused");
+    }
+
+    /* A request waiting to be retried leaves its slot to the others.
+     * Nothing listens on port 1, so that every attempt fails. */
+    auto retries = std::make_shared<PriorityScheduler>(options);
+    ipfs::http::RetryPolicy policy;
+    policy.max_attempts = 4;
+    policy.base_backoff = std::chrono::milliseconds(200);
+    policy.budget = std::make_shared<ipfs::http::RetryBudget>(1.0, 100);
+    ipfs::Client unreachable("localhost", 1);
+    unreachable.SetScheduler(retries, Priority::kNormal);
+    unreachable.SetRetryPolicy(policy);
+    std::vector<std::thread> retrying;
+    for (int t = 0; t < 2; ++t) {
+      retrying.emplace_back([copy = unreachable]() mutable {
+        try {
+          ipfs::Json version;
+          copy.Version(&version);
+        } catch (const std::exception&) {
+        }
+      });
+    }
+    for (auto& thread : retrying) {
+      thread.join();
+    }
+    if (retries->Stats(Priority::kNormal).admitted != 8 ||
+        retries->Stats(Priority::kNormal).total_wait >
+            std::chrono::milliseconds(100)) {
+      throw std::runtime_error("PriorityScheduler: slot held during backoff");
+    }
+
+    /* With all priorities waiting, slots go by weight: 8, 4 and 1. */
+    ipfs::http::PrioritySchedulerOptions single;
+    single.slots = 1;
+    PriorityScheduler fair(single);
+    PriorityScheduler::Ticket held = fair.Acquire(Priority::kInteractive);
+
+    std::mutex order_mutex;
+    std::vector<Priority> order;
+    std::vector<std::thread> threads;
+    for (Priority priority :
+         {Priority::kInteractive, Priority::kNormal, Priority::kBulk}) {
+      for (int i = 0; i < 13; ++i) {
+        threads.emplace_back([&fair, &order_mutex, &order, priority]() {
+          PriorityScheduler::Ticket ticket = fair.Acquire(priority);
+          std::lock_guard<std::mutex> lock(order_mutex);
+          order.push_back(priority);
+        });
+      }
+    }
+    for (;;) {
+      size_t queued = 0;
+      for (Priority priority :
+           {Priority::kInteractive, Priority::kNormal, Priority::kBulk}) {
+        queued += fair.Stats(priority).queued;
+      }
+      if (queued == 39) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    held = PriorityScheduler::Ticket();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    int counts[3] = {0, 0, 0};
+    for (size_t i = 0; i < 13; ++i) {
+      ++counts[static_cast<int>(order[i])];
+    }
+    if (counts[0] < 7 || counts[0] > 9 || counts[1] < 3 || counts[1] > 5 ||
+        counts[2] > 2) {
+      throw std::runtime_error("PriorityScheduler: unfair order " +
+                               std::to_string(counts[0]) + "/" +
+                               std::to_string(counts[1]) + "/" +
+                               std::to_string(counts[2]));
+    }
+
+    /* A bulk transfer pauses while an interactive request waits or runs. */
+    single.max_pause = std::chrono::milliseconds(200);
+    PriorityScheduler pausing(single);
+    std::atomic<bool> woken{false};
+    PriorityScheduler::Ticket background =
+        pausing.Acquire(Priority::kBulk, [&woken]() { woken = true; });
+    if (pausing.ShouldPause(&background)) {
+      throw std::runtime_error("PriorityScheduler: paused without a reason");
+    }
+
+    std::atomic<bool> admitted{false};
+    PriorityScheduler::Ticket interactive;
+    std::thread waiter([&]() {
+      interactive = pausing.Acquire(Priority::kInteractive);
+      admitted = true;
+    });
+    while (!woken) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!pausing.ShouldPause(&background)) {
+      throw std::runtime_error("PriorityScheduler: not paused");
+    }
+    waiter.join();
+    if (!admitted || !pausing.ShouldPause(&background)) {
+      throw std::runtime_error("PriorityScheduler: resumed too early");
+    }
+    interactive = PriorityScheduler::Ticket();
+    if (pausing.ShouldPause(&background) ||
+        pausing.Stats(Priority::kBulk).pauses != 1) {
+      throw std::runtime_error("PriorityScheduler: not resumed");
+    }
+
+    ipfs::test::must_fail("PriorityScheduler()", []() {
+      ipfs::http::PrioritySchedulerOptions bad;
+      bad.weights[1] = 0;
+      PriorityScheduler scheduler(bad);
+    });
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,193 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+#include <ipfs/http/rate-limiter.h>
+#include <ipfs/http/retry.h>
+#include <ipfs/test/utils.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int, char**) {
+  try {
+    using ipfs::http::RateLimiter;
+    using ipfs::http::RequestClass;
+
+    /** [ipfs::Client::SetRateLimiter] */
+    ipfs::http::RateLimiterOptions options;
+    options.reads.requests_per_second = 50;
+    options.reads.burst = 5;
+    options.reads.max_in_flight = 2;
+    auto limiter = std::make_shared<RateLimiter>(options);
+
+    /* Nothing listens on port 1, but the requests are limited all the
+     * same. */
+    ipfs::Client client("localhost", 1);
+    client.SetRateLimiter(limiter);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      /* Copies share the limiter. */
+      threads.emplace_back([copy = client]() mutable {
+        for (int i = 0; i < 5; ++i) {
+          try {
+            ipfs::Json version;
+            copy.Version(&version);
+          } catch (const std::exception&) {
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    const ipfs::http::RateLimiterStats stats =
+        limiter->Stats(RequestClass::kRead);
+    std::cout << stats.admitted << " reads, waited " << stats.max_wait.count()
+              << " us at most" << std::endl;
+    /* An example output:
+    20 reads, waited 79015 us at most
+    */
+    /** [ipfs::Client::SetRateLimiter] */
+    /* 5 at once, then 15 at 50 per second. */
+    if (stats.admitted != 20 || stats.queued != 0 || stats.in_flight != 0 ||
+        elapsed < std::chrono::milliseconds(250)) {
+      throw std::runtime_error("RateLimiter: wrong read stats");
+    }
+
+    /* A request waiting to be retried leaves its slot to the others. */
+    ipfs::http::RateLimiterOptions single;
+    single.reads.max_in_flight = 1;
+    auto one_at_a_time = std::make_shared<RateLimiter>(single);
+    ipfs::http::RetryPolicy policy;
+    policy.max_attempts = 4;
+    policy.base_backoff = std::chrono::milliseconds(200);
+    policy.budget = std::make_shared<ipfs::http::RetryBudget>(1.0, 100);
+    client.SetRateLimiter(one_at_a_time);
+    client.SetRetryPolicy(policy);
+    threads.clear();
+    for (int t = 0; t < 2; ++t) {
+      threads.emplace_back([copy = client]() mutable {
+        try {
+          ipfs::Json version;
+          copy.Version(&version);
+        } catch (const std::exception&) {
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const ipfs::http::RateLimiterStats retried =
+        one_at_a_time->Stats(RequestClass::kRead);
+    if (retried.admitted != 8 ||
+        retried.max_wait > std::chrono::milliseconds(100)) {
+      throw std::runtime_error(
+          "RateLimiter: slot held while waiting to retry, waited " +
+          std::to_string(retried.max_wait.count()) + " us");
+    }
+
+    const std::string prefix = "http://localhost:5001/api/v0/";
+    if (RateLimiter::Classify(prefix + "cat?arg=Qm") != RequestClass::kRead ||
+        RateLimiter::Classify(prefix + "add?pin=1") != RequestClass::kWrite ||
+        RateLimiter::Classify(prefix + "files/write?arg=/a") !=
+            RequestClass::kWrite ||
+        RateLimiter::Classify(prefix + "object/patch/add-link") !=
+            RequestClass::kWrite ||
+        RateLimiter::Classify(prefix + "dht/findprovs") != RequestClass::kDht ||
+        RateLimiter::Classify(prefix + "name/publish") != RequestClass::kDht ||
+        RateLimiter::Classify(prefix + "pin/add?arg=Qm") !=
+            RequestClass::kPin ||
+        RateLimiter::Classify(prefix + "address") != RequestClass::kRead) {
+      throw std::runtime_error("RateLimiter::Classify(): wrong class");
+    }
+
+    /* The concurrency cap holds, and the classes are independent. */
+    ipfs::http::RateLimiterOptions capped;
+    capped.pins.max_in_flight = 3;
+    capped.writes.max_queued = 0;
+    capped.writes.max_in_flight = 1;
+    capped.dht.max_in_flight = 1;
+    capped.dht.max_wait = std::chrono::milliseconds(20);
+    RateLimiter pins(capped);
+
+    std::atomic<int> in_flight{0};
+    std::atomic<int> peak{0};
+    threads.clear();
+    for (int t = 0; t < 8; ++t) {
+      threads.emplace_back([&pins, &in_flight, &peak]() {
+        for (int i = 0; i < 10; ++i) {
+          RateLimiter::Permit permit = pins.Acquire(RequestClass::kPin);
+          const int now = ++in_flight;
+          int seen = peak;
+          while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+          }
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+          --in_flight;
+        }
+      });
+    }
+    const RateLimiter::Permit write = pins.Acquire(RequestClass::kWrite);
+    const RateLimiter::Permit dht = pins.Acquire(RequestClass::kDht);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    if (peak > 3 || pins.Stats(RequestClass::kPin).admitted != 80) {
+      throw std::runtime_error("RateLimiter: concurrency cap exceeded");
+    }
+
+    ipfs::test::must_fail("RateLimiter::Acquire(queue full)", [&pins]() {
+      pins.Acquire(RequestClass::kWrite);
+    });
+    ipfs::test::must_fail("RateLimiter::Acquire(wait too long)", [&pins]() {
+      pins.Acquire(RequestClass::kDht);
+    });
+    if (pins.Stats(RequestClass::kWrite).rejected != 1 ||
+        pins.Stats(RequestClass::kDht).rejected != 1) {
+      throw std::runtime_error("RateLimiter: wrong rejected count");
+    }
+
+    /* A caller may give up waiting. */
+    if (pins.Acquire(RequestClass::kDht, []() { return false; })) {
+      throw std::runtime_error("RateLimiter: the wait was not given up");
+    }
+
+    ipfs::test::must_fail("RateLimiter()", []() {
+      ipfs::http::RateLimiterOptions bad;
+      bad.reads.burst = 0;
+      RateLimiter limiter(bad);
+    });
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+#include <ipfs/http/retry.h>
+#include <ipfs/test/utils.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+int main(int, char**) {
+  try {
+    /** [ipfs::Client::SetRetryPolicy] */
+    ipfs::http::RetryPolicy policy;
+    policy.max_attempts = 4;
+    policy.base_backoff = std::chrono::milliseconds(1);
+    policy.budget = std::make_shared<ipfs::http::RetryBudget>(0.1, 10);
+
+    /* Nothing listens on port 1: each attempt fails to connect, which is
+     * retried whatever the command. */
+    ipfs::Client client("localhost", 1);
+    client.SetRetryPolicy(policy);
+
+    try {
+      ipfs::Json version;
+      client.Version(&version);
+    } catch (const std::exception& e) {
+      std::cout << "Gave up after " << policy.budget->Retries()
+                << " retries: " << e.what() << std::endl;
+    }
+    /* An example output:
+    Gave up after 3 retries: HTTP transfer failed: Couldn't connect to se...
+    */
+    /** [ipfs::Client::SetRetryPolicy] */
+    if (policy.budget->Retries() != 3) {
+      throw std::runtime_error("SetRetryPolicy(): expected 3 retries, got " +
+                               std::to_string(policy.budget->Retries()));
+    }
+
+    /* Copies retry the same way, from the same budget, until it runs out:
+     * it holds 7.1 tokens at the start of the next request. */
+    ipfs::Client copy(client);
+    for (int i = 0; i < 3; ++i) {
+      ipfs::test::must_fail("Client::Id()", [&copy]() {
+        ipfs::Json id;
+        copy.Id(&id);
+      });
+    }
+    if (policy.budget->Retries() != 10 || policy.budget->Refused() != 1) {
+      throw std::runtime_error("RetryBudget: " +
+                               std::to_string(policy.budget->Retries()) +
+                               " retries, " +
+                               std::to_string(policy.budget->Refused()) +
+                               " refused, expected 10 and 1");
+    }
+
+    ipfs::http::RetryBudget budget(0.5, 2);
+    budget.Withdraw();
+    budget.Withdraw();
+    budget.Deposit();
+    budget.Deposit();
+    if (budget.Withdraw() != true || budget.Withdraw() != false) {
+      throw std::runtime_error("RetryBudget: 2 requests must allow 1 retry");
+    }
+
+    const std::string prefix = "http://localhost:5001/api/v0/";
+    if (!policy.IsIdempotent(prefix + "block/get?arg=Qm") ||
+        !policy.IsIdempotent(prefix + "version") ||
+        policy.IsIdempotent(prefix + "files/write?arg=/a") ||
+        policy.IsIdempotent(prefix + "key/gen?arg=k") ||
+        policy.IsIdempotent(prefix + "pin/rm?arg=Qm")) {
+      throw std::runtime_error("RetryPolicy::IsIdempotent(): wrong result");
+    }
+
+    policy.base_backoff = std::chrono::milliseconds(10);
+    policy.max_backoff = std::chrono::milliseconds(35);
+    for (unsigned retry = 1; retry < 100; ++retry) {
+      const auto bound = retry == 1 ? 10 : retry == 2 ? 20 : 35;
+      if (policy.Backoff(retry).count() > bound) {
+        throw std::runtime_error("RetryPolicy::Backoff(): above the bound");
+      }
+    }
+
+    ipfs::test::must_fail("Client::SetRetryPolicy()", [&client]() {
+      ipfs::http::RetryPolicy none;
+      none.max_attempts = 0;
+      client.SetRetryPolicy(none);
+    });
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,245 @@
+/* Copyright (c) 2016-2023, The C++ IPFS client library developers
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+
+#include <ipfs/client.h>
+#include <ipfs/tar.h>
+#include <ipfs/test/utils.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** Make a ustar header block. */
+static std::string header(const std::string& name, char type, uint64_t size,
+                          const std::string& link = "",
+                          const std::string& prefix = "") {
+  std::string block(512, '\0');
+  block.replace(0, name.size(), name);
+  std::snprintf(&block[100], 8, "%07o", type == '5' ? 0755 : 0644);
+  std::snprintf(&block[124], 12, "%011llo",
+                static_cast<unsigned long long>(size));
+  block[156] = type;
+  block.replace(157, link.size(), link);
+  block.replace(257, 6, std::string("ustar\0", 6));
+  block.replace(263, 2, "00");
+  block.replace(345, prefix.size(), prefix);
+
+  unsigned sum = 8 * ' ';
+  for (const char c : block) {
+    sum += static_cast<uint8_t>(c);
+  }
+  std::snprintf(&block[148], 8, "%06o", sum);
+  return block;
+}
+
+/** Make the contents of an entry, padded to a whole number of blocks. */
+static std::string contents(const std::string& data) {
+  return data + std::string((512 - data.size() % 512) % 512, '\0');
+}
+
+/** Records the entries passed to it, one line per call. */
+class Recorder : public ipfs::tar::Handler {
+ public:
+  void Begin(const ipfs::tar::Entry& entry) override {
+    log += "begin " + entry.path + " " +
+           std::to_string(static_cast<int>(entry.type)) + " " +
+           std::to_string(entry.size) + " " + entry.link_target + "\n";
+  }
+
+  void Data(std::string_view data) override { log.append(data); }
+
+  void End() override { log += "\nend\n"; }
+
+  std::string log;
+};
+
+#ifndef NDEBUG
+namespace ipfs {
+namespace http {
+extern std::string replace_body;
+}
+}  // namespace ipfs
+
+/** Read a whole file. */
+static std::string slurp(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+/** Extract `archive`, as if the daemon sent it, to `destination`.
+ * @return whether the extraction failed */
+static bool extract(const std::string& archive,
+                    const std::filesystem::path& destination) {
+  ipfs::http::replace_body = archive + std::string(1024, '\0');
+  bool failed = false;
+  try {
+    ipfs::Client client("localhost", 1);
+    client.Get("QmArchive", destination.string());
+  } catch (const std::exception&) {
+    failed = true;
+  }
+  ipfs::http::replace_body = "";
+  return failed;
+}
+
+/** Extract archives that try to write outside of the destination through
+ * symbolic links, which must leave `outside/x` untouched. */
+static void check_symlink_attacks() {
+  const std::filesystem::path root =
+      std::filesystem::temp_directory_path() / "cpp-ipfs-http-client-tar";
+  const std::filesystem::path destination = root / "destination";
+  const std::filesystem::path outside = root / "outside";
+  const std::string evil = contents("evil");
+
+  const auto reset = [&]() {
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(outside);
+    std::filesystem::create_directories(destination);
+    std::ofstream(outside / "x") << "safe";
+  };
+  const auto check_outside = [&](const std::string& what) {
+    if (slurp(outside / "x") != "safe") {
+      throw std::runtime_error("Get(" + what + ") wrote outside");
+    }
+  };
+
+  const std::string link = header("link", '2', 0, outside.string());
+  for (const std::string& through :
+       std::vector<std::string>{"./link/x", "link//x", "link/./x"}) {
+    reset();
+    if (!extract(link + header(through, '0', 4) + evil, destination)) {
+      throw std::runtime_error("Get(" + through + ") should have failed");
+    }
+    check_outside(through);
+  }
+
+  /* An entry named as a previous link replaces it. */
+  reset();
+  const std::string file_link =
+      header("./link", '2', 0, (outside / "x").string());
+  if (extract(file_link + header("link", '0', 4) + evil, destination)) {
+    throw std::runtime_error("Get(link over link) failed");
+  }
+  check_outside("link over link");
+  if (std::filesystem::is_symlink(destination / "link") ||
+      slurp(destination / "link") != "evil") {
+    throw std::runtime_error("Get(link over link) did not replace the link");
+  }
+
+  reset();
+  if (extract(link + header("link/", '5', 0) + header("link/x", '0', 4) + evil,
+              destination)) {
+    throw std::runtime_error("Get(directory over link) failed");
+  }
+  check_outside("directory over link");
+  if (slurp(destination / "link" / "x") != "evil") {
+    throw std::runtime_error("Get(directory over link) did not extract x");
+  }
+
+  /* A link that was in the destination before is not written through. */
+  reset();
+  std::filesystem::create_symlink(outside / "x", destination / "existing");
+  if (!extract(header("existing", '0', 4) + evil, destination)) {
+    throw std::runtime_error("Get(existing link) should have failed");
+  }
+  check_outside("existing link");
+
+  std::filesystem::remove_all(root);
+}
+#endif /* NDEBUG */
+
+int main(int, char**) {
+  try {
+    const std::string long_name(150, 'n');
+    const std::string pax_record = "30 path=dir/" + std::string(17, 'p') + "\n";
+    const std::string archive =
+        header("dir/", '5', 0) + header("dir/a.txt", '0', 5) +
+        contents("hello") + header("dir/link", '2', 0, "a.txt") +
+        header("b.bin", '0', 600, "", "dir") + contents(std::string(600, 'b')) +
+        header("././@LongLink", 'L', long_name.size() + 1) +
+        contents(long_name + '\0') + header("truncated", '0', 1) +
+        contents("L") + header("PaxHeaders/x", 'x', pax_record.size()) +
+        contents(pax_record) + header("short", '0', 1) + contents("X") +
+        std::string(1024, '\0');
+
+    const std::string expected =
+        "begin dir 1 0 \n\nend\n"
+        "begin dir/a.txt 0 5 \nhello\nend\n"
+        "begin dir/link 2 0 a.txt\n\nend\n"
+        "begin dir/b.bin 0 600 \n" +
+        std::string(600, 'b') + "\nend\n" + "begin " + long_name +
+        " 0 1 \nL\nend\n" + "begin dir/" + std::string(17, 'p') +
+        " 0 1 \nX\nend\n";
+
+    /** [ipfs::tar::Parser] */
+    Recorder recorder;
+    ipfs::tar::Parser parser(&recorder);
+    parser.Feed(archive);
+    parser.Finish();
+    /** [ipfs::tar::Parser] */
+
+    if (recorder.log != expected) {
+      throw std::runtime_error("Parser: unexpected entries:\n" + recorder.log);
+    }
+
+    /* The archive may be cut anywhere. */
+    Recorder bytewise;
+    ipfs::tar::Parser bytewise_parser(&bytewise);
+    for (const char c : archive) {
+      bytewise_parser.Feed(std::string_view(&c, 1));
+    }
+    bytewise_parser.Finish();
+    if (bytewise.log != expected) {
+      throw std::runtime_error(
+          "Parser: unexpected entries when fed bytewise:\n" + bytewise.log);
+    }
+
+    ipfs::test::must_fail("Parser::Finish(truncated)", [&archive]() {
+      Recorder truncated;
+      ipfs::tar::Parser parser(&truncated);
+      parser.Feed(archive.substr(0, 1000));
+      parser.Finish();
+    });
+
+    ipfs::test::must_fail("Parser::Feed(bad checksum)", [&archive]() {
+      std::string corrupted = archive;
+      corrupted[0] = 'D';
+      Recorder recorder;
+      ipfs::tar::Parser parser(&recorder);
+      parser.Feed(corrupted);
+    });
+
+#ifndef NDEBUG
+    check_symlink_attacks();
+#endif /* NDEBUG */
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}